@@ -118,11 +118,12 @@ namespace Communicate_Tensors_Map_Judge
 	}
 
 
-	template<typename TA, typename TC, typename Tdata>
-	std::map<TA,std::map<std::pair<TA,TC>,Tensor<Tdata>>>
-	comm_map2_combine_origin_period(
-		const MPI_Comm &mpi_comm,
-		const std::map<TA,std::map<std::pair<TA,TC>,Tensor<Tdata>>> &Ds_in,
+	template<typename TA, typename TC>
+	Communicate_Map_Combine::Judge_Map2_Combine2<
+		TA, TC,
+		Comm::Communicate_Map::Judge_Map2,
+		Communicate_Map_Period::Judge_Map2_Period>
+	get_judge_combine_origin_period(
 		const std::tuple<
 			std::vector<std::tuple< std::set<TA>, std::set<std::pair<TA,TC>> >>,
 			std::vector<std::tuple< std::set<std::pair<TA,TC>>, std::set<std::pair<TA,TC>> >>
@@ -149,8 +150,21 @@ namespace Communicate_Tensors_Map_Judge
 			std::get<1>(judge_combine.judge_list)[j].s1 = std::get<1>(std::get<1>(s_list)[j]);
 			std::get<1>(judge_combine.judge_list)[j].period = period;
 		}
+		return judge_combine;
+	}
 
-		return Communicate_Tensors_Map::comm_map2(mpi_comm, Ds_in, judge_combine);
+	template<typename TA, typename TC, typename Tdata>
+	std::map<TA,std::map<std::pair<TA,TC>,Tensor<Tdata>>>
+	comm_map2_combine_origin_period(
+		const MPI_Comm &mpi_comm,
+		const std::map<TA,std::map<std::pair<TA,TC>,Tensor<Tdata>>> &Ds_in,
+		const std::tuple<
+			std::vector<std::tuple< std::set<TA>, std::set<std::pair<TA,TC>> >>,
+			std::vector<std::tuple< std::set<std::pair<TA,TC>>, std::set<std::pair<TA,TC>> >>
+			> &s_list,
+		const TC &period)
+	{
+		return Communicate_Tensors_Map::comm_map2(mpi_comm, Ds_in, get_judge_combine_origin_period(s_list, period));
 	}
 }
 
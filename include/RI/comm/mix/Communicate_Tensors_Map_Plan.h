@@ -0,0 +1,366 @@
+//=======================
+// AUTHOR : agent
+// DATE :   2026-10-18
+//=======================
+
+#pragma once
+
+#include "../../global/Tensor.h"
+#include "../../global/MPI_Wrapper-func.h"
+
+#include <mpi.h>
+#include <map>
+#include <vector>
+#include <set>
+#include <tuple>
+#include <limits>
+#include <cstring>
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+#include <stdexcept>
+#include <string>
+
+#define MPI_CHECK(x) if((x)!=MPI_SUCCESS)	throw std::runtime_error(std::string(__FILE__)+" line "+std::to_string(__LINE__));
+
+namespace RI
+{
+
+// Send/recv lists of comm_map2(), reusable while the keys of Ds_in in all processes and the judges are unchanged.
+// set_plan() negotiates who-needs-what once, by gathering keys of Ds_in and judging them in each process.
+// communicate() then only exchanges shapes and sends the tensors from/into their own storage by MPI derived datatypes,
+// adding the tensors of the same key from different processes.
+template<typename TA, typename TC, typename Tdata>
+class Communicate_Tensors_Map_Plan
+{
+	// std::pair is not trivially copyable, so TAC=std::pair<TA,TC> is sent as TA and TC separately
+	static_assert(std::is_trivially_copyable<TA>::value,
+		"keys TA and TAC are sent as raw bytes of TA");
+	static_assert(std::is_trivially_copyable<TC>::value,
+		"keys TAC are sent as raw bytes of TC");
+	static_assert(std::is_trivially_copyable<Tdata>::value,
+		"tensors are sent as raw bytes");
+public:
+	using TAC = std::pair<TA,TC>;
+	using T_Ds = std::map<TA,std::map<TAC,Tensor<Tdata>>>;
+
+	// whether the plan was set with the same keys of Ds_in and the same version in all processes.
+	bool check(
+		const MPI_Comm &mpi_comm,
+		const T_Ds &Ds_in,
+		const std::size_t version_in) const
+	{
+		int flag_same = this->flag_set && (this->version==version_in) && (this->keys_local==get_keys(Ds_in));
+		MPI_Wrapper::mpi_allreduce(flag_same, MPI_MIN, mpi_comm);
+		return flag_same;
+	}
+
+	template<typename Tjudge>
+	void set_plan(
+		const MPI_Comm &mpi_comm,
+		const T_Ds &Ds_in,
+		const Tjudge &judge,
+		const std::size_t version_in);
+
+	// set_plan() to move Ds_in, distributed by the judges before, to the processes required by judge now.
+	// Tensors already in this process are not received, and each of the others only from the first process holding it.
+	template<typename Tjudge>
+	void set_plan_redistribute(
+		const MPI_Comm &mpi_comm,
+		const T_Ds &Ds_in,
+		const Tjudge &judge,
+		const std::size_t version_in)
+	{
+		const std::vector<std::tuple<TA,TAC>> keys = get_keys(Ds_in);
+		const Judge_Redistribute<Tjudge> judge_redistribute(judge, std::set<std::tuple<TA,TAC>>(keys.begin(), keys.end()));
+		this->set_plan(mpi_comm, Ds_in, judge_redistribute, version_in);
+	}
+
+	T_Ds communicate(
+		const MPI_Comm &mpi_comm,
+		const T_Ds &Ds_in) const;
+
+public:		// private:
+	bool flag_set = false;
+	std::size_t version = 0;
+	std::vector<std::tuple<TA,TAC>> keys_local;					// keys of Ds_in when set
+	std::vector<std::vector<std::size_t>> send_list;			// send_list[rank]: index in keys_local
+	std::vector<std::vector<std::tuple<TA,TAC>>> recv_list;		// recv_list[rank]: keys from rank
+
+public:		// private:
+	// judge of set_plan_redistribute(), called by set_plan() in the order of processes
+	template<typename Tjudge>
+	class Judge_Redistribute
+	{
+	public:
+		Judge_Redistribute(const Tjudge &judge_in, std::set<std::tuple<TA,TAC>> &&keys_in)
+			:judge_new(judge_in), keys_have(std::move(keys_in)){}
+		bool judge(const std::tuple<TA,TAC> &key) const
+		{
+			return this->judge_new.judge(key) && this->keys_have.insert(key).second;
+		}
+	private:
+		const Tjudge &judge_new;
+		mutable std::set<std::tuple<TA,TAC>> keys_have;		// keys in this process or to be received
+	};
+
+	static constexpr int tag = 23;
+	static constexpr std::size_t key_bytes = 2*sizeof(TA) + sizeof(TC);
+
+	static std::vector<std::tuple<TA,TAC>> get_keys(const T_Ds &Ds)
+	{
+		std::vector<std::tuple<TA,TAC>> keys;
+		for(const auto &Ds_A : Ds)
+			for(const auto &D_A : Ds_A.second)
+				keys.push_back(std::make_tuple(Ds_A.first, D_A.first));
+		return keys;
+	}
+
+	// MPI count is int, so send large buffers in pieces
+	static void isend_bytes(const char*const ptr, const std::size_t size, const int rank, const MPI_Comm &mpi_comm, std::vector<MPI_Request> &requests)
+	{
+		constexpr std::size_t size_max = std::numeric_limits<int>::max();
+		for(std::size_t i=0; i<size; i+=size_max)
+		{
+			requests.push_back(MPI_Request());
+			MPI_CHECK( MPI_Isend(ptr+i, static_cast<int>(std::min(size_max,size-i)), MPI_BYTE, rank, tag, mpi_comm, &requests.back()) );
+		}
+	}
+	static void irecv_bytes(char*const ptr, const std::size_t size, const int rank, const MPI_Comm &mpi_comm, std::vector<MPI_Request> &requests)
+	{
+		constexpr std::size_t size_max = std::numeric_limits<int>::max();
+		for(std::size_t i=0; i<size; i+=size_max)
+		{
+			requests.push_back(MPI_Request());
+			MPI_CHECK( MPI_Irecv(ptr+i, static_cast<int>(std::min(size_max,size-i)), MPI_BYTE, rank, tag, mpi_comm, &requests.back()) );
+		}
+	}
+
+	// send buffers[rank] to each rank, return buffers received from each rank
+	static std::vector<std::vector<char>> alltoall_bytes(
+		const MPI_Comm &mpi_comm,
+		const std::vector<std::vector<char>> &buffers_send)
+	{
+		const int rank_size = MPI_Wrapper::mpi_get_size(mpi_comm);
+		std::vector<unsigned long long> sizes_send(rank_size), sizes_recv(rank_size);
+		for(int rank=0; rank<rank_size; ++rank)
+			sizes_send[rank] = buffers_send[rank].size();
+		MPI_CHECK( MPI_Alltoall(sizes_send.data(), 1, MPI_UNSIGNED_LONG_LONG, sizes_recv.data(), 1, MPI_UNSIGNED_LONG_LONG, mpi_comm) );
+
+		std::vector<std::vector<char>> buffers_recv(rank_size);
+		std::vector<MPI_Request> requests;
+		for(int rank=0; rank<rank_size; ++rank)
+		{
+			buffers_recv[rank].resize(sizes_recv[rank]);
+			irecv_bytes(buffers_recv[rank].data(), buffers_recv[rank].size(), rank, mpi_comm, requests);
+		}
+		for(int rank=0; rank<rank_size; ++rank)
+			isend_bytes(buffers_send[rank].data(), buffers_send[rank].size(), rank, mpi_comm, requests);
+		MPI_CHECK( MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE) );
+		return buffers_recv;
+	}
+
+	// hindexed MPI_BYTE over the data of Ds, addressed from MPI_BOTTOM.
+	// return false if there is no data.
+	static bool create_datatype(const std::vector<const Tensor<Tdata>*> &Ds, MPI_Datatype &datatype)
+	{
+		std::vector<int> lengths;
+		std::vector<MPI_Aint> displacements;
+		for(const Tensor<Tdata>* D : Ds)
+		{
+			if(D->empty() || !D->get_shape_all())	continue;
+			MPI_Aint address;
+			MPI_CHECK( MPI_Get_address(D->ptr(), &address) );
+			lengths.push_back(static_cast<int>(D->get_shape_all()*sizeof(Tdata)));
+			displacements.push_back(address);
+		}
+		if(lengths.empty())
+			return false;
+		MPI_CHECK( MPI_Type_create_hindexed(static_cast<int>(lengths.size()), lengths.data(), displacements.data(), MPI_BYTE, &datatype) );
+		MPI_CHECK( MPI_Type_commit(&datatype) );
+		return true;
+	}
+
+	template<typename T>
+	static void write(std::vector<char> &buffer, const T*const ptr, const std::size_t size=1)
+	{
+		const std::size_t begin = buffer.size();
+		buffer.resize(begin + size*sizeof(T));
+		std::memcpy(buffer.data()+begin, ptr, size*sizeof(T));
+	}
+	template<typename T>
+	static void read(const std::vector<char> &buffer, std::size_t &pos, T*const ptr, const std::size_t size=1)
+	{
+		std::memcpy(ptr, buffer.data()+pos, size*sizeof(T));
+		pos += size*sizeof(T);
+	}
+};
+
+
+
+template<typename TA, typename TC, typename Tdata>
+template<typename Tjudge>
+void Communicate_Tensors_Map_Plan<TA,TC,Tdata>::set_plan(
+	const MPI_Comm &mpi_comm,
+	const T_Ds &Ds_in,
+	const Tjudge &judge,
+	const std::size_t version_in)
+{
+	const int rank_size = MPI_Wrapper::mpi_get_size(mpi_comm);
+
+	this->keys_local = get_keys(Ds_in);
+	this->version = version_in;
+
+	// gather keys of all processes
+	std::vector<char> keys_send;
+	keys_send.reserve(this->keys_local.size() * key_bytes);
+	for(const std::tuple<TA,TAC> &key : this->keys_local)
+	{
+		write(keys_send, &std::get<0>(key));
+		write(keys_send, &std::get<1>(key).first);
+		write(keys_send, &std::get<1>(key).second);
+	}
+	int size_send = static_cast<int>(keys_send.size());
+	std::vector<int> sizes_recv(rank_size), displs_recv(rank_size+1, 0);
+	MPI_CHECK( MPI_Allgather(&size_send, 1, MPI_INT, sizes_recv.data(), 1, MPI_INT, mpi_comm) );
+	for(int rank=0; rank<rank_size; ++rank)
+		displs_recv[rank+1] = displs_recv[rank] + sizes_recv[rank];
+	std::vector<char> keys_recv(displs_recv[rank_size]);
+	MPI_CHECK( MPI_Allgatherv(keys_send.data(), size_send, MPI_BYTE, keys_recv.data(), sizes_recv.data(), displs_recv.data(), MPI_BYTE, mpi_comm) );
+
+	// judge keys of each process, recv_list[rank] and the indexes required from rank
+	this->recv_list.clear();
+	this->recv_list.resize(rank_size);
+	std::vector<std::vector<char>> requires_send(rank_size);
+	for(int rank=0; rank<rank_size; ++rank)
+	{
+		std::size_t pos = displs_recv[rank];
+		for(std::size_t index=0; pos<static_cast<std::size_t>(displs_recv[rank+1]); ++index)
+		{
+			std::tuple<TA,TAC> key;
+			read(keys_recv, pos, &std::get<0>(key));
+			read(keys_recv, pos, &std::get<1>(key).first);
+			read(keys_recv, pos, &std::get<1>(key).second);
+			if(judge.judge(key))
+			{
+				this->recv_list[rank].push_back(key);
+				write(requires_send[rank], &index);
+			}
+		}
+	}
+
+	// send_list[rank] is what rank requires
+	const std::vector<std::vector<char>> requires_recv = alltoall_bytes(mpi_comm, requires_send);
+	this->send_list.clear();
+	this->send_list.resize(rank_size);
+	for(int rank=0; rank<rank_size; ++rank)
+	{
+		this->send_list[rank].resize(requires_recv[rank].size()/sizeof(std::size_t));
+		std::size_t pos = 0;
+		read(requires_recv[rank], pos, this->send_list[rank].data(), this->send_list[rank].size());
+	}
+
+	this->flag_set = true;
+}
+
+template<typename TA, typename TC, typename Tdata>
+auto Communicate_Tensors_Map_Plan<TA,TC,Tdata>::communicate(
+	const MPI_Comm &mpi_comm,
+	const T_Ds &Ds_in) const
+-> T_Ds
+{
+	const int rank_size = MPI_Wrapper::mpi_get_size(mpi_comm);
+	const int rank_mine = MPI_Wrapper::mpi_get_rank(mpi_comm);
+
+	std::vector<const Tensor<Tdata>*> Ds_local;
+	Ds_local.reserve(this->keys_local.size());
+	for(const auto &Ds_A : Ds_in)
+		for(const auto &D_A : Ds_A.second)
+			Ds_local.push_back(&D_A.second);
+	assert(Ds_local.size()==this->keys_local.size());
+
+	// header: shapes of tensors in order of send_list[rank]
+	std::vector<std::vector<char>> headers_send(rank_size);
+	for(int rank=0; rank<rank_size; ++rank)
+	{
+		if(rank==rank_mine)	continue;
+		for(const std::size_t index : this->send_list[rank])
+			write(headers_send[rank], &Ds_local[index]->shape);
+	}
+	const std::vector<std::vector<char>> headers_recv = alltoall_bytes(mpi_comm, headers_send);
+
+	// receive directly into the tensors to be returned
+	std::vector<std::vector<Tensor<Tdata>>> Ds_recv(rank_size);
+	for(int rank=0; rank<rank_size; ++rank)
+	{
+		if(rank==rank_mine)	continue;
+		std::size_t pos = 0;
+		Ds_recv[rank].reserve(this->recv_list[rank].size());
+		for(std::size_t i=0; i<this->recv_list[rank].size(); ++i)
+		{
+			Shape_Vector shape;
+			read(headers_recv[rank], pos, &shape);
+			Ds_recv[rank].push_back(shape.empty() ? Tensor<Tdata>() : Tensor<Tdata>(shape));
+		}
+	}
+
+	// payload: MPI datatype over the storage of tensors, without packing
+	std::vector<MPI_Datatype> datatypes;
+	std::vector<MPI_Request> requests;
+	for(int rank=0; rank<rank_size; ++rank)
+	{
+		if(rank==rank_mine)	continue;
+		std::vector<const Tensor<Tdata>*> Ds_ptr;
+		for(const Tensor<Tdata> &D : Ds_recv[rank])
+			Ds_ptr.push_back(&D);
+		MPI_Datatype datatype;
+		if(create_datatype(Ds_ptr, datatype))
+		{
+			datatypes.push_back(datatype);
+			requests.push_back(MPI_Request());
+			MPI_CHECK( MPI_Irecv(MPI_BOTTOM, 1, datatype, rank, tag, mpi_comm, &requests.back()) );
+		}
+	}
+	for(int rank=0; rank<rank_size; ++rank)
+	{
+		if(rank==rank_mine)	continue;
+		std::vector<const Tensor<Tdata>*> Ds_ptr;
+		for(const std::size_t index : this->send_list[rank])
+			Ds_ptr.push_back(Ds_local[index]);
+		MPI_Datatype datatype;
+		if(create_datatype(Ds_ptr, datatype))
+		{
+			datatypes.push_back(datatype);
+			requests.push_back(MPI_Request());
+			MPI_CHECK( MPI_Isend(MPI_BOTTOM, 1, datatype, rank, tag, mpi_comm, &requests.back()) );
+		}
+	}
+	MPI_CHECK( MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE) );
+	for(MPI_Datatype &datatype : datatypes)
+		MPI_CHECK( MPI_Type_free(&datatype) );
+
+	T_Ds Ds_out;
+	auto add_D = [&Ds_out](const std::tuple<TA,TAC> &key, const Tensor<Tdata> &D)
+	{
+		if(D.empty())	return;
+		Tensor<Tdata> &D_out = Ds_out[std::get<0>(key)][std::get<1>(key)];
+		if(D_out.empty())
+			D_out = D;						// share memory
+		else
+			D_out = D_out + D;				// new tensor
+	};
+	for(int rank=0; rank<rank_size; ++rank)
+	{
+		if(rank==rank_mine)
+			for(std::size_t i=0; i<this->send_list[rank].size(); ++i)
+				add_D(this->recv_list[rank][i], *Ds_local[this->send_list[rank][i]]);
+		else
+			for(std::size_t i=0; i<this->recv_list[rank].size(); ++i)
+				add_D(this->recv_list[rank][i], Ds_recv[rank][i]);
+	}
+	return Ds_out;
+}
+
+}
+
+#undef MPI_CHECK
\ No newline at end of file
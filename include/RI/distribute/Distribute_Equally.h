@@ -58,6 +58,31 @@ namespace Distribute_Equally
 		const std::array<Tcell,Ndim> &period,
 		const std::size_t num_index,
 		const bool flag_task_repeatable);
+
+
+
+	// 与上面相同的进程划分，但按 atoms 和 atoms_periods 的给定顺序（如 Divide_Atoms::sort_hilbert() 的空间顺序）连续均分，
+	// 而非按 atom 编号顺序。atoms_periods 为全部{atom,cell}。
+
+	// 第0维按照atoms、剩余维按照{atom,period}，按给定顺序尽可能均分
+	template<typename TA, typename TAC>
+	extern std::pair<std::vector<TA>,
+	                 std::vector<std::vector<TAC>>>
+	distribute_atoms_periods(
+		const MPI_Comm &mpi_comm,
+		const std::vector<TA> &atoms,
+		const std::vector<TAC> &atoms_periods,
+		const std::size_t num_index,
+		const bool flag_task_repeatable);
+
+	// 全部维按照{atom,period}，按给定顺序尽可能均分
+	template<typename TAC>
+	extern std::vector<std::vector<TAC>>
+	distribute_periods(
+		const MPI_Comm &mpi_comm,
+		const std::vector<TAC> &atoms_periods,
+		const std::size_t num_index,
+		const bool flag_task_repeatable);
 }
 
 }
\ No newline at end of file
@@ -126,6 +126,72 @@ namespace Distribute_Equally
 				period);
 		return atoms_split_list;
 	}
+
+	// 第0维按照atoms、剩余维按照{atom,period}，按给定顺序尽可能均分
+	template<typename TA, typename TAC>
+	std::pair<std::vector<TA>,
+	          std::vector<std::vector<TAC>>>
+	distribute_atoms_periods(
+		const MPI_Comm &mpi_comm,
+		const std::vector<TA> &atoms,
+		const std::vector<TAC> &atoms_periods,
+		const std::size_t num_index,
+		const bool flag_task_repeatable)
+	{
+		assert(num_index>=1);
+
+		std::vector<std::size_t> task_sizes(num_index, atoms_periods.size());
+		task_sizes[0] = atoms.size();
+		const std::vector<std::tuple<MPI_Wrapper::mpi_comm, std::size_t, std::size_t>>
+			comm_color_sizes = Split_Processes::split_all(mpi_comm, task_sizes);
+
+		std::pair<std::vector<TA>, std::vector<std::vector<TAC>>> atoms_split_list;
+		atoms_split_list.second.resize(num_index-1);
+
+		if(!flag_task_repeatable)
+			if(RI::MPI_Wrapper::mpi_get_rank(std::get<0>(comm_color_sizes.back())()))
+				return atoms_split_list;
+
+		atoms_split_list.first = Divide_Atoms::divide_atoms(
+			std::get<1>(comm_color_sizes[1]),
+			std::get<2>(comm_color_sizes[1]),
+			atoms);
+		for(std::size_t i=1; i<num_index; ++i)
+			atoms_split_list.second[i-1] = Divide_Atoms::divide_atoms(
+				std::get<1>(comm_color_sizes[i+1]),
+				std::get<2>(comm_color_sizes[i+1]),
+				atoms_periods);
+		return atoms_split_list;
+	}
+
+	// 全部维按照{atom,period}，按给定顺序尽可能均分
+	template<typename TAC>
+	std::vector<std::vector<TAC>>
+	distribute_periods(
+		const MPI_Comm &mpi_comm,
+		const std::vector<TAC> &atoms_periods,
+		const std::size_t num_index,
+		const bool flag_task_repeatable)
+	{
+		assert(num_index>=1);
+
+		const std::vector<std::size_t> task_sizes(num_index, atoms_periods.size());
+		const std::vector<std::tuple<MPI_Wrapper::mpi_comm, std::size_t, std::size_t>>
+			comm_color_sizes = Split_Processes::split_all(mpi_comm, task_sizes);
+
+		std::vector<std::vector<TAC>> atoms_split_list(num_index);
+
+		if(!flag_task_repeatable)
+			if(RI::MPI_Wrapper::mpi_get_rank(std::get<0>(comm_color_sizes.back())()))
+				return atoms_split_list;
+
+		for(std::size_t i=0; i<num_index; ++i)
+			atoms_split_list[i] = Divide_Atoms::divide_atoms(
+				std::get<1>(comm_color_sizes[i+1]),
+				std::get<2>(comm_color_sizes[i+1]),
+				atoms_periods);
+		return atoms_split_list;
+	}
 }
 
 }
\ No newline at end of file
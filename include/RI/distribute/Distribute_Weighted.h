@@ -0,0 +1,48 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Distribute_Weighted.hpp"
+
+#include <vector>
+#include <array>
+#include <map>
+#include <utility>
+#include <mpi.h>
+
+namespace RI
+{
+
+namespace Distribute_Weighted
+{
+	// 与 Distribute_Equally 相同的进程划分，但每维上按 atoms_weight 之和尽可能均分，而非按个数均分。
+	// atoms_weight 中不存在的 atom 权重为1。
+
+	// 第0维按照atoms、剩余维按照{atom,period}，按权重尽可能均分
+	template<typename TA, typename Tcell, std::size_t Ndim>
+	extern std::pair<std::vector<TA>,
+	                 std::vector<std::vector<std::pair<TA,std::array<Tcell,Ndim>>>>>
+	distribute_atoms_periods(
+		const MPI_Comm &mpi_comm,
+		const std::vector<TA> &atoms,
+		const std::array<Tcell,Ndim> &period,
+		const std::size_t num_index,
+		const bool flag_task_repeatable,
+		const std::map<TA,double> &atoms_weight);
+
+	// 全部维按照{atom,period}，按权重尽可能均分
+	template<typename TA, typename Tcell, std::size_t Ndim>
+	extern std::vector<std::vector<std::pair<TA,std::array<Tcell,Ndim>>>>
+	distribute_periods(
+		const MPI_Comm &mpi_comm,
+		const std::vector<TA> &atoms,
+		const std::array<Tcell,Ndim> &period,
+		const std::size_t num_index,
+		const bool flag_task_repeatable,
+		const std::map<TA,double> &atoms_weight);
+}
+
+}
\ No newline at end of file
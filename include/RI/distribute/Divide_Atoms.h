@@ -7,7 +7,9 @@
 
 #include <vector>
 #include <array>
+#include <map>
 #include <utility>
+#include <cstdint>
 
 namespace RI
 {
@@ -41,6 +43,40 @@ namespace Divide_Atoms
 		const std::size_t group_size,
 		const std::vector<TA> &atoms,
 		const std::array<Tcell,Ndim> &period);
+
+	// divide atoms into contiguous parts with sum of atoms_weight as equal as possible (weight=4,1,1,1,1):
+	// 	[0]  [1,2,3,4]
+	// atoms not in atoms_weight are of weight 1.
+	template<typename TA>
+	extern std::vector<TA> divide_atoms_weighted(
+		const std::size_t group_rank,
+		const std::size_t group_size,
+		const std::vector<TA> &atoms,
+		const std::map<TA,double> &atoms_weight);
+
+	// divide atoms and periods into contiguous parts with sum of atoms_weight as equal as possible (period=2, weight=4,1,1,1,1):
+	// 	[{0,0},{0,1}]  [{1,0},{1,1},{2,0},{2,1},{3,0},{3,1},{4,0},{4,1}]
+	template<typename TA, typename Tcell, std::size_t Ndim>
+	extern std::vector<std::pair<TA,std::array<Tcell,Ndim>>> divide_atoms_periods_weighted(
+		const std::size_t group_rank,
+		const std::size_t group_size,
+		const std::vector<TA> &atoms,
+		const std::array<Tcell,Ndim> &period,
+		const std::map<TA,double> &atoms_weight);
+
+	// index of point X along the Hilbert curve through 2^bits points in each dimension, bits*Ndim<=64 (2D, bits=1):
+	// 	{0,0}->0  {0,1}->1  {1,1}->2  {1,0}->3
+	template<std::size_t Ndim>
+	extern std::uint64_t hilbert_index(
+		std::array<std::uint32_t,Ndim> X,
+		const std::size_t bits);
+
+	// items sorted by hilbert_index() of positions in their bounding box, so that items contiguous in the order are also close in space.
+	// positions[i] is of items[i].
+	template<typename T, std::size_t Ndim>
+	extern std::vector<T> sort_hilbert(
+		const std::vector<T> &items,
+		const std::vector<std::array<double,Ndim>> &positions);
 }
 
 }
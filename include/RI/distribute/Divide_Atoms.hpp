@@ -9,8 +9,10 @@
 #include "../global/Global_Func-3.h"
 
 #include <numeric>
+#include <algorithm>
 #include <stdexcept>
 #include <string>
+#include <cassert>
 
 namespace RI
 {
@@ -158,6 +160,168 @@ namespace Divide_Atoms
 		}
 		throw std::range_error(std::string(__FILE__)+" line "+std::to_string(__LINE__));
 	}
+
+	// {index_begin, index_end} of group_rank, when dividing weights into group_size contiguous parts.
+	// each part takes items until its sum is nearest to (remaining weights)/(remaining parts),
+	// and at least one item if there are no fewer items than parts left.
+	inline std::pair<std::size_t,std::size_t> divide_weights(
+		const std::size_t group_rank,
+		const std::size_t group_size,
+		const std::vector<double> &weights)
+	{
+		double weight_remain = std::accumulate(weights.begin(), weights.end(), 0.0);
+		std::size_t index_begin = 0;
+		for(std::size_t group=0; group<group_size; ++group)
+		{
+			const std::size_t group_remain = group_size - group;
+			std::size_t index_end = index_begin;
+			if(group_remain==1)
+			{
+				index_end = weights.size();
+			}
+			else
+			{
+				const double weight_target = weight_remain / group_remain;
+				double weight_group = 0;
+				while(index_end < weights.size())
+				{
+					const bool flag_need_one = (index_end==index_begin) && (weights.size()-index_begin >= group_remain);
+					if(!flag_need_one && weight_group + weights[index_end]/2 > weight_target)
+						break;
+					if(weights.size()-index_end <= group_remain-1 && !flag_need_one)
+						break;
+					weight_group += weights[index_end];
+					++index_end;
+				}
+				weight_remain -= weight_group;
+			}
+			if(group==group_rank)
+				return {index_begin, index_end};
+			index_begin = index_end;
+		}
+		throw std::range_error(std::string(__FILE__)+" line "+std::to_string(__LINE__));
+	}
+
+	template<typename TA>
+	inline double get_atom_weight(const std::map<TA,double> &atoms_weight, const TA &atom)
+	{
+		const auto ptr = atoms_weight.find(atom);
+		return (ptr==atoms_weight.end()) ? 1.0 : ptr->second;
+	}
+
+	template<typename TA>
+	std::vector<TA> divide_atoms_weighted(
+		const std::size_t group_rank,
+		const std::size_t group_size,
+		const std::vector<TA> &atoms,
+		const std::map<TA,double> &atoms_weight)
+	{
+		std::vector<double> weights(atoms.size());
+		for(std::size_t iatom=0; iatom<atoms.size(); ++iatom)
+			weights[iatom] = get_atom_weight(atoms_weight, atoms[iatom]);
+		const std::pair<std::size_t,std::size_t> index = divide_weights(group_rank, group_size, weights);
+		return std::vector<TA>(atoms.begin()+index.first, atoms.begin()+index.second);
+	}
+
+	template<typename TA, typename Tcell, std::size_t Ndim>
+	std::vector<std::pair<TA,std::array<Tcell,Ndim>>> divide_atoms_periods_weighted(
+		const std::size_t group_rank,
+		const std::size_t group_size,
+		const std::vector<TA> &atoms,
+		const std::array<Tcell,Ndim> &period,
+		const std::map<TA,double> &atoms_weight)
+	{
+		using TAC = std::pair<TA,std::array<Tcell,Ndim>>;
+		const std::vector<TAC> atoms_periods = traversal_atom_period(atoms, period);
+		std::vector<double> weights(atoms_periods.size());
+		for(std::size_t i=0; i<atoms_periods.size(); ++i)
+			weights[i] = get_atom_weight(atoms_weight, atoms_periods[i].first);
+		const std::pair<std::size_t,std::size_t> index = divide_weights(group_rank, group_size, weights);
+		return std::vector<TAC>(atoms_periods.begin()+index.first, atoms_periods.begin()+index.second);
+	}
+
+	// J. Skilling, AIP Conf. Proc. 707, 381 (2004): X transformed in place to the transposed Hilbert index,
+	// whose bits interleaved from the highest give the index.
+	template<std::size_t Ndim>
+	std::uint64_t hilbert_index(
+		std::array<std::uint32_t,Ndim> X,
+		const std::size_t bits)
+	{
+		if(bits*Ndim>64)
+			throw std::invalid_argument("bits*Ndim="+std::to_string(bits*Ndim)+" > 64. "+std::string(__FILE__)+" line "+std::to_string(__LINE__));
+		if(bits==0)
+			return 0;
+		const std::uint32_t M = std::uint32_t(1) << (bits-1);
+		for(std::uint32_t Q=M; Q>1; Q>>=1)
+		{
+			const std::uint32_t P = Q-1;
+			for(std::size_t i=0; i<Ndim; ++i)
+			{
+				if(X[i] & Q)
+				{
+					X[0] ^= P;
+				}
+				else
+				{
+					const std::uint32_t t = (X[0]^X[i]) & P;
+					X[0] ^= t;
+					X[i] ^= t;
+				}
+			}
+		}
+		for(std::size_t i=1; i<Ndim; ++i)
+			X[i] ^= X[i-1];
+		std::uint32_t t = 0;
+		for(std::uint32_t Q=M; Q>1; Q>>=1)
+			if(X[Ndim-1] & Q)
+				t ^= Q-1;
+		for(std::size_t i=0; i<Ndim; ++i)
+			X[i] ^= t;
+
+		std::uint64_t index = 0;
+		for(std::size_t ibit=bits; ibit-->0;)
+			for(std::size_t i=0; i<Ndim; ++i)
+				index = (index<<1) | ((X[i]>>ibit) & 1);
+		return index;
+	}
+
+	template<typename T, std::size_t Ndim>
+	std::vector<T> sort_hilbert(
+		const std::vector<T> &items,
+		const std::vector<std::array<double,Ndim>> &positions)
+	{
+		assert(items.size()==positions.size());
+		if(items.empty())
+			return items;
+		constexpr std::size_t bits = std::min(std::size_t(32), 64/Ndim);
+		const double grid_max = static_cast<double>((std::uint64_t(1)<<bits) - 1);
+
+		std::array<double,Ndim> pos_min = positions[0], pos_max = positions[0];
+		for(const std::array<double,Ndim> &pos : positions)
+			for(std::size_t i=0; i<Ndim; ++i)
+			{
+				pos_min[i] = std::min(pos_min[i], pos[i]);
+				pos_max[i] = std::max(pos_max[i], pos[i]);
+			}
+
+		std::vector<std::pair<std::uint64_t,std::size_t>> indexes(items.size());		// {hilbert_index, i}
+		for(std::size_t iitem=0; iitem<items.size(); ++iitem)
+		{
+			std::array<std::uint32_t,Ndim> X;
+			for(std::size_t i=0; i<Ndim; ++i)
+				X[i] = (pos_max[i]>pos_min[i])
+					? static_cast<std::uint32_t>((positions[iitem][i]-pos_min[i]) / (pos_max[i]-pos_min[i]) * grid_max)
+					: 0;
+			indexes[iitem] = {hilbert_index(X, bits), iitem};
+		}
+		std::sort(indexes.begin(), indexes.end());
+
+		std::vector<T> items_sort;
+		items_sort.reserve(items.size());
+		for(const auto &index : indexes)
+			items_sort.push_back(items[index.second]);
+		return items_sort;
+	}
 }
 
 }
\ No newline at end of file
@@ -66,6 +66,26 @@ extern "C"
 		const std::complex<double>*const alpha, const std::complex<double>*const A, const int*const ldA, const std::complex<double>*const B, const int*const ldB,
 		const std::complex<double>*const beta, std::complex<double>*const C, const int*const ldC);
 
+  #ifdef __MKL_RI
+	// Mc_i = alpha_g * Ma_i.? * Mb_i.? + beta_g * Mc_i, for i in group g
+	void sgemm_batch_(const char*const transA_array, const char*const transB_array, const int*const m_array, const int*const n_array, const int*const k_array,
+		const float*const alpha_array, const float**const A_array, const int*const ldA_array, const float**const B_array, const int*const ldB_array,
+		const float*const beta_array, float**const C_array, const int*const ldC_array,
+		const int*const group_count, const int*const group_size);
+	void dgemm_batch_(const char*const transA_array, const char*const transB_array, const int*const m_array, const int*const n_array, const int*const k_array,
+		const double*const alpha_array, const double**const A_array, const int*const ldA_array, const double**const B_array, const int*const ldB_array,
+		const double*const beta_array, double**const C_array, const int*const ldC_array,
+		const int*const group_count, const int*const group_size);
+	void cgemm_batch_(const char*const transA_array, const char*const transB_array, const int*const m_array, const int*const n_array, const int*const k_array,
+		const std::complex<float>*const alpha_array, const std::complex<float>**const A_array, const int*const ldA_array, const std::complex<float>**const B_array, const int*const ldB_array,
+		const std::complex<float>*const beta_array, std::complex<float>**const C_array, const int*const ldC_array,
+		const int*const group_count, const int*const group_size);
+	void zgemm_batch_(const char*const transA_array, const char*const transB_array, const int*const m_array, const int*const n_array, const int*const k_array,
+		const std::complex<double>*const alpha_array, const std::complex<double>**const A_array, const int*const ldA_array, const std::complex<double>**const B_array, const int*const ldB_array,
+		const std::complex<double>*const beta_array, std::complex<double>**const C_array, const int*const ldC_array,
+		const int*const group_count, const int*const group_size);
+  #endif
+
 	// Mc = alpha * Ma   * Ma.T + beta * C
 	// Mc = alpha * Ma.T * Ma   + beta * C
 	void dsyrk_(const char*const uploC, const char*const transA, const int*const n, const int*const k,
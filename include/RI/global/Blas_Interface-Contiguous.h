@@ -7,6 +7,7 @@
 
 #include "Blas_Interface.h"
 #include "Global_Func-2.h"
+#include "Blas_Small.h"
 
 namespace RI
 {
@@ -77,6 +78,8 @@ namespace Blas_Interface
 		const T alpha, const T*const A, const T*const B,
 		const T beta, T*const C)
 	{
+		if(Blas_Small::gemm_try(transA, transB, m, n, k, alpha, A, B, beta, C))
+			return;
 		const int ldA = (transA=='N') ? k : m;
 		const int ldB = (transB=='N') ? n : k;
 		const int ldC = n;
@@ -227,6 +227,48 @@ namespace Blas_Interface
 
 namespace Blas_Interface
 {
+	// Mc_i = alpha_g * Ma_i.? * Mb_i.? + beta_g * Mc_i, for i in group g
+	inline void gemm_batch(const char*const transA_array, const char*const transB_array, const int*const m_array, const int*const n_array, const int*const k_array,
+		const float*const alpha_array, const float**const A_array, const int*const ldA_array, const float**const B_array, const int*const ldB_array,
+		const float*const beta_array, float**const C_array, const int*const ldC_array,
+		const int group_count, const int*const group_size)
+	{
+		sgemm_batch_(transB_array, transA_array, n_array, m_array, k_array,
+			alpha_array, B_array, ldB_array, A_array, ldA_array,
+			beta_array, C_array, ldC_array,
+			&group_count, group_size);
+	}
+	inline void gemm_batch(const char*const transA_array, const char*const transB_array, const int*const m_array, const int*const n_array, const int*const k_array,
+		const double*const alpha_array, const double**const A_array, const int*const ldA_array, const double**const B_array, const int*const ldB_array,
+		const double*const beta_array, double**const C_array, const int*const ldC_array,
+		const int group_count, const int*const group_size)
+	{
+		dgemm_batch_(transB_array, transA_array, n_array, m_array, k_array,
+			alpha_array, B_array, ldB_array, A_array, ldA_array,
+			beta_array, C_array, ldC_array,
+			&group_count, group_size);
+	}
+	inline void gemm_batch(const char*const transA_array, const char*const transB_array, const int*const m_array, const int*const n_array, const int*const k_array,
+		const std::complex<float>*const alpha_array, const std::complex<float>**const A_array, const int*const ldA_array, const std::complex<float>**const B_array, const int*const ldB_array,
+		const std::complex<float>*const beta_array, std::complex<float>**const C_array, const int*const ldC_array,
+		const int group_count, const int*const group_size)
+	{
+		cgemm_batch_(transB_array, transA_array, n_array, m_array, k_array,
+			alpha_array, B_array, ldB_array, A_array, ldA_array,
+			beta_array, C_array, ldC_array,
+			&group_count, group_size);
+	}
+	inline void gemm_batch(const char*const transA_array, const char*const transB_array, const int*const m_array, const int*const n_array, const int*const k_array,
+		const std::complex<double>*const alpha_array, const std::complex<double>**const A_array, const int*const ldA_array, const std::complex<double>**const B_array, const int*const ldB_array,
+		const std::complex<double>*const beta_array, std::complex<double>**const C_array, const int*const ldC_array,
+		const int group_count, const int*const group_size)
+	{
+		zgemm_batch_(transB_array, transA_array, n_array, m_array, k_array,
+			alpha_array, B_array, ldB_array, A_array, ldA_array,
+			beta_array, C_array, ldC_array,
+			&group_count, group_size);
+	}
+
 	inline void imatcopy (const char ordering, const char trans, size_t rows, size_t cols, const float alpha, float * AB, size_t lda, size_t ldb)
 	{
 		mkl_simatcopy (ordering, trans, rows, cols, alpha, AB, lda, ldb);
@@ -0,0 +1,220 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include <type_traits>
+#include <cstddef>
+
+// -D__RI_GEMM_SMALL to calculate Blas_Interface::gemm() of contiguous real matrices with m*n*k <= __RI_GEMM_SMALL_MAX by Blas_Small::gemm(),
+// otherwise always by ?gemm_.
+#ifndef __RI_GEMM_SMALL_MAX
+#define __RI_GEMM_SMALL_MAX 4096
+#endif
+
+// Kernels compiled for AVX-512, AVX2 and the default target, chosen at runtime by the CPU.
+// -D__RI_NO_TARGET_CLONES to compile only for the target given by -march.
+#if defined(__GNUC__) && (__GNUC__>=12) && !defined(__clang__) && !defined(__INTEL_COMPILER) && defined(__x86_64__) && !defined(__RI_NO_TARGET_CLONES)
+#define __RI_TARGET_CLONES __attribute__((target_clones("arch=x86-64-v4","arch=x86-64-v3","default")))
+#define __RI_ALWAYS_INLINE __attribute__((always_inline))		// inlined into each clone, to be compiled for its target
+#else
+#define __RI_TARGET_CLONES
+#define __RI_ALWAYS_INLINE
+#endif
+
+namespace RI
+{
+
+namespace Blas_Small
+{
+	// For the tiny blocks of light atoms, e.g. 1~14 orbitals of H, ?gemm_ costs more in argument checking and packing than in calculating.
+	// Loops here are kept simple for the compiler to unroll and vectorize, with n known at compile time for n<=16.
+
+	// C(i0+r,j) += alpha * sum_{p in [p0,p1)} A(i0+r,p) * B_pack(p-p0,j), for r<MR.
+	// MR rows together give MR independent chains of fma, Ci[MR][Npad] staying in registers.
+	template<typename T, std::size_t N, std::size_t Npad, std::size_t MR, bool transA>
+	__RI_ALWAYS_INLINE
+	inline void gemm_fixed_rows(const int m, const int k, const int i0, const int p0, const int p1,
+		const T alpha, const T*const A, const T*const B_pack, T*const C)
+	{
+		T Ci[MR][Npad];
+		for(std::size_t r=0; r<MR; ++r)
+			for(std::size_t j=0; j<Npad; ++j)
+				Ci[r][j] = 0;
+		for(int p=p0; p<p1; ++p)
+		{
+			const T*const B_p = B_pack+(p-p0)*Npad;
+			#pragma GCC unroll 4
+			for(std::size_t r=0; r<MR; ++r)
+			{
+				const int i = i0+r;
+				const T Aip = transA ? A[p*m+i] : A[i*k+p];
+				#pragma omp simd
+				for(std::size_t j=0; j<Npad; ++j)
+					Ci[r][j] += Aip * B_p[j];
+			}
+		}
+		for(std::size_t r=0; r<MR; ++r)
+		{
+			T*const C_i = C+(i0+r)*N;
+			for(std::size_t j=0; j<N; ++j)
+				C_i[j] += alpha * Ci[r][j];
+		}
+	}
+
+	// C(i,j) = alpha * sum_p A(i,p) * B(p,j) + beta * C(i,j), all row-major, N=n.
+	// B is packed by blocks of p with rows padded to Npad, so that the innermost loop is contiguous and of full simd width.
+	template<typename T, std::size_t N, bool transA, bool transB>
+	__RI_TARGET_CLONES
+	void gemm_fixed(const int m, const int k,
+		const T alpha, const T*const A, const T*const B,
+		const T beta, T*const C)
+	{
+		constexpr std::size_t W = 64/sizeof(T);			// one cache line, 8 double or 16 float
+		constexpr std::size_t Npad = (N+W-1)/W*W;
+		constexpr int Kblock = 64;
+		constexpr std::size_t MR = 4;
+
+		for(int i=0; i<m; ++i)
+		{
+			T*const C_i = C+i*N;
+			if(beta==T(0))
+				for(std::size_t j=0; j<N; ++j)
+					C_i[j] = 0;
+			else if(beta!=T(1))
+				for(std::size_t j=0; j<N; ++j)
+					C_i[j] *= beta;
+		}
+
+		alignas(64) T B_pack[Kblock*Npad];
+		for(int p0=0; p0<k; p0+=Kblock)
+		{
+			const int p1 = (p0+Kblock<k) ? p0+Kblock : k;
+			for(int p=p0; p<p1; ++p)
+			{
+				T*const B_pack_p = B_pack+(p-p0)*Npad;
+				for(std::size_t j=0; j<N; ++j)
+					B_pack_p[j] = transB ? B[j*k+p] : B[p*N+j];
+				for(std::size_t j=N; j<Npad; ++j)
+					B_pack_p[j] = 0;
+			}
+			int i0 = 0;
+			for(; i0+int(MR)<=m; i0+=MR)
+				gemm_fixed_rows<T,N,Npad,MR,transA>(m, k, i0, p0, p1, alpha, A, B_pack, C);
+			for(; i0<m; ++i0)
+				gemm_fixed_rows<T,N,Npad,1,transA>(m, k, i0, p0, p1, alpha, A, B_pack, C);
+		}
+	}
+
+	// same as gemm_fixed() for any n
+	template<typename T, bool transA, bool transB>
+	__RI_TARGET_CLONES
+	void gemm_general(const int m, const int n, const int k,
+		const T alpha, const T*const A, const T*const B,
+		const T beta, T*const C)
+	{
+		for(int i=0; i<m; ++i)
+		{
+			T*const C_i = C+i*n;
+			if(beta==T(0))
+				for(int j=0; j<n; ++j)
+					C_i[j] = 0;
+			else if(beta!=T(1))
+				for(int j=0; j<n; ++j)
+					C_i[j] *= beta;
+			if(transB)
+			{
+				for(int j=0; j<n; ++j)
+				{
+					T Cij = 0;
+					#pragma omp simd reduction(+:Cij)
+					for(int p=0; p<k; ++p)
+						Cij += (transA ? A[p*m+i] : A[i*k+p]) * B[j*k+p];
+					C_i[j] += alpha * Cij;
+				}
+			}
+			else
+			{
+				for(int p=0; p<k; ++p)
+				{
+					const T Aip = alpha * (transA ? A[p*m+i] : A[i*k+p]);
+					#pragma omp simd
+					for(int j=0; j<n; ++j)
+						C_i[j] += Aip * B[p*n+j];
+				}
+			}
+		}
+	}
+
+	template<typename T, bool transA, bool transB>
+	inline void gemm_dispatch(const int m, const int n, const int k,
+		const T alpha, const T*const A, const T*const B,
+		const T beta, T*const C)
+	{
+		switch(n)
+		{
+			case 1:		gemm_fixed<T, 1,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			case 2:		gemm_fixed<T, 2,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			case 3:		gemm_fixed<T, 3,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			case 4:		gemm_fixed<T, 4,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			case 5:		gemm_fixed<T, 5,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			case 6:		gemm_fixed<T, 6,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			case 7:		gemm_fixed<T, 7,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			case 8:		gemm_fixed<T, 8,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			case 9:		gemm_fixed<T, 9,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			case 10:	gemm_fixed<T,10,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			case 11:	gemm_fixed<T,11,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			case 12:	gemm_fixed<T,12,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			case 13:	gemm_fixed<T,13,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			case 14:	gemm_fixed<T,14,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			case 15:	gemm_fixed<T,15,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			case 16:	gemm_fixed<T,16,transA,transB>(m, k, alpha, A, B, beta, C);	break;
+			default:	gemm_general<T,transA,transB>(m, n, k, alpha, A, B, beta, C);
+		}
+	}
+
+	// Mc = alpha * Ma.? * Mb.? + beta * Mc, row-major contiguous as Blas_Interface::gemm() without ld
+	template<typename T>
+	inline void gemm(const char transA, const char transB, const int m, const int n, const int k,
+		const T alpha, const T*const A, const T*const B,
+		const T beta, T*const C)
+	{
+		const bool tA = (transA!='N');			// 'C' same as 'T' for real
+		const bool tB = (transB!='N');
+		if(!tA && !tB)		gemm_dispatch<T,false,false>(m, n, k, alpha, A, B, beta, C);
+		else if(!tA && tB)	gemm_dispatch<T,false,true >(m, n, k, alpha, A, B, beta, C);
+		else if(tA && !tB)	gemm_dispatch<T,true ,false>(m, n, k, alpha, A, B, beta, C);
+		else				gemm_dispatch<T,true ,true >(m, n, k, alpha, A, B, beta, C);
+	}
+
+#ifdef __RI_GEMM_SMALL
+	// gemm() if m*n*k <= __RI_GEMM_SMALL_MAX, return whether calculated.
+	template<typename T,
+		typename std::enable_if<std::is_floating_point<T>::value,bool>::type=0>
+	inline bool gemm_try(const char transA, const char transB, const int m, const int n, const int k,
+		const T alpha, const T*const A, const T*const B,
+		const T beta, T*const C)
+	{
+		if(static_cast<double>(m)*n*k > __RI_GEMM_SMALL_MAX)
+			return false;
+		gemm(transA, transB, m, n, k, alpha, A, B, beta, C);
+		return true;
+	}
+	// complex always by ?gemm_, std::complex arithmetic here is not vectorized
+	template<typename T,
+		typename std::enable_if<!std::is_floating_point<T>::value,bool>::type=0>
+#else
+	// always by ?gemm_ without __RI_GEMM_SMALL
+	template<typename T>
+#endif
+	inline bool gemm_try(const char, const char, const int, const int, const int,
+		const T, const T*const, const T*const,
+		const T, T*const)
+	{
+		return false;
+	}
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,269 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Tensor.h"
+#include "Global_Func-2.h"
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <array>
+#include <utility>
+#include <cstdint>
+#include <type_traits>
+#include <stdexcept>
+
+namespace RI
+{
+
+// Binary checkpoint of LRI, Exx and GW, read back only by the same build on the same platform.
+// Tensors of std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>> are written as a key index followed by one aligned slab of data,
+// so that reading is a sequential pass limited by disk bandwidth.
+namespace Checkpoint
+{
+	constexpr std::size_t alignment = 64;
+
+	inline void check(const std::ios &s, const std::string &file, const int line)
+	{
+		if(!s.good())
+			throw std::runtime_error("checkpoint stream failed. "+file+" line "+std::to_string(line));
+	}
+
+	template<typename T, typename std::enable_if<std::is_trivially_copyable<T>::value,bool>::type=0>
+	void write(std::ostream &os, const T &v);
+	inline void write(std::ostream &os, const std::string &v);
+	template<typename T1, typename T2> void write(std::ostream &os, const std::pair<T1,T2> &v);
+	template<typename T> void write(std::ostream &os, const std::vector<T> &v);
+	template<typename T> void write(std::ostream &os, const std::set<T> &v);
+	template<typename Tkey, typename Tvalue> void write(std::ostream &os, const std::map<Tkey,Tvalue> &v);
+	template<typename Tkey, typename Tvalue> void write(std::ostream &os, const std::unordered_map<Tkey,Tvalue> &v);
+
+	template<typename T, typename std::enable_if<std::is_trivially_copyable<T>::value,bool>::type=0>
+	void read(std::istream &is, T &v);
+	inline void read(std::istream &is, std::string &v);
+	template<typename T1, typename T2> void read(std::istream &is, std::pair<T1,T2> &v);
+	template<typename T> void read(std::istream &is, std::vector<T> &v);
+	template<typename T> void read(std::istream &is, std::set<T> &v);
+	template<typename Tkey, typename Tvalue> void read(std::istream &is, std::map<Tkey,Tvalue> &v);
+	template<typename Tkey, typename Tvalue> void read(std::istream &is, std::unordered_map<Tkey,Tvalue> &v);
+
+	template<typename T, typename std::enable_if<std::is_trivially_copyable<T>::value,bool>::type>
+	void write(std::ostream &os, const T &v)
+	{
+		os.write(reinterpret_cast<const char*>(&v), sizeof(T));
+	}
+	inline void write(std::ostream &os, const std::string &v)
+	{
+		write(os, static_cast<std::uint64_t>(v.size()));
+		os.write(v.data(), v.size());
+	}
+	template<typename T1, typename T2>
+	void write(std::ostream &os, const std::pair<T1,T2> &v)
+	{
+		write(os, v.first);
+		write(os, v.second);
+	}
+	template<typename T>
+	void write(std::ostream &os, const std::vector<T> &v)
+	{
+		write(os, static_cast<std::uint64_t>(v.size()));
+		for(const T &i : v)
+			write(os, i);
+	}
+	template<typename T>
+	void write(std::ostream &os, const std::set<T> &v)
+	{
+		write(os, static_cast<std::uint64_t>(v.size()));
+		for(const T &i : v)
+			write(os, i);
+	}
+	template<typename Tkey, typename Tvalue>
+	void write(std::ostream &os, const std::map<Tkey,Tvalue> &v)
+	{
+		write(os, static_cast<std::uint64_t>(v.size()));
+		for(const auto &i : v)
+			write(os, i);
+	}
+	template<typename Tkey, typename Tvalue>
+	void write(std::ostream &os, const std::unordered_map<Tkey,Tvalue> &v)
+	{
+		write(os, static_cast<std::uint64_t>(v.size()));
+		for(const auto &i : v)
+			write(os, i);
+	}
+
+	template<typename T, typename std::enable_if<std::is_trivially_copyable<T>::value,bool>::type>
+	void read(std::istream &is, T &v)
+	{
+		is.read(reinterpret_cast<char*>(&v), sizeof(T));
+	}
+	inline void read(std::istream &is, std::string &v)
+	{
+		std::uint64_t size;	read(is, size);
+		v.resize(size);
+		is.read(&v[0], size);
+	}
+	template<typename T1, typename T2>
+	void read(std::istream &is, std::pair<T1,T2> &v)
+	{
+		read(is, v.first);
+		read(is, v.second);
+	}
+	template<typename T>
+	void read(std::istream &is, std::vector<T> &v)
+	{
+		std::uint64_t size;	read(is, size);
+		v.resize(size);
+		for(T &i : v)
+			read(is, i);
+	}
+	template<typename T>
+	void read(std::istream &is, std::set<T> &v)
+	{
+		std::uint64_t size;	read(is, size);
+		v.clear();
+		for(std::uint64_t i=0; i<size; ++i)
+		{
+			T k;	read(is, k);
+			v.insert(v.end(), std::move(k));
+		}
+	}
+	template<typename Tkey, typename Tvalue>
+	void read(std::istream &is, std::map<Tkey,Tvalue> &v)
+	{
+		std::uint64_t size;	read(is, size);
+		v.clear();
+		for(std::uint64_t i=0; i<size; ++i)
+		{
+			std::pair<Tkey,Tvalue> kv;	read(is, kv);
+			v.insert(v.end(), std::move(kv));
+		}
+	}
+	template<typename Tkey, typename Tvalue>
+	void read(std::istream &is, std::unordered_map<Tkey,Tvalue> &v)
+	{
+		std::uint64_t size;	read(is, size);
+		v.clear();
+		v.reserve(size);
+		for(std::uint64_t i=0; i<size; ++i)
+		{
+			std::pair<Tkey,Tvalue> kv;	read(is, kv);
+			v.insert(std::move(kv));
+		}
+	}
+
+	// magic, version, and descriptors of TA, Tcell, Ndim, Tdata
+	template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+	std::array<std::uint64_t,8> get_header()
+	{
+		return {0x495262694cull,		// "LibRI" in little-endian bytes
+			2,
+			sizeof(TA), std::is_integral<TA>::value,
+			sizeof(Tcell), Ndim,
+			sizeof(Tdata), std::is_same<Tdata, Global_Func::To_Real_t<Tdata>>::value};
+	}
+	template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+	void write_header(std::ostream &os)
+	{
+		write(os, get_header<TA,Tcell,Ndim,Tdata>());
+	}
+	template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+	void read_header(std::istream &is)
+	{
+		std::array<std::uint64_t,8> header;
+		read(is, header);
+		check(is, __FILE__, __LINE__);
+		if(header != get_header<TA,Tcell,Ndim,Tdata>())
+			throw std::invalid_argument("checkpoint written with other TA, Tcell, Ndim or Tdata. "+std::string(__FILE__)+" line "+std::to_string(__LINE__));
+	}
+
+	inline void write_padding(std::ostream &os)
+	{
+		const std::size_t size = (alignment - static_cast<std::size_t>(os.tellp()) % alignment) % alignment;
+		const char zeros[alignment] = {};
+		os.write(zeros, size);
+	}
+	inline void read_padding(std::istream &is)
+	{
+		const std::size_t size = (alignment - static_cast<std::size_t>(is.tellg()) % alignment) % alignment;
+		is.ignore(size);
+	}
+
+	// index: Ds.size(), {key0, Ds[key0].size(), {key1, shape}...}...
+	// slab:  data of all tensors in the order of index, starting at alignment
+	// get_D(key0,key1,D) returns the tensor with data, for Ds of shapes only, e.g. Tensors_Map2_Disk.
+	template<typename Tkey0, typename Tkey1, typename Tdata, typename Tget_D>
+	void write_tensors_map2(std::ostream &os, const std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>> &Ds, const Tget_D &get_D)
+	{
+		write(os, static_cast<std::uint64_t>(Ds.size()));
+		for(const auto &Ds_A : Ds)
+		{
+			write(os, Ds_A.first);
+			write(os, static_cast<std::uint64_t>(Ds_A.second.size()));
+			for(const auto &D_A : Ds_A.second)
+			{
+				write(os, D_A.first);
+				write(os, D_A.second.shape);
+			}
+		}
+		write_padding(os);
+		for(const auto &Ds_A : Ds)
+			for(const auto &D_A : Ds_A.second)
+			{
+				if(!D_A.second.get_shape_all())	continue;
+				const Tensor<Tdata> &D = get_D(Ds_A.first, D_A.first, D_A.second);
+				os.write(reinterpret_cast<const char*>(D.ptr()), D.get_shape_all()*sizeof(Tdata));
+			}
+		check(os, __FILE__, __LINE__);
+	}
+	template<typename Tkey0, typename Tkey1, typename Tdata>
+	void write_tensors_map2(std::ostream &os, const std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>> &Ds)
+	{
+		write_tensors_map2(os, Ds,
+			[](const Tkey0&, const Tkey1&, const Tensor<Tdata> &D) -> const Tensor<Tdata>& { return D; });
+	}
+
+	template<typename Tkey0, typename Tkey1, typename Tdata>
+	std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>> read_tensors_map2(std::istream &is)
+	{
+		std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>> Ds;
+		std::vector<Tensor<Tdata>*> Ds_ptr;
+		std::uint64_t size0;	read(is, size0);
+		for(std::uint64_t i0=0; i0<size0; ++i0)
+		{
+			Tkey0 key0;				read(is, key0);
+			std::uint64_t size1;	read(is, size1);
+			std::map<Tkey1, Tensor<Tdata>> &Ds_A = Ds[key0];
+			for(std::uint64_t i1=0; i1<size1; ++i1)
+			{
+				Tkey1 key1;	read(is, key1);
+				Tensor<Tdata> &D = Ds_A[key1];
+				read(is, D.shape);
+				Ds_ptr.push_back(&D);
+			}
+		}
+		check(is, __FILE__, __LINE__);
+		read_padding(is);
+		for(Tensor<Tdata>* D : Ds_ptr)
+		{
+			const std::size_t size_D = D->get_shape_all();
+			if(size_D)
+			{
+				D->data = std::make_shared<std::valarray<Tdata>>(size_D);
+				is.read(reinterpret_cast<char*>(D->ptr()), size_D*sizeof(Tdata));
+			}
+		}
+		check(is, __FILE__, __LINE__);
+		return Ds;
+	}
+}
+
+}
\ No newline at end of file
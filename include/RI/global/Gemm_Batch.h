@@ -0,0 +1,51 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Blas_Interface.h"
+
+#include <vector>
+
+namespace RI
+{
+
+// Collect gemm, and calculate them together in execute().
+// With __MKL_RI, gemm of the same shape are grouped into ?gemm_batch.
+// Else, gemm are calculated one by one.
+// Ma, Mb, Mc must keep alive until execute().
+template<typename Tdata>
+class Gemm_Batch
+{
+public:
+	// Mc = alpha * Ma.? * Mb.? + beta * Mc
+	void push(const char transA, const char transB, const int m, const int n, const int k,
+		const Tdata alpha, const Tdata*const A, const Tdata*const B,
+		const Tdata beta, Tdata*const C);
+
+	void execute();
+
+	bool empty() const { return this->gemms.empty(); }
+
+public:		// private:
+	struct Gemm_Args
+	{
+		char transA, transB;
+		int m, n, k;
+		Tdata alpha;
+		const Tdata *A, *B;
+		Tdata beta;
+		Tdata *C;
+	};
+	std::vector<Gemm_Args> gemms;
+
+  #ifdef __MKL_RI
+	void execute_mkl();
+  #endif
+};
+
+}
+
+#include "Gemm_Batch.hpp"
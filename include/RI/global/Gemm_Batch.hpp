@@ -0,0 +1,99 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Gemm_Batch.h"
+#include "Blas_Interface-Contiguous.h"
+
+namespace RI
+{
+
+template<typename Tdata>
+void Gemm_Batch<Tdata>::push(const char transA, const char transB, const int m, const int n, const int k,
+	const Tdata alpha, const Tdata*const A, const Tdata*const B,
+	const Tdata beta, Tdata*const C)
+{
+	this->gemms.push_back({transA, transB, m, n, k, alpha, A, B, beta, C});
+}
+
+template<typename Tdata>
+void Gemm_Batch<Tdata>::execute()
+{
+	if(this->gemms.empty())
+		return;
+  #ifdef __MKL_RI
+	if(this->gemms.size()>1)
+		this->execute_mkl();
+	else
+  #endif
+		for(const Gemm_Args &g : this->gemms)
+			Blas_Interface::gemm(g.transA, g.transB, g.m, g.n, g.k, g.alpha, g.A, g.B, g.beta, g.C);
+	this->gemms.clear();
+}
+
+#ifdef __MKL_RI
+
+template<typename Tdata>
+void Gemm_Batch<Tdata>::execute_mkl()
+{
+	struct Group
+	{
+		char transA, transB;
+		int m, n, k;
+		Tdata alpha, beta;
+		std::vector<std::size_t> indexes;
+	};
+	std::vector<Group> groups;
+	for(std::size_t i=0; i<this->gemms.size(); ++i)
+	{
+		const Gemm_Args &g = this->gemms[i];
+		auto ptr = groups.begin();
+		for(; ptr!=groups.end(); ++ptr)
+			if(ptr->transA==g.transA && ptr->transB==g.transB
+				&& ptr->m==g.m && ptr->n==g.n && ptr->k==g.k
+				&& ptr->alpha==g.alpha && ptr->beta==g.beta)
+				break;
+		if(ptr==groups.end())
+			groups.push_back({g.transA, g.transB, g.m, g.n, g.k, g.alpha, g.beta, {i}});
+		else
+			ptr->indexes.push_back(i);
+	}
+
+	std::vector<char> transA_array, transB_array;
+	std::vector<int> m_array, n_array, k_array, ldA_array, ldB_array, ldC_array, group_size;
+	std::vector<Tdata> alpha_array, beta_array;
+	std::vector<const Tdata*> A_array, B_array;
+	std::vector<Tdata*> C_array;
+	for(const Group &group : groups)
+	{
+		transA_array.push_back(group.transA);
+		transB_array.push_back(group.transB);
+		m_array.push_back(group.m);
+		n_array.push_back(group.n);
+		k_array.push_back(group.k);
+		ldA_array.push_back((group.transA=='N') ? group.k : group.m);
+		ldB_array.push_back((group.transB=='N') ? group.n : group.k);
+		ldC_array.push_back(group.n);
+		alpha_array.push_back(group.alpha);
+		beta_array.push_back(group.beta);
+		group_size.push_back(group.indexes.size());
+		for(const std::size_t i : group.indexes)
+		{
+			A_array.push_back(this->gemms[i].A);
+			B_array.push_back(this->gemms[i].B);
+			C_array.push_back(this->gemms[i].C);
+		}
+	}
+	Blas_Interface::gemm_batch(
+		transA_array.data(), transB_array.data(), m_array.data(), n_array.data(), k_array.data(),
+		alpha_array.data(), A_array.data(), ldA_array.data(), B_array.data(), ldB_array.data(),
+		beta_array.data(), C_array.data(), ldC_array.data(),
+		groups.size(), group_size.data());
+}
+
+#endif
+
+}
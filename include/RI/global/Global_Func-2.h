@@ -7,6 +7,8 @@
 
 #include <complex>
 #include <type_traits>
+#include <cmath>
+#include <cstddef>
 
 namespace RI
 {
@@ -21,12 +23,49 @@ namespace Global_Func
 	template<typename T> struct To_Complex<std::complex<T>> { using type=std::complex<T>; };
 	template<typename T> using To_Complex_t = typename To_Complex<T>::type;
 
+	// single precision of T
+	template<typename T> struct To_Float	{ using type=T; };
+	template<> struct To_Float<double> { using type=float; };
+	template<> struct To_Float<std::complex<double>> { using type=std::complex<float>; };
+	template<typename T> using To_Float_t = typename To_Float<T>::type;
+
 
 
 	template<typename> struct is_complex_helper : std::false_type {};
 	template<typename T> struct is_complex_helper<std::complex<T>> : std::true_type {};
 	template<typename T> struct is_complex : is_complex_helper<typename std::remove_const<typename std::remove_reference<T>::type>::type> {};
 
+	// max_i |a[i]|, in simd
+	template<typename T,
+		typename std::enable_if<!Global_Func::is_complex<T>::value,int>::type =0>
+	T abs_max(const T*const a, const std::size_t n)
+	{
+		T s = 0;
+		#pragma omp simd reduction(max:s)
+		for(std::size_t i=0; i<n; ++i)
+		{
+			const T x = std::abs(a[i]);
+			s = (x>s) ? x : s;
+		}
+		return s;
+	}
+	// max_i |a[i]| by max_i |a[i]|^2, without sqrt of each element
+	template<typename T,
+		typename std::enable_if<Global_Func::is_complex<T>::value,int>::type =0>
+	To_Real_t<T> abs_max(const T*const a, const std::size_t n)
+	{
+		using Treal = To_Real_t<T>;
+		const Treal*const b = reinterpret_cast<const Treal*>(a);		// std::complex<Treal> has the layout of Treal[2]
+		Treal s = 0;
+		#pragma omp simd reduction(max:s)
+		for(std::size_t i=0; i<n; ++i)
+		{
+			const Treal x = b[2*i]*b[2*i] + b[2*i+1]*b[2*i+1];
+			s = (x>s) ? x : s;
+		}
+		return std::sqrt(s);
+	}
+
 	// t = convert(t)
 	template<
 		typename Tout, typename Tin,
@@ -49,6 +88,15 @@ namespace Global_Func
 		typename std::enable_if<!Global_Func::is_complex<Tout>::value,int>::type =0>
 	Tout convert(const Tin &t)
 	{ return t.real(); }
+
+	// real = convert(real), complex = convert(complex), in different precision
+	template<
+		typename Tout, typename Tin,
+		typename std::enable_if<!std::is_same<Tin,Tout>::value,int>::type =0,
+		typename std::enable_if<Global_Func::is_complex<Tin>::value==Global_Func::is_complex<Tout>::value,int>::type =0,
+		typename std::enable_if<std::is_floating_point<To_Real_t<Tin>>::value,int>::type =0>
+	Tout convert(const Tin &t)
+	{ return Tout(t); }
 }
 
 }
\ No newline at end of file
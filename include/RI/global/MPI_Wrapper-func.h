@@ -79,7 +79,7 @@ namespace MPI_Wrapper
 		std::vector<T> ptr_out(count);
 		MPI_CHECK( MPI_Reduce(ptr, ptr_out.data(), count, mpi_get_datatype(*ptr), op, root, mpi_comm) );
 		if(mpi_get_rank(mpi_comm)==root)
-			for(std::size_t i=0; i<count; ++i)
+			for(std::size_t i=0; i<static_cast<std::size_t>(count); ++i)
 				ptr[i] = ptr_out[i];
 	}
 	template<typename T>
@@ -87,7 +87,7 @@ namespace MPI_Wrapper
 	{
 		std::vector<T> ptr_out(count);
 		MPI_CHECK( MPI_Allreduce(ptr, ptr_out.data(), count, mpi_get_datatype(*ptr), op, mpi_comm) );
-		for(std::size_t i=0; i<count; ++i)
+		for(std::size_t i=0; i<static_cast<std::size_t>(count); ++i)
 			ptr[i] = ptr_out[i];
 	}
 }
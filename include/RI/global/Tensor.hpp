@@ -204,10 +204,7 @@ Global_Func::To_Real_t<T> Tensor<T>::norm(const double p) const
 	}
 	else if(p==std::numeric_limits<double>::max())
 	{
-		T_res s = 0;
-		for(std::size_t i=0; i<this->data->size(); ++i)
-			s = std::max(std::real(s), std::abs((*this->data)[i]));
-		return s;
+		return Global_Func::abs_max(this->ptr(), this->data->size());
 	}
 	else
 	{
@@ -18,7 +18,7 @@ namespace Tensor_Multiply
 	{
 		assert(Tx.shape.size()==2);
 		assert(Ty.shape.size()==3);
-		Tensor<Tdata> Txy({Tx.shape[0], Ty.shape[0], Ty.shape[1]});
+		Tensor<Tdata> Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Ty.shape[0], Ty.shape[1]});
 		Blas_Interface::gemm(
 			'N', 'T',
 			Tx.shape[0],
@@ -35,7 +35,7 @@ namespace Tensor_Multiply
 	{
 		assert(Tx.shape.size()==2);
 		assert(Ty.shape.size()==3);
-		Tensor<Tdata> Txy({Tx.shape[0], Ty.shape[1], Ty.shape[2]});
+		Tensor<Tdata> Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Ty.shape[1], Ty.shape[2]});
 		Blas_Interface::gemm(
 			'N', 'N',
 			Tx.shape[0],
@@ -52,7 +52,7 @@ namespace Tensor_Multiply
 	{
 		assert(Tx.shape.size()==2);
 		assert(Ty.shape.size()==3);
-		Tensor<Tdata> Txy({Tx.shape[1], Ty.shape[0], Ty.shape[1]});
+		Tensor<Tdata> Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[1], Ty.shape[0], Ty.shape[1]});
 		Blas_Interface::gemm(
 			'T', 'T',
 			Tx.shape[1],
@@ -69,7 +69,7 @@ namespace Tensor_Multiply
 	{
 		assert(Tx.shape.size()==2);
 		assert(Ty.shape.size()==3);
-		Tensor<Tdata> Txy({Tx.shape[1], Ty.shape[1], Ty.shape[2]});
+		Tensor<Tdata> Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[1], Ty.shape[1], Ty.shape[2]});
 		Blas_Interface::gemm(
 			'T', 'N',
 			Tx.shape[1],
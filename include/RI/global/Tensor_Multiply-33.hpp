@@ -18,7 +18,7 @@ namespace Tensor_Multiply
 	{
 		assert(Tx.shape.size()==3);
 		assert(Ty.shape.size()==3);
-		Tensor<Tdata> Txy({Tx.shape[0], Ty.shape[0]});
+		Tensor<Tdata> Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Ty.shape[0]});
 		Blas_Interface::gemm(
 			'N', 'T',
 			Tx.shape[0],
@@ -35,7 +35,7 @@ namespace Tensor_Multiply
 	{
 		assert(Tx.shape.size()==3);
 		assert(Ty.shape.size()==3);
-		Tensor<Tdata> Txy({Tx.shape[0], Ty.shape[2]});
+		Tensor<Tdata> Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Ty.shape[2]});
 		Blas_Interface::gemm(
 			'N', 'N',
 			Tx.shape[0],
@@ -52,7 +52,7 @@ namespace Tensor_Multiply
 	{
 		assert(Tx.shape.size()==3);
 		assert(Ty.shape.size()==3);
-		Tensor<Tdata> Txy({Tx.shape[2], Ty.shape[0]});
+		Tensor<Tdata> Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[2], Ty.shape[0]});
 		Blas_Interface::gemm(
 			'T', 'T',
 			Tx.shape[2],
@@ -69,7 +69,7 @@ namespace Tensor_Multiply
 	{
 		assert(Tx.shape.size()==3);
 		assert(Ty.shape.size()==3);
-		Tensor<Tdata> Txy({Tx.shape[2], Ty.shape[2]});
+		Tensor<Tdata> Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[2], Ty.shape[2]});
 		Blas_Interface::gemm(
 			'T', 'N',
 			Tx.shape[2],
@@ -86,7 +86,7 @@ namespace Tensor_Multiply
 	{
 		assert(Tx.shape.size()==3);
 		assert(Ty.shape.size()==3);
-		Tensor<Tdata> Txy({Tx.shape[0], Tx.shape[1], Ty.shape[0], Ty.shape[1]});
+		Tensor<Tdata> Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Tx.shape[1], Ty.shape[0], Ty.shape[1]});
 		Blas_Interface::gemm(
 			'N', 'T',
 			Tx.shape[0] * Tx.shape[1],
@@ -103,7 +103,7 @@ namespace Tensor_Multiply
 	{
 		assert(Tx.shape.size()==3);
 		assert(Ty.shape.size()==3);
-		Tensor<Tdata> Txy({Tx.shape[0], Tx.shape[1], Ty.shape[1], Ty.shape[2]});
+		Tensor<Tdata> Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Tx.shape[1], Ty.shape[1], Ty.shape[2]});
 		Blas_Interface::gemm(
 			'N', 'N',
 			Tx.shape[0] * Tx.shape[1],
@@ -120,7 +120,7 @@ namespace Tensor_Multiply
 	{
 		assert(Tx.shape.size()==3);
 		assert(Ty.shape.size()==3);
-		Tensor<Tdata> Txy({Tx.shape[1], Tx.shape[2], Ty.shape[0], Ty.shape[1]});
+		Tensor<Tdata> Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[1], Tx.shape[2], Ty.shape[0], Ty.shape[1]});
 		Blas_Interface::gemm(
 			'T', 'T',
 			Tx.shape[1] * Tx.shape[2],
@@ -137,7 +137,7 @@ namespace Tensor_Multiply
 	{
 		assert(Tx.shape.size()==3);
 		assert(Ty.shape.size()==3);
-		Tensor<Tdata> Txy({Tx.shape[1], Tx.shape[2], Ty.shape[1], Ty.shape[2]});
+		Tensor<Tdata> Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[1], Tx.shape[2], Ty.shape[1], Ty.shape[2]});
 		Blas_Interface::gemm(
 			'T', 'N',
 			Tx.shape[1] * Tx.shape[2],
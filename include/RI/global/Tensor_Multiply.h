@@ -7,6 +7,7 @@
 
 #include "Tensor.h"
 #include "Blas_Interface-Contiguous.h"
+#include "Tensor_Pool.h"
 
 #include "Tensor_Multiply-22.hpp"
 #include "Tensor_Multiply-23.hpp"
@@ -0,0 +1,401 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Tensor.h"
+#include "Blas_Interface-Contiguous.h"
+#include "Tensor_Pool.h"
+
+namespace RI
+{
+
+// Txy = alpha * Tx * Ty + beta * Txy, written directly into Txy without temporary result.
+// Txy is allocated if empty, and then beta is ignored.
+// The new Txy may come uninitialized from Tensor_Pool, so it must be calculated with beta=0.
+namespace Tensor_Multiply
+{
+	// Txy(x0,y0) = alpha * Tx(x0,a) * Ty(y0,a) + beta * Txy(x0,y0)
+	template<typename Tdata>
+	void x0y0_x0a_y0a(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==2);
+		assert(Ty.shape.size()==2);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Ty.shape[0]});
+		assert(Txy.shape.size()==2 && Txy.shape[0]==Tx.shape[0] && Txy.shape[1]==Ty.shape[0]);
+		Blas_Interface::gemm(
+			'N', 'T',
+			Tx.shape[0],
+			Ty.shape[0],
+			Tx.shape[1],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x0,y1) = alpha * Tx(x0,a) * Ty(a,y1) + beta * Txy(x0,y1)
+	template<typename Tdata>
+	void x0y1_x0a_ay1(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==2);
+		assert(Ty.shape.size()==2);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Ty.shape[1]});
+		assert(Txy.shape.size()==2 && Txy.shape[0]==Tx.shape[0] && Txy.shape[1]==Ty.shape[1]);
+		Blas_Interface::gemm(
+			'N', 'N',
+			Tx.shape[0],
+			Ty.shape[1],
+			Tx.shape[1],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x1,y0) = alpha * Tx(a,x1) * Ty(y0,a) + beta * Txy(x1,y0)
+	template<typename Tdata>
+	void x1y0_ax1_y0a(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==2);
+		assert(Ty.shape.size()==2);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[1], Ty.shape[0]});
+		assert(Txy.shape.size()==2 && Txy.shape[0]==Tx.shape[1] && Txy.shape[1]==Ty.shape[0]);
+		Blas_Interface::gemm(
+			'T', 'T',
+			Tx.shape[1],
+			Ty.shape[0],
+			Tx.shape[0],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x1,y1) = alpha * Tx(a,x1) * Ty(a,y1) + beta * Txy(x1,y1)
+	template<typename Tdata>
+	void x1y1_ax1_ay1(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==2);
+		assert(Ty.shape.size()==2);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[1], Ty.shape[1]});
+		assert(Txy.shape.size()==2 && Txy.shape[0]==Tx.shape[1] && Txy.shape[1]==Ty.shape[1]);
+		Blas_Interface::gemm(
+			'T', 'N',
+			Tx.shape[1],
+			Ty.shape[1],
+			Tx.shape[0],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x0,y0,y1) = alpha * Tx(x0,a) * Ty(y0,y1,a) + beta * Txy(x0,y0,y1)
+	template<typename Tdata>
+	void x0y0y1_x0a_y0y1a(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==2);
+		assert(Ty.shape.size()==3);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Ty.shape[0], Ty.shape[1]});
+		assert(Txy.shape.size()==3 && Txy.shape[0]==Tx.shape[0] && Txy.shape[1]==Ty.shape[0] && Txy.shape[2]==Ty.shape[1]);
+		Blas_Interface::gemm(
+			'N', 'T',
+			Tx.shape[0],
+			Ty.shape[0] * Ty.shape[1],
+			Tx.shape[1],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x0,y1,y2) = alpha * Tx(x0,a) * Ty(a,y1,y2) + beta * Txy(x0,y1,y2)
+	template<typename Tdata>
+	void x0y1y2_x0a_ay1y2(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==2);
+		assert(Ty.shape.size()==3);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Ty.shape[1], Ty.shape[2]});
+		assert(Txy.shape.size()==3 && Txy.shape[0]==Tx.shape[0] && Txy.shape[1]==Ty.shape[1] && Txy.shape[2]==Ty.shape[2]);
+		Blas_Interface::gemm(
+			'N', 'N',
+			Tx.shape[0],
+			Ty.shape[1] * Ty.shape[2],
+			Tx.shape[1],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x1,y0,y1) = alpha * Tx(a,x1) * Ty(y0,y1,a) + beta * Txy(x1,y0,y1)
+	template<typename Tdata>
+	void x1y0y1_ax1_y0y1a(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==2);
+		assert(Ty.shape.size()==3);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[1], Ty.shape[0], Ty.shape[1]});
+		assert(Txy.shape.size()==3 && Txy.shape[0]==Tx.shape[1] && Txy.shape[1]==Ty.shape[0] && Txy.shape[2]==Ty.shape[1]);
+		Blas_Interface::gemm(
+			'T', 'T',
+			Tx.shape[1],
+			Ty.shape[0] * Ty.shape[1],
+			Tx.shape[0],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x1,y1,y2) = alpha * Tx(a,x1) * Ty(a,y1,y2) + beta * Txy(x1,y1,y2)
+	template<typename Tdata>
+	void x1y1y2_ax1_ay1y2(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==2);
+		assert(Ty.shape.size()==3);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[1], Ty.shape[1], Ty.shape[2]});
+		assert(Txy.shape.size()==3 && Txy.shape[0]==Tx.shape[1] && Txy.shape[1]==Ty.shape[1] && Txy.shape[2]==Ty.shape[2]);
+		Blas_Interface::gemm(
+			'T', 'N',
+			Tx.shape[1],
+			Ty.shape[1] * Ty.shape[2],
+			Tx.shape[0],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x0,x1,y0) = alpha * Tx(x0,x1,a) * Ty(y0,a) + beta * Txy(x0,x1,y0)
+	template<typename Tdata>
+	void x0x1y0_x0x1a_y0a(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==2);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Tx.shape[1], Ty.shape[0]});
+		assert(Txy.shape.size()==3 && Txy.shape[0]==Tx.shape[0] && Txy.shape[1]==Tx.shape[1] && Txy.shape[2]==Ty.shape[0]);
+		Blas_Interface::gemm(
+			'N', 'T',
+			Tx.shape[0] * Tx.shape[1],
+			Ty.shape[0],
+			Tx.shape[2],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x0,x1,y1) = alpha * Tx(x0,x1,a) * Ty(a,y1) + beta * Txy(x0,x1,y1)
+	template<typename Tdata>
+	void x0x1y1_x0x1a_ay1(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==2);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Tx.shape[1], Ty.shape[1]});
+		assert(Txy.shape.size()==3 && Txy.shape[0]==Tx.shape[0] && Txy.shape[1]==Tx.shape[1] && Txy.shape[2]==Ty.shape[1]);
+		Blas_Interface::gemm(
+			'N', 'N',
+			Tx.shape[0] * Tx.shape[1],
+			Ty.shape[1],
+			Tx.shape[2],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x1,x2,y0) = alpha * Tx(a,x1,x2) * Ty(y0,a) + beta * Txy(x1,x2,y0)
+	template<typename Tdata>
+	void x1x2y0_ax1x2_y0a(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==2);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[1], Tx.shape[2], Ty.shape[0]});
+		assert(Txy.shape.size()==3 && Txy.shape[0]==Tx.shape[1] && Txy.shape[1]==Tx.shape[2] && Txy.shape[2]==Ty.shape[0]);
+		Blas_Interface::gemm(
+			'T', 'T',
+			Tx.shape[1] * Tx.shape[2],
+			Ty.shape[0],
+			Tx.shape[0],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x1,x2,y1) = alpha * Tx(a,x1,x2) * Ty(a,y1) + beta * Txy(x1,x2,y1)
+	template<typename Tdata>
+	void x1x2y1_ax1x2_ay1(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==2);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[1], Tx.shape[2], Ty.shape[1]});
+		assert(Txy.shape.size()==3 && Txy.shape[0]==Tx.shape[1] && Txy.shape[1]==Tx.shape[2] && Txy.shape[2]==Ty.shape[1]);
+		Blas_Interface::gemm(
+			'T', 'N',
+			Tx.shape[1] * Tx.shape[2],
+			Ty.shape[1],
+			Tx.shape[0],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x0,y0) = alpha * Tx(x0,a,b) * Ty(y0,a,b) + beta * Txy(x0,y0)
+	template<typename Tdata>
+	void x0y0_x0ab_y0ab(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==3);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Ty.shape[0]});
+		assert(Txy.shape.size()==2 && Txy.shape[0]==Tx.shape[0] && Txy.shape[1]==Ty.shape[0]);
+		Blas_Interface::gemm(
+			'N', 'T',
+			Tx.shape[0],
+			Ty.shape[0],
+			Tx.shape[1] * Tx.shape[2],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x0,y2) = alpha * Tx(x0,a,b) * Ty(a,b,y2) + beta * Txy(x0,y2)
+	template<typename Tdata>
+	void x0y2_x0ab_aby2(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==3);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Ty.shape[2]});
+		assert(Txy.shape.size()==2 && Txy.shape[0]==Tx.shape[0] && Txy.shape[1]==Ty.shape[2]);
+		Blas_Interface::gemm(
+			'N', 'N',
+			Tx.shape[0],
+			Ty.shape[2],
+			Tx.shape[1] * Tx.shape[2],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x2,y0) = alpha * Tx(a,b,x2) * Ty(y0,a,b) + beta * Txy(x2,y0)
+	template<typename Tdata>
+	void x2y0_abx2_y0ab(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==3);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[2], Ty.shape[0]});
+		assert(Txy.shape.size()==2 && Txy.shape[0]==Tx.shape[2] && Txy.shape[1]==Ty.shape[0]);
+		Blas_Interface::gemm(
+			'T', 'T',
+			Tx.shape[2],
+			Ty.shape[0],
+			Tx.shape[0] * Tx.shape[1],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x2,y2) = alpha * Tx(a,b,x2) * Ty(a,b,y2) + beta * Txy(x2,y2)
+	template<typename Tdata>
+	void x2y2_abx2_aby2(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==3);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[2], Ty.shape[2]});
+		assert(Txy.shape.size()==2 && Txy.shape[0]==Tx.shape[2] && Txy.shape[1]==Ty.shape[2]);
+		Blas_Interface::gemm(
+			'T', 'N',
+			Tx.shape[2],
+			Ty.shape[2],
+			Tx.shape[0] * Tx.shape[1],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x0,x1,y0,y1) = alpha * Tx(x0,x1,a) * Ty(y0,y1,a) + beta * Txy(x0,x1,y0,y1)
+	template<typename Tdata>
+	void x0x1y0y1_x0x1a_y0y1a(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==3);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Tx.shape[1], Ty.shape[0], Ty.shape[1]});
+		assert(Txy.shape.size()==4 && Txy.shape[0]==Tx.shape[0] && Txy.shape[1]==Tx.shape[1] && Txy.shape[2]==Ty.shape[0] && Txy.shape[3]==Ty.shape[1]);
+		Blas_Interface::gemm(
+			'N', 'T',
+			Tx.shape[0] * Tx.shape[1],
+			Ty.shape[0] * Ty.shape[1],
+			Tx.shape[2],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x0,x1,y1,y2) = alpha * Tx(x0,x1,a) * Ty(a,y1,y2) + beta * Txy(x0,x1,y1,y2)
+	template<typename Tdata>
+	void x0x1y1y2_x0x1a_ay1y2(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==3);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[0], Tx.shape[1], Ty.shape[1], Ty.shape[2]});
+		assert(Txy.shape.size()==4 && Txy.shape[0]==Tx.shape[0] && Txy.shape[1]==Tx.shape[1] && Txy.shape[2]==Ty.shape[1] && Txy.shape[3]==Ty.shape[2]);
+		Blas_Interface::gemm(
+			'N', 'N',
+			Tx.shape[0] * Tx.shape[1],
+			Ty.shape[1] * Ty.shape[2],
+			Tx.shape[2],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x1,x2,y0,y1) = alpha * Tx(a,x1,x2) * Ty(y0,y1,a) + beta * Txy(x1,x2,y0,y1)
+	template<typename Tdata>
+	void x1x2y0y1_ax1x2_y0y1a(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==3);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[1], Tx.shape[2], Ty.shape[0], Ty.shape[1]});
+		assert(Txy.shape.size()==4 && Txy.shape[0]==Tx.shape[1] && Txy.shape[1]==Tx.shape[2] && Txy.shape[2]==Ty.shape[0] && Txy.shape[3]==Ty.shape[1]);
+		Blas_Interface::gemm(
+			'T', 'T',
+			Tx.shape[1] * Tx.shape[2],
+			Ty.shape[0] * Ty.shape[1],
+			Tx.shape[0],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+
+	// Txy(x1,x2,y1,y2) = alpha * Tx(a,x1,x2) * Ty(a,y1,y2) + beta * Txy(x1,x2,y1,y2)
+	template<typename Tdata>
+	void x1x2y1y2_ax1x2_ay1y2(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, const Tdata &alpha, const Tdata &beta)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==3);
+		const bool flag_new = Txy.empty();
+		if(flag_new)
+			Txy = Tensor_Pool<Tdata>::get_current({Tx.shape[1], Tx.shape[2], Ty.shape[1], Ty.shape[2]});
+		assert(Txy.shape.size()==4 && Txy.shape[0]==Tx.shape[1] && Txy.shape[1]==Tx.shape[2] && Txy.shape[2]==Ty.shape[1] && Txy.shape[3]==Ty.shape[2]);
+		Blas_Interface::gemm(
+			'T', 'N',
+			Tx.shape[1] * Tx.shape[2],
+			Ty.shape[1] * Ty.shape[2],
+			Tx.shape[0],
+			alpha, Tx.ptr(), Ty.ptr(),
+			flag_new ? Tdata(0.0) : beta, Txy.ptr());
+	}
+}
+
+}
\ No newline at end of file
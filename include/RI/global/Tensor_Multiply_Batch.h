@@ -0,0 +1,110 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Tensor.h"
+#include "Gemm_Batch.h"
+#include "Tensor_Pool.h"
+
+namespace RI
+{
+
+// Txy += Tx * Ty, pushed into gemm_batch, calculated in gemm_batch.execute().
+// Txy is allocated if empty.
+namespace Tensor_Multiply
+{
+	// Txy(x1,y0,y1) += Tx(a,x1) * Ty(y0,y1,a)
+	template<typename Tdata>
+	void x1y0y1_ax1_y0y1a(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, Gemm_Batch<Tdata> &gemm_batch)
+	{
+		assert(Tx.shape.size()==2);
+		assert(Ty.shape.size()==3);
+		if(Txy.empty())
+			Txy = Tensor_Pool<Tdata>::get_current_zero({Tx.shape[1], Ty.shape[0], Ty.shape[1]});
+		assert(Txy.shape.size()==3 && Txy.shape[0]==Tx.shape[1] && Txy.shape[1]==Ty.shape[0] && Txy.shape[2]==Ty.shape[1]);
+		gemm_batch.push(
+			'T', 'T',
+			Tx.shape[1],
+			Ty.shape[0] * Ty.shape[1],
+			Tx.shape[0],
+			Tdata(1.0), Tx.ptr(), Ty.ptr(),
+			Tdata(1.0), Txy.ptr());
+	}
+
+	// Txy(x0,y0) += Tx(x0,a,b) * Ty(y0,a,b)
+	template<typename Tdata>
+	void x0y0_x0ab_y0ab(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, Gemm_Batch<Tdata> &gemm_batch)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==3);
+		if(Txy.empty())
+			Txy = Tensor_Pool<Tdata>::get_current_zero({Tx.shape[0], Ty.shape[0]});
+		assert(Txy.shape.size()==2 && Txy.shape[0]==Tx.shape[0] && Txy.shape[1]==Ty.shape[0]);
+		gemm_batch.push(
+			'N', 'T',
+			Tx.shape[0],
+			Ty.shape[0],
+			Tx.shape[1] * Tx.shape[2],
+			Tdata(1.0), Tx.ptr(), Ty.ptr(),
+			Tdata(1.0), Txy.ptr());
+	}
+
+	// Txy(x0,y2) += Tx(x0,a,b) * Ty(a,b,y2)
+	template<typename Tdata>
+	void x0y2_x0ab_aby2(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, Gemm_Batch<Tdata> &gemm_batch)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==3);
+		if(Txy.empty())
+			Txy = Tensor_Pool<Tdata>::get_current_zero({Tx.shape[0], Ty.shape[2]});
+		assert(Txy.shape.size()==2 && Txy.shape[0]==Tx.shape[0] && Txy.shape[1]==Ty.shape[2]);
+		gemm_batch.push(
+			'N', 'N',
+			Tx.shape[0],
+			Ty.shape[2],
+			Tx.shape[1] * Tx.shape[2],
+			Tdata(1.0), Tx.ptr(), Ty.ptr(),
+			Tdata(1.0), Txy.ptr());
+	}
+
+	// Txy(x2,y0) += Tx(a,b,x2) * Ty(y0,a,b)
+	template<typename Tdata>
+	void x2y0_abx2_y0ab(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, Gemm_Batch<Tdata> &gemm_batch)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==3);
+		if(Txy.empty())
+			Txy = Tensor_Pool<Tdata>::get_current_zero({Tx.shape[2], Ty.shape[0]});
+		assert(Txy.shape.size()==2 && Txy.shape[0]==Tx.shape[2] && Txy.shape[1]==Ty.shape[0]);
+		gemm_batch.push(
+			'T', 'T',
+			Tx.shape[2],
+			Ty.shape[0],
+			Tx.shape[0] * Tx.shape[1],
+			Tdata(1.0), Tx.ptr(), Ty.ptr(),
+			Tdata(1.0), Txy.ptr());
+	}
+
+	// Txy(x2,y2) += Tx(a,b,x2) * Ty(a,b,y2)
+	template<typename Tdata>
+	void x2y2_abx2_aby2(const Tensor<Tdata> &Tx, const Tensor<Tdata> &Ty, Tensor<Tdata> &Txy, Gemm_Batch<Tdata> &gemm_batch)
+	{
+		assert(Tx.shape.size()==3);
+		assert(Ty.shape.size()==3);
+		if(Txy.empty())
+			Txy = Tensor_Pool<Tdata>::get_current_zero({Tx.shape[2], Ty.shape[2]});
+		assert(Txy.shape.size()==2 && Txy.shape[0]==Tx.shape[2] && Txy.shape[1]==Ty.shape[2]);
+		gemm_batch.push(
+			'T', 'N',
+			Tx.shape[2],
+			Ty.shape[2],
+			Tx.shape[0] * Tx.shape[1],
+			Tdata(1.0), Tx.ptr(), Ty.ptr(),
+			Tdata(1.0), Txy.ptr());
+	}
+}
+
+}
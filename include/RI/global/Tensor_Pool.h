@@ -0,0 +1,71 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Tensor.h"
+
+#include <map>
+#include <vector>
+#include <valarray>
+#include <memory>
+
+// Buffers of tensors with no more than __RI_TENSOR_POOL_SMALL_MAX elements are indexed by size directly,
+// so that the tiny blocks of light atoms skip the search in std::map.
+#ifndef __RI_TENSOR_POOL_SMALL_MAX
+#define __RI_TENSOR_POOL_SMALL_MAX 256
+#endif
+
+namespace RI
+{
+
+// Recycle the memory of temporary tensors, to avoid malloc/free in hot loops.
+// A buffer is reused once all the Tensor got from it are destroyed.
+// The data of reused buffer is not initialized,
+// so get() and get_current() are only for results overwritten entirely, e.g. gemm with beta=0 as in Tensor_Multiply.
+// Use get_zero() for results accumulated into.
+// A Tensor got from the pool may be kept as a result, then its buffer is not reused until the result is destroyed.
+// Each thread should have its own Tensor_Pool.
+template<typename T>
+class Tensor_Pool
+{
+public:
+	Tensor<T> get(const Shape_Vector &shape);
+	Tensor<T> get_zero(const Shape_Vector &shape);
+
+	// release all buffers. Tensor in use are not affected. Counters are kept.
+	void clear();
+
+	// get() from the current pool of this thread if exists, else allocate a new Tensor.
+	static Tensor<T> get_current(const Shape_Vector &shape);
+	static Tensor<T> get_current_zero(const Shape_Vector &shape);
+
+	// set this pool to be the current pool of this thread during the lifetime of Scope
+	class Scope
+	{
+	public:
+		explicit Scope(Tensor_Pool<T> &pool);
+		~Scope();
+		Scope(const Scope&)=delete;
+		Scope &operator=(const Scope&)=delete;
+	private:
+		Tensor_Pool<T> *pool_prev;
+	};
+
+	std::size_t n_get = 0;			// number of get(), i.e. allocations without pool
+	std::size_t n_new = 0;			// number of allocations with pool
+
+	std::size_t n_buffers_max = 16;		// max number of buffers kept for each size. If all are in use, the oldest is given up to its users.
+
+public:		// private:
+	std::map<std::size_t, std::vector<std::shared_ptr<std::valarray<T>>>> buffers;		// buffers[size], size > __RI_TENSOR_POOL_SMALL_MAX
+	std::vector<std::vector<std::shared_ptr<std::valarray<T>>>> buffers_small;		// buffers_small[size], size <= __RI_TENSOR_POOL_SMALL_MAX
+	std::vector<std::shared_ptr<std::valarray<T>>> &get_buffers(const std::size_t size);
+	static Tensor_Pool<T>* &current();
+};
+
+}
+
+#include "Tensor_Pool.hpp"
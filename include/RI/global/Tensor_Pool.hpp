@@ -0,0 +1,95 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Tensor_Pool.h"
+
+#include <numeric>
+#include <functional>
+
+namespace RI
+{
+
+template<typename T>
+Tensor<T> Tensor_Pool<T>::get(const Shape_Vector &shape)
+{
+	++this->n_get;
+	const std::size_t size = std::accumulate(shape.begin(), shape.end(), static_cast<std::size_t>(1), std::multiplies<std::size_t>());
+	if(shape.empty() || !size)
+		return Tensor<T>(shape);
+	std::vector<std::shared_ptr<std::valarray<T>>> &buffers_size = this->get_buffers(size);
+	for(const std::shared_ptr<std::valarray<T>> &buffer : buffers_size)
+		if(buffer.use_count()==1)
+			return Tensor<T>(shape, buffer);
+	// all buffers are in use, the oldest of which is most likely moved out as a result. Give it up.
+	if(!buffers_size.empty() && buffers_size.size()>=this->n_buffers_max)
+		buffers_size.erase(buffers_size.begin());
+	++this->n_new;
+	buffers_size.push_back(std::make_shared<std::valarray<T>>(size));
+	return Tensor<T>(shape, buffers_size.back());
+}
+
+template<typename T>
+std::vector<std::shared_ptr<std::valarray<T>>> &Tensor_Pool<T>::get_buffers(const std::size_t size)
+{
+	if(size > __RI_TENSOR_POOL_SMALL_MAX)
+		return this->buffers[size];
+	if(size >= this->buffers_small.size())
+		this->buffers_small.resize(size+1);
+	return this->buffers_small[size];
+}
+
+template<typename T>
+Tensor<T> Tensor_Pool<T>::get_zero(const Shape_Vector &shape)
+{
+	Tensor<T> t = this->get(shape);
+	if(t.data)
+		*t.data = T(0);
+	return t;
+}
+
+template<typename T>
+void Tensor_Pool<T>::clear()
+{
+	this->buffers.clear();
+	this->buffers_small.clear();
+}
+
+template<typename T>
+Tensor_Pool<T>* &Tensor_Pool<T>::current()
+{
+	static thread_local Tensor_Pool<T>* pool = nullptr;
+	return pool;
+}
+
+template<typename T>
+Tensor<T> Tensor_Pool<T>::get_current(const Shape_Vector &shape)
+{
+	Tensor_Pool<T>* const pool = current();
+	return pool ? pool->get(shape) : Tensor<T>(shape);
+}
+
+template<typename T>
+Tensor<T> Tensor_Pool<T>::get_current_zero(const Shape_Vector &shape)
+{
+	Tensor_Pool<T>* const pool = current();
+	return pool ? pool->get_zero(shape) : Tensor<T>(shape);
+}
+
+template<typename T>
+Tensor_Pool<T>::Scope::Scope(Tensor_Pool<T> &pool)
+	:pool_prev(Tensor_Pool<T>::current())
+{
+	Tensor_Pool<T>::current() = &pool;
+}
+
+template<typename T>
+Tensor_Pool<T>::Scope::~Scope()
+{
+	Tensor_Pool<T>::current() = this->pool_prev;
+}
+
+}
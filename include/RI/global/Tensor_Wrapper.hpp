@@ -31,10 +31,7 @@ namespace RI
 		}
 		else if(p==std::numeric_limits<double>::max())
 		{
-			T_res s = 0;
-			for(std::size_t i=0; i<shape_all; ++i)
-				s = std::max(std::real(s), std::abs(this->ptr_[i]));
-			return s;
+			return Global_Func::abs_max(this->ptr_, shape_all);
 		}
 		else
 		{
@@ -0,0 +1,410 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Tensor.h"
+#include "Tensors_Map2_Frozen.h"
+#include "Global_Func-1.h"
+#include "Checkpoint.h"
+#include "MPI_Wrapper-func.h"
+#include "MPI_Wrapper-class.h"
+
+#include <map>
+#include <vector>
+#include <list>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <mpi.h>
+#include <omp.h>
+
+#define MPI_CHECK(x) if((x)!=MPI_SUCCESS)	throw std::runtime_error(std::string(__FILE__)+" line "+std::to_string(__LINE__));
+
+namespace RI
+{
+
+// Out-of-core form of std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>>.
+// Tensors of each key0 are written contiguously as one block of file_name,
+// read back by blocks when used, and the least recently used blocks are released if memory_max bytes is exceeded.
+// Blocks are read by threads concurrently, each block by one thread while the others needing it wait.
+// file_name is removed in destructor.
+// Or instead of file, tensors of all processes on the same node are kept once in MPI-3 shared memory of the node,
+// and read back by blocks in the same way.
+// The blocks read are copies in each process, bounded by memory_max per process, for Tensor cannot alias the window.
+template<typename Tkey0, typename Tkey1, typename Tdata>
+class Tensors_Map2_Disk
+{
+public:
+	using Block = std::vector<Tensor<Tdata>>;		// tensors of keys0[i0], in order of keys1[index1[i0]] ~ keys1[index1[i0+1]-1]
+
+	Tensors_Map2_Disk(
+		const std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>> &Ds,
+		const std::string &file_name_in,
+		const double memory_max_in)
+			:file_name(file_name_in), memory_max(memory_max_in)
+	{
+		std::vector<Tkey0> keys0;
+		for(const auto &Ds_A : Ds)
+			if(!Ds_A.second.empty())
+				keys0.push_back(Ds_A.first);
+		this->write(keys0, [&Ds](const Tkey0 &key0) -> const std::map<Tkey1, Tensor<Tdata>>&
+		{
+			return Ds.at(key0);
+		});
+	}
+
+	// Ds_new[key0][key1] = func(Ds[key0][key1]), read from Ds by blocks and written to file_name_in.
+	template<typename Tfunc>
+	Tensors_Map2_Disk(
+		const Tensors_Map2_Disk &Ds,
+		const Tfunc &func,
+		const std::string &file_name_in,
+		const double memory_max_in)
+			:file_name(file_name_in), memory_max(memory_max_in)
+	{
+		this->write(Ds.shapes.keys0, [&Ds, &func](const Tkey0 &key0) -> std::map<Tkey1, Tensor<Tdata>>
+		{
+			const std::size_t i0 = Ds.get_index0(key0);
+			const std::shared_ptr<const Block> block = Ds.get_block(i0);
+			std::map<Tkey1, Tensor<Tdata>> Ds_new;
+			for(std::size_t i1=Ds.shapes.index1[i0]; i1<Ds.shapes.index1[i0+1]; ++i1)
+				Ds_new[Ds.shapes.keys1[i1]] = func((*block)[i1-Ds.shapes.index1[i0]]);
+			return Ds_new;
+		});
+	}
+
+	// Tensors of Ds in all processes of mpi_comm on the same node are kept once in shared memory of the node,
+	// each tensor written by the process of lowest rank in the node having it.
+	// Collective in mpi_comm, as the destructor in mpi_comm_node.
+	Tensors_Map2_Disk(
+		const std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>> &Ds,
+		const MPI_Comm &mpi_comm,
+		const double memory_max_in)
+			:memory_max(memory_max_in)
+	{
+		MPI_CHECK( MPI_Comm_split_type(mpi_comm, MPI_COMM_TYPE_SHARED, MPI_Wrapper::mpi_get_rank(mpi_comm), MPI_INFO_NULL, &this->mpi_comm_node()) );
+		this->mpi_comm_node.flag_allocate = true;
+		this->write_shared(Ds);
+	}
+
+	// Ds_new[key0][key1] = func(Ds[key0][key1]), in shared memory of the same node as Ds.
+	// Ds_new is calculated all together before written, for tensors of other processes are written once.
+	template<typename Tfunc>
+	Tensors_Map2_Disk(
+		const Tensors_Map2_Disk &Ds,
+		const Tfunc &func,
+		const double memory_max_in)
+			:memory_max(memory_max_in)
+	{
+		MPI_CHECK( MPI_Comm_dup(Ds.mpi_comm_node(), &this->mpi_comm_node()) );
+		this->mpi_comm_node.flag_allocate = true;
+		std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>> Ds_new;
+		for(std::size_t i0=0; i0<Ds.shapes.keys0.size(); ++i0)
+		{
+			const std::shared_ptr<const Block> block = Ds.get_block(i0);
+			std::map<Tkey1, Tensor<Tdata>> &Ds_new_A = Ds_new[Ds.shapes.keys0[i0]];
+			for(std::size_t i1=Ds.shapes.index1[i0]; i1<Ds.shapes.index1[i0+1]; ++i1)
+				Ds_new_A[Ds.shapes.keys1[i1]] = func((*block)[i1-Ds.shapes.index1[i0]]);
+		}
+		this->write_shared(Ds_new);
+	}
+
+	Tensors_Map2_Disk(const Tensors_Map2_Disk&) = delete;
+	Tensors_Map2_Disk &operator=(const Tensors_Map2_Disk&) = delete;
+
+	~Tensors_Map2_Disk()
+	{
+		omp_destroy_lock(&this->lock);
+		for(omp_lock_t &lock_block : this->locks_block)
+			omp_destroy_lock(&lock_block);
+		if(this->flag_shared())
+			MPI_Win_free(&this->win);
+		else
+			std::remove(this->file_name.c_str());
+	}
+
+	// in shared memory of the node instead of file
+	bool flag_shared() const { return this->win!=MPI_WIN_NULL; }
+
+	// return empty tensor if not found, same as Global_Func::find().
+	// The block of the tensor is pushed into holder, and kept in memory until holder released.
+	const Tensor<Tdata> &find(
+		const Tkey0 &key0, const Tkey1 &key1,
+		std::vector<std::shared_ptr<const Block>> &holder) const
+	{
+		const std::pair<std::size_t,std::size_t> index = this->shapes.find_index(key0, key1);
+		if(index.first==Tensors_Map2_Frozen<Tkey0,Tkey1,Tdata>::npos)
+			return Global_Func::ZERO<Tensor<Tdata>>;
+		std::shared_ptr<const Block> block = this->get_block(index.first);
+		if(holder.empty() || holder.back()!=block)
+			holder.push_back(block);
+		return (*holder.back())[index.second - this->shapes.index1[index.first]];
+	}
+
+	// tensors with shape but without data, for keys and sizes
+	std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>> get_shapes() const
+	{
+		std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>> Ds_shape;
+		for(std::size_t i0=0; i0<this->shapes.keys0.size(); ++i0)
+		{
+			std::map<Tkey1, Tensor<Tdata>> &Ds_shape_A = Ds_shape[this->shapes.keys0[i0]];
+			for(std::size_t i1=this->shapes.index1[i0]; i1<this->shapes.index1[i0+1]; ++i1)
+				Ds_shape_A[this->shapes.keys1[i1]] = this->shapes.Ds[i1];
+		}
+		return Ds_shape;
+	}
+
+private:
+	// keys0[i0] = key0
+	std::size_t get_index0(const Tkey0 &key0) const
+	{
+		return std::lower_bound(this->shapes.keys0.begin(), this->shapes.keys0.end(), key0) - this->shapes.keys0.begin();
+	}
+
+	// get_Ds_A(key0) returns non-empty tensors of key0 with data, for sorted keys0.
+	template<typename Tget_Ds_A>
+	void write(
+		const std::vector<Tkey0> &keys0,
+		const Tget_Ds_A &get_Ds_A)
+	{
+		std::ofstream file(this->file_name, std::ios::binary | std::ios::trunc);
+		if(!file.is_open())
+			throw std::runtime_error("cannot open "+this->file_name+". "+std::string(__FILE__)+" line "+std::to_string(__LINE__));
+
+		std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>> Ds_shape;
+		this->offsets.push_back(0);
+		for(const Tkey0 &key0 : keys0)
+		{
+			std::size_t size = 0;
+			for(const auto &D_A : get_Ds_A(key0))
+			{
+				Tensor<Tdata> &D_shape = Ds_shape[key0][D_A.first];
+				D_shape.shape = D_A.second.shape;
+				const std::size_t size_D = D_A.second.get_shape_all();
+				if(size_D)
+					file.write(reinterpret_cast<const char*>(D_A.second.ptr()), size_D*sizeof(Tdata));
+				size += size_D;
+			}
+			this->offsets.push_back(this->offsets.back() + size*sizeof(Tdata));
+		}
+		file.close();
+		if(!file.good())
+			throw std::runtime_error("cannot write "+this->file_name+". "+std::string(__FILE__)+" line "+std::to_string(__LINE__));
+
+		this->shapes = Tensors_Map2_Frozen<Tkey0,Tkey1,Tdata>(Ds_shape);
+		this->init_blocks();
+	}
+
+	// as write(), tensors of all processes in mpi_comm_node placed one after another by rank, each key once.
+	void write_shared(const std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>> &Ds)
+	{
+		const int rank_node = MPI_Wrapper::mpi_get_rank(this->mpi_comm_node());
+		const int size_node = MPI_Wrapper::mpi_get_size(this->mpi_comm_node());
+
+		std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>> Ds_shape;
+		std::map<Tkey0, std::map<Tkey1, std::uint64_t>> sizes_local;
+		for(const auto &Ds_A : Ds)
+			for(const auto &D_A : Ds_A.second)
+			{
+				Ds_shape[Ds_A.first][D_A.first].shape = D_A.second.shape;
+				if(D_A.second.get_shape_all())
+					sizes_local[Ds_A.first][D_A.first] = D_A.second.get_shape_all();
+			}
+		this->shapes = Tensors_Map2_Frozen<Tkey0,Tkey1,Tdata>(Ds_shape);
+
+		// keys and sizes of all processes in node
+		std::ostringstream os;
+		Checkpoint::write(os, sizes_local);
+		const std::string keys_send = os.str();
+		int size_send = static_cast<int>(keys_send.size());
+		std::vector<int> sizes_recv(size_node), displs_recv(size_node+1, 0);
+		MPI_CHECK( MPI_Allgather(&size_send, 1, MPI_INT, sizes_recv.data(), 1, MPI_INT, this->mpi_comm_node()) );
+		for(int rank=0; rank<size_node; ++rank)
+			displs_recv[rank+1] = displs_recv[rank] + sizes_recv[rank];
+		std::vector<char> keys_recv(displs_recv[size_node]);
+		MPI_CHECK( MPI_Allgatherv(keys_send.data(), size_send, MPI_BYTE, keys_recv.data(), sizes_recv.data(), displs_recv.data(), MPI_BYTE, this->mpi_comm_node()) );
+
+		// offsets_node[key0][key1] = {offset in Tdata, rank writing it}, the same in all processes of node
+		std::map<Tkey0, std::map<Tkey1, std::pair<std::size_t,int>>> offsets_node;
+		std::size_t size_all = 0;
+		for(int rank=0; rank<size_node; ++rank)
+		{
+			std::istringstream is(std::string(keys_recv.data()+displs_recv[rank], sizes_recv[rank]));
+			std::map<Tkey0, std::map<Tkey1, std::uint64_t>> sizes_rank;
+			Checkpoint::read(is, sizes_rank);
+			for(const auto &sizes_A : sizes_rank)
+				for(const auto &size_A : sizes_A.second)
+				{
+					const auto ptr = offsets_node[sizes_A.first].insert({size_A.first, {size_all, rank}});
+					if(ptr.second)
+						size_all += size_A.second;
+				}
+		}
+
+		MPI_CHECK( MPI_Win_allocate_shared(
+			static_cast<MPI_Aint>(rank_node==0 ? size_all*sizeof(Tdata) : 0), sizeof(Tdata),
+			MPI_INFO_NULL, this->mpi_comm_node(), &this->memory_shared, &this->win) );
+		MPI_Aint size_win;
+		int disp_unit;
+		MPI_CHECK( MPI_Win_shared_query(this->win, 0, &size_win, &disp_unit, &this->memory_shared) );
+
+		MPI_CHECK( MPI_Win_fence(0, this->win) );
+		this->offsets_shared.resize(this->shapes.Ds.size());
+		for(std::size_t i0=0; i0<this->shapes.keys0.size(); ++i0)
+		{
+			const std::map<Tkey1, Tensor<Tdata>> &Ds_A = Ds.at(this->shapes.keys0[i0]);
+			const std::map<Tkey1, std::pair<std::size_t,int>> &offsets_A = offsets_node[this->shapes.keys0[i0]];
+			for(std::size_t i1=this->shapes.index1[i0]; i1<this->shapes.index1[i0+1]; ++i1)
+			{
+				const std::size_t size_D = this->shapes.Ds[i1].get_shape_all();
+				if(!size_D)	continue;
+				const std::pair<std::size_t,int> &offset = offsets_A.at(this->shapes.keys1[i1]);
+				this->offsets_shared[i1] = offset.first;
+				if(offset.second==rank_node)
+					std::memcpy(static_cast<Tdata*>(this->memory_shared)+offset.first, Ds_A.at(this->shapes.keys1[i1]).ptr(), size_D*sizeof(Tdata));
+			}
+		}
+		MPI_CHECK( MPI_Win_fence(0, this->win) );
+
+		this->init_blocks();
+	}
+
+	void init_blocks()
+	{
+		this->blocks.resize(this->shapes.keys0.size());
+		this->lru_pos.resize(this->shapes.keys0.size());
+		omp_init_lock(&this->lock);
+		this->locks_block.resize(this->shapes.keys0.size());
+		for(omp_lock_t &lock_block : this->locks_block)
+			omp_init_lock(&lock_block);
+	}
+
+	// bytes of block of keys0[i0]
+	std::size_t get_memory_block(const std::size_t i0) const
+	{
+		std::size_t size = 0;
+		for(std::size_t i1=this->shapes.index1[i0]; i1<this->shapes.index1[i0+1]; ++i1)
+			size += this->shapes.Ds[i1].get_shape_all();
+		return size*sizeof(Tdata);
+	}
+
+	// blocks[i0] if in memory, and mark it most recently used. Under lock.
+	std::shared_ptr<const Block> find_block(const std::size_t i0) const
+	{
+		const std::shared_ptr<const Block> &block = this->blocks[i0];
+		if(block)
+			this->lru.splice(this->lru.begin(), this->lru, this->lru_pos[i0]);
+		return block;
+	}
+
+	// block of keys0[i0], read from file if not in memory.
+	// lock only guards blocks and lru, reading is outside of it.
+	// locks_block[i0] is held by the thread reading block i0, so that the others needing it wait instead of reading again.
+	// Blocks being read are not counted in memory, which may exceed memory_max by one block of each thread.
+	std::shared_ptr<const Block> get_block(const std::size_t i0) const
+	{
+		omp_set_lock(&this->lock);
+		std::shared_ptr<const Block> block = this->find_block(i0);
+		omp_unset_lock(&this->lock);
+		if(block)
+			return block;
+
+		omp_set_lock(&this->locks_block[i0]);
+		omp_set_lock(&this->lock);
+		block = this->find_block(i0);				// read by other thread during waiting
+		omp_unset_lock(&this->lock);
+		if(!block)
+		{
+			try
+			{
+				block = this->read_block(i0);
+			}
+			catch(...)
+			{
+				omp_unset_lock(&this->locks_block[i0]);
+				throw;
+			}
+
+			omp_set_lock(&this->lock);
+			++this->n_read;
+			this->blocks[i0] = block;
+			this->lru.push_front(i0);
+			this->lru_pos[i0] = this->lru.begin();
+			this->memory += this->get_memory_block(i0);
+			// blocks released here are still alive in holders of find()
+			while(this->memory > this->memory_max && this->lru.size()>1)
+			{
+				const std::size_t i0_release = this->lru.back();
+				this->lru.pop_back();
+				this->blocks[i0_release].reset();
+				this->memory -= this->get_memory_block(i0_release);
+			}
+			omp_unset_lock(&this->lock);
+		}
+		omp_unset_lock(&this->locks_block[i0]);
+		return block;
+	}
+
+	// thread-safe, each call with its own stream of file
+	std::shared_ptr<const Block> read_block(const std::size_t i0) const
+	{
+		std::shared_ptr<Block> block = std::make_shared<Block>();
+		block->reserve(this->shapes.index1[i0+1] - this->shapes.index1[i0]);
+		std::ifstream file;
+		if(!this->flag_shared())
+		{
+			file.open(this->file_name, std::ios::binary);
+			file.seekg(this->offsets[i0]);
+		}
+		for(std::size_t i1=this->shapes.index1[i0]; i1<this->shapes.index1[i0+1]; ++i1)
+		{
+			Tensor<Tdata> D;
+			D.shape = this->shapes.Ds[i1].shape;
+			const std::size_t size_D = D.get_shape_all();
+			if(size_D)
+			{
+				D.data = std::make_shared<std::valarray<Tdata>>(size_D);
+				if(this->flag_shared())
+					std::memcpy(D.ptr(), static_cast<const Tdata*>(this->memory_shared)+this->offsets_shared[i1], size_D*sizeof(Tdata));
+				else
+					file.read(reinterpret_cast<char*>(D.ptr()), size_D*sizeof(Tdata));
+			}
+			block->push_back(std::move(D));
+		}
+		if(!this->flag_shared() && !file.good())
+			throw std::runtime_error("cannot read "+this->file_name+". "+std::string(__FILE__)+" line "+std::to_string(__LINE__));
+		return block;
+	}
+
+public:		// private:
+	std::string file_name;
+	double memory_max;									// bytes of blocks kept in memory, at least one block
+	Tensors_Map2_Frozen<Tkey0,Tkey1,Tdata> shapes;		// tensors with shape but without data
+	std::vector<std::size_t> offsets;					// block of keys0[i0] in [offsets[i0], offsets[i0+1]) bytes of file
+
+	MPI_Wrapper::mpi_comm mpi_comm_node;				// processes sharing memory_shared, if flag_shared()
+	MPI_Win win = MPI_WIN_NULL;
+	void* memory_shared = nullptr;						// window of mpi_comm_node, allocated by its rank 0
+	std::vector<std::size_t> offsets_shared;			// tensor shapes.Ds[i1] at offsets_shared[i1] Tdata of memory_shared
+
+	mutable std::vector<std::shared_ptr<const Block>> blocks;		// blocks[i0], nullptr if not in memory
+	mutable std::list<std::size_t> lru;								// i0 in memory, most recently used first
+	mutable std::vector<std::list<std::size_t>::iterator> lru_pos;	// lru_pos[i0] in lru
+	mutable double memory = 0;
+	mutable std::size_t n_read = 0;					// times of blocks read from file or memory_shared
+	mutable omp_lock_t lock;										// for blocks, lru, memory and n_read
+	mutable std::vector<omp_lock_t> locks_block;					// locks_block[i0] held while reading block i0
+};
+
+}
+
+#undef MPI_CHECK
\ No newline at end of file
@@ -0,0 +1,91 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Tensor.h"
+#include "Global_Func-1.h"
+
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <limits>
+
+namespace RI
+{
+
+// Read-only compact form of std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>>.
+// Keys are stored in sorted arrays like CSR, tensors in the same order.
+// Tensors share memory with the input map.
+template<typename Tkey0, typename Tkey1, typename Tdata>
+class Tensors_Map2_Frozen
+{
+public:
+	Tensors_Map2_Frozen()=default;
+	explicit Tensors_Map2_Frozen(const std::map<Tkey0, std::map<Tkey1, Tensor<Tdata>>> &Ds)
+	{
+		std::size_t size = 0;
+		for(const auto &Ds_A : Ds)
+			size += Ds_A.second.size();
+		this->keys0.reserve(Ds.size());
+		this->index1.reserve(Ds.size()+1);
+		this->keys1.reserve(size);
+		this->Ds.reserve(size);
+
+		this->index1.push_back(0);
+		for(const auto &Ds_A : Ds)
+		{
+			if(Ds_A.second.empty())	continue;
+			this->keys0.push_back(Ds_A.first);
+			for(const auto &D_A : Ds_A.second)
+			{
+				this->keys1.push_back(D_A.first);
+				this->Ds.push_back(D_A.second);
+			}
+			this->index1.push_back(this->keys1.size());
+		}
+	}
+
+	// return empty tensor if not found, same as Global_Func::find()
+	inline const Tensor<Tdata> &find(const Tkey0 &key0, const Tkey1 &key1) const
+	{
+		const std::size_t i1 = this->find_index(key0, key1).second;
+		if(i1==npos)
+			return Global_Func::ZERO<Tensor<Tdata>>;
+		return this->Ds[i1];
+	}
+
+	// return {i0,i1} for keys0[i0] and keys1[i1], {npos,npos} if not found
+	inline std::pair<std::size_t,std::size_t> find_index(const Tkey0 &key0, const Tkey1 &key1) const
+	{
+		const auto ptr0 = std::lower_bound(this->keys0.begin(), this->keys0.end(), key0);
+		if(ptr0==this->keys0.end() || key0<*ptr0)
+			return {npos, npos};
+		const std::size_t i0 = ptr0 - this->keys0.begin();
+		const auto begin1 = this->keys1.begin() + this->index1[i0];
+		const auto end1   = this->keys1.begin() + this->index1[i0+1];
+		const auto ptr1 = std::lower_bound(begin1, end1, key1);
+		if(ptr1==end1 || key1<*ptr1)
+			return {npos, npos};
+		return {i0, static_cast<std::size_t>(ptr1 - this->keys1.begin())};
+	}
+
+	static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+	std::size_t size() const { return this->Ds.size(); }
+
+public:		// private:
+	std::vector<Tkey0> keys0;				// sorted
+	std::vector<std::size_t> index1;		// keys1[index1[i0]] ~ keys1[index1[i0+1]-1] belong to keys0[i0]
+	std::vector<Tkey1> keys1;				// sorted for each key0
+	std::vector<Tensor<Tdata>> Ds;			// Ds[i1] for keys1[i1]
+};
+
+// definition for odr-use in C++14, e.g. bound to reference in {npos, npos}
+template<typename Tkey0, typename Tkey1, typename Tdata>
+constexpr std::size_t Tensors_Map2_Frozen<Tkey0,Tkey1,Tdata>::npos;
+
+}
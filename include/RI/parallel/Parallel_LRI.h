@@ -7,6 +7,7 @@
 
 #include "../global/Tensor.h"
 #include "../ri/Label.h"
+#include "../comm/mix/Communicate_Tensors_Map_Plan.h"
 
 #include <mpi.h>
 #include <vector>
@@ -14,6 +15,8 @@
 #include <map>
 #include <unordered_map>
 #include <set>
+#include <string>
+#include <stdexcept>
 
 namespace RI
 {
@@ -53,14 +56,39 @@ class Parallel_LRI
 		const std::vector<Label::ab> &label,
 		const std::map<TA,std::map<TAC,Tensor<Tdata>>> &Ds) const =0;
 
+	// comm_tensors_map2() through the send/recv lists of plan,
+	// which are set again only if the keys of Ds or list_A (version_list_A) changed since last time.
+	// Without plan by default.
+	virtual std::map<TA,std::map<TAC,Tensor<Tdata>>> comm_tensors_map2(
+		const std::vector<Label::ab> &label,
+		const std::map<TA,std::map<TAC,Tensor<Tdata>>> &Ds,
+		Communicate_Tensors_Map_Plan<TA,TC,Tdata> &) const
+	{
+		return this->comm_tensors_map2(label, Ds);
+	}
+
 	virtual const std::vector<TA >& get_list_Aa01() const =0;
 	virtual const std::vector<TAC>& get_list_Aa2 (const TA &Aa01) const =0;
 	virtual const std::vector<TAC>& get_list_Ab01(const TA &Aa01, const TAC &Aa2) const =0;
 	virtual const std::vector<TAC>& get_list_Ab2 (const TA &Aa01, const TAC &Aa2, const TAC &Ab01) const =0;
 
+	// reset list_A from atoms_cost[A], the measured loop3 cost of atom A in this process.
+	// return whether list_A changed in any process.
+	virtual bool rebalance(const std::map<TA,double> &){ return false; }
+
+	// Ds distributed by comm_tensors_map2() before rebalance(), moved to the processes required by list_A now.
+	// Only tensors not in a process yet are sent to it, each from one process.
+	virtual std::map<TA,std::map<TAC,Tensor<Tdata>>> redistribute_tensors_map2(
+		const std::vector<Label::ab> &,
+		const std::map<TA,std::map<TAC,Tensor<Tdata>>> &) const
+	{
+		throw std::invalid_argument("redistribute_tensors_map2() not implemented. "+std::string(__FILE__)+" line "+std::to_string(__LINE__));
+	}
+
 	virtual ~Parallel_LRI()=default;
 
 	std::unordered_map<Label::Aab_Aab, List_A<TA,TAC>> list_A;
+	std::size_t version_list_A = 0;			// increased whenever list_A is reset
 };
 
 }
\ No newline at end of file
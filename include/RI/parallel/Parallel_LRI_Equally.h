@@ -31,6 +31,13 @@ class Parallel_LRI_Equally: public Parallel_LRI<TA,Tcell,Ndim,Tdata>
 	std::map<TA,std::map<TAC,Tensor<Tdata>>> comm_tensors_map2(
 		const std::vector<Label::ab> &label,
 		const std::map<TA,std::map<TAC,Tensor<Tdata>>> &Ds) const override;
+	std::map<TA,std::map<TAC,Tensor<Tdata>>> comm_tensors_map2(
+		const std::vector<Label::ab> &label,
+		const std::map<TA,std::map<TAC,Tensor<Tdata>>> &Ds,
+		Communicate_Tensors_Map_Plan<TA,TC,Tdata> &plan) const override;
+	std::map<TA,std::map<TAC,Tensor<Tdata>>> redistribute_tensors_map2(
+		const std::vector<Label::ab> &label_list,
+		const std::map<TA,std::map<TAC,Tensor<Tdata>>> &Ds) const override;
 
 	const std::vector<TA >& get_list_Aa01() const override { return this->list_Aa01; }
 	const std::vector<TAC>& get_list_Aa2 (const TA &Aa01) const override { return this->list_Aa2;  }
@@ -52,6 +59,18 @@ class Parallel_LRI_Equally: public Parallel_LRI<TA,Tcell,Ndim,Tdata>
 	void set_parallel_loop3(
 		const std::vector<TA> &atoms_vec,
 		const std::set<Label::Aab_Aab> &labels);
+	// list_A[label] of loop3, from atoms_split_list1 of {atoms, {atom,cell}} and atoms_split_list2 of {{atom,cell}, {atom,cell}} of this process
+	void set_list_A(
+		const std::vector<TA> &atoms_vec,
+		const std::vector<TAC> &atoms_period_vec,
+		const std::pair<std::vector<TA>, std::vector<std::vector<TAC>>> &atoms_split_list1,
+		const std::vector<std::vector<TAC>> &atoms_split_list2,
+		const std::set<Label::Aab_Aab> &labels);
+	// {atoms, {atom,cell}} required for label_list in loop3 and loop4
+	std::tuple<
+		std::vector<std::tuple< std::set<TA>, std::set<TAC> >>,
+		std::vector<std::tuple< std::set<TAC>, std::set<TAC> >>>
+	get_s_list(const std::vector<Label::ab> &label_list) const;
 };
 
 }
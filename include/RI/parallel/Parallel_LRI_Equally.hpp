@@ -17,7 +17,7 @@ template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
 void Parallel_LRI_Equally<TA,Tcell,Ndim,Tdata>::set_parallel(
 	const MPI_Comm &mpi_comm_in,
 	const std::map<TA,Tatom_pos> &atoms_pos,
-	const std::array<Tatom_pos,Ndim> &latvec,
+	const std::array<Tatom_pos,Ndim> &,
 	const std::array<Tcell,Ndim> &period_in,
 	const std::set<Label::Aab_Aab> &labels)
 {
@@ -27,6 +27,7 @@ void Parallel_LRI_Equally<TA,Tcell,Ndim,Tdata>::set_parallel(
 
 	this->set_parallel_loop4(atoms_vec);
 	this->set_parallel_loop3(atoms_vec, labels);
+	++this->version_list_A;
 }
 
 template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
@@ -59,6 +60,17 @@ void Parallel_LRI_Equally<TA,Tcell,Ndim,Tdata>::set_parallel_loop3(
 	const std::vector<std::vector<std::pair<TA,TC>>>
 		atoms_split_list2 = Distribute_Equally::distribute_periods(
 			this->mpi_comm, atoms_vec, this->period, num_index, false);
+	this->set_list_A(atoms_vec, atoms_period_vec, atoms_split_list1, atoms_split_list2, labels);
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void Parallel_LRI_Equally<TA,Tcell,Ndim,Tdata>::set_list_A(
+	const std::vector<TA> &atoms_vec,
+	const std::vector<TAC> &atoms_period_vec,
+	const std::pair<std::vector<TA>, std::vector<std::vector<TAC>>> &atoms_split_list1,
+	const std::vector<std::vector<TAC>> &atoms_split_list2,
+	const std::set<Label::Aab_Aab> &labels)
+{
 	for(const Label::Aab_Aab &label : labels)
 	{
 		List_A<TA,TAC> &atoms = this->list_A[label];
@@ -128,6 +140,48 @@ auto Parallel_LRI_Equally<TA,Tcell,Ndim,Tdata>::comm_tensors_map2(
 	const std::vector<Label::ab> &label_list,
 	const std::map<TA,std::map<TAC,Tensor<Tdata>>> &Ds) const
 -> std::map<TA,std::map<TAC,Tensor<Tdata>>>
+{
+	return Communicate_Tensors_Map_Judge::comm_map2_combine_origin_period(this->mpi_comm, Ds, this->get_s_list(label_list), this->period);
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+auto Parallel_LRI_Equally<TA,Tcell,Ndim,Tdata>::comm_tensors_map2(
+	const std::vector<Label::ab> &label_list,
+	const std::map<TA,std::map<TAC,Tensor<Tdata>>> &Ds,
+	Communicate_Tensors_Map_Plan<TA,TC,Tdata> &plan) const
+-> std::map<TA,std::map<TAC,Tensor<Tdata>>>
+{
+	if(!plan.check(this->mpi_comm, Ds, this->version_list_A))
+		plan.set_plan(
+			this->mpi_comm, Ds,
+			Communicate_Tensors_Map_Judge::get_judge_combine_origin_period(this->get_s_list(label_list), this->period),
+			this->version_list_A);
+	return plan.communicate(this->mpi_comm, Ds);
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+auto Parallel_LRI_Equally<TA,Tcell,Ndim,Tdata>::redistribute_tensors_map2(
+	const std::vector<Label::ab> &label_list,
+	const std::map<TA,std::map<TAC,Tensor<Tdata>>> &Ds) const
+-> std::map<TA,std::map<TAC,Tensor<Tdata>>>
+{
+	const auto judge = Communicate_Tensors_Map_Judge::get_judge_combine_origin_period(this->get_s_list(label_list), this->period);
+	Communicate_Tensors_Map_Plan<TA,TC,Tdata> plan;
+	plan.set_plan_redistribute(this->mpi_comm, Ds, judge, this->version_list_A);
+	std::map<TA,std::map<TAC,Tensor<Tdata>>> Ds_new = plan.communicate(this->mpi_comm, Ds);
+	for(const auto &Ds_A : Ds)
+		for(const auto &D_A : Ds_A.second)
+			if(judge.judge(std::make_tuple(Ds_A.first, D_A.first)))
+				Ds_new[Ds_A.first][D_A.first] = D_A.second;
+	return Ds_new;
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+auto Parallel_LRI_Equally<TA,Tcell,Ndim,Tdata>::get_s_list(
+	const std::vector<Label::ab> &label_list) const
+-> std::tuple<
+	std::vector<std::tuple< std::set<TA>, std::set<TAC> >>,
+	std::vector<std::tuple< std::set<TAC>, std::set<TAC> >>>
 {
 	std::tuple<
 		std::vector<std::tuple< std::set<TA>, std::set<std::pair<TA,TC>> >>,
@@ -176,7 +230,7 @@ auto Parallel_LRI_Equally<TA,Tcell,Ndim,Tdata>::comm_tensors_map2(
 	if(flags[4])	std::get<1>(s_list).push_back(std::make_tuple( Global_Func::to_set(this->list_Aa2), Global_Func::to_set(this->list_Ab01) ));
 	if(flags[5])	std::get<1>(s_list).push_back(std::make_tuple( Global_Func::to_set(this->list_Aa2), Global_Func::to_set(this->list_Ab2) ));
 
-	return Communicate_Tensors_Map_Judge::comm_map2_combine_origin_period(this->mpi_comm, Ds, s_list, this->period);
+	return s_list;
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,49 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Parallel_LRI_Equally.h"
+
+#include <vector>
+#include <map>
+#include <set>
+
+namespace RI
+{
+
+// Same process grid as Parallel_LRI_Equally,
+// but atoms and {atom,cell} are divided in the order along the Hilbert curve of their positions instead of by index,
+// so that each process gets atoms close in space, whose neighbour tensors are more shared among them.
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+class Parallel_LRI_Spatial: public Parallel_LRI_Equally<TA,Tcell,Ndim,Tdata>
+{
+  public:
+	using TC = std::array<Tcell,Ndim>;
+	using TAC = std::pair<TA,TC>;
+	using Tatom_pos = std::array<double,Ndim>;		// tmp
+
+	// position of {atom,cell} = atoms_pos[atom] + \sum_x cell[x] * latvec[x]
+	void set_parallel(
+		const MPI_Comm &mpi_comm_in,
+		const std::map<TA,Tatom_pos> &atoms_pos,
+		const std::array<Tatom_pos,Ndim> &latvec,
+		const std::array<Tcell,Ndim> &period_in,
+		const std::set<Label::Aab_Aab> &labels) override;
+
+  public:	// private:
+	std::vector<TA> atoms_sort;				// atoms along Hilbert curve
+	std::vector<TAC> atoms_period_sort;		// {atom,cell} along Hilbert curve
+
+  public:	// private:
+	void set_parallel_loop4_spatial();
+	void set_parallel_loop3_spatial(
+		const std::vector<TA> &atoms_vec,
+		const std::set<Label::Aab_Aab> &labels);
+};
+
+}
+
+#include "Parallel_LRI_Spatial.hpp"
\ No newline at end of file
@@ -0,0 +1,96 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Parallel_LRI_Spatial.h"
+#include "../global/Global_Func-1.h"
+#include "../distribute/Distribute_Equally.h"
+#include "../distribute/Divide_Atoms.h"
+
+#include <algorithm>
+
+namespace RI
+{
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void Parallel_LRI_Spatial<TA,Tcell,Ndim,Tdata>::set_parallel(
+	const MPI_Comm &mpi_comm_in,
+	const std::map<TA,Tatom_pos> &atoms_pos,
+	const std::array<Tatom_pos,Ndim> &latvec,
+	const std::array<Tcell,Ndim> &period_in,
+	const std::set<Label::Aab_Aab> &labels)
+{
+	this->mpi_comm = mpi_comm_in;
+	this->period = period_in;
+	const std::vector<TA> atoms_vec = Global_Func::map_key_to_vec(atoms_pos);
+	const std::vector<TAC> atoms_period_vec = Divide_Atoms::traversal_atom_period(atoms_vec, this->period);
+
+	std::vector<Tatom_pos> positions;
+	positions.reserve(atoms_vec.size());
+	for(const TA &atom : atoms_vec)
+		positions.push_back(atoms_pos.at(atom));
+	this->atoms_sort = Divide_Atoms::sort_hilbert(atoms_vec, positions);
+
+	positions.clear();
+	positions.reserve(atoms_period_vec.size());
+	for(const TAC &Ac : atoms_period_vec)
+	{
+		Tatom_pos pos = atoms_pos.at(Ac.first);
+		for(std::size_t x=0; x<Ndim; ++x)
+			for(std::size_t i=0; i<Ndim; ++i)
+				pos[i] += Ac.second[x] * latvec[x][i];
+		positions.push_back(pos);
+	}
+	this->atoms_period_sort = Divide_Atoms::sort_hilbert(atoms_period_vec, positions);
+
+	this->set_parallel_loop4_spatial();
+	this->set_parallel_loop3_spatial(atoms_vec, labels);
+	++this->version_list_A;
+}
+
+// lists of each process sorted back by index, as those of Parallel_LRI_Equally
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void Parallel_LRI_Spatial<TA,Tcell,Ndim,Tdata>::set_parallel_loop4_spatial()
+{
+	constexpr std::size_t num_index = 4;
+
+	std::pair<std::vector<TA>, std::vector<std::vector<TAC>>>
+		atoms_split_list = Distribute_Equally::distribute_atoms_periods(
+			this->mpi_comm, this->atoms_sort, this->atoms_period_sort, num_index, false);
+	std::sort(atoms_split_list.first.begin(), atoms_split_list.first.end());
+	for(std::vector<TAC> &atoms_split : atoms_split_list.second)
+		std::sort(atoms_split.begin(), atoms_split.end());
+
+	this->list_Aa01 = atoms_split_list.first;
+	this->list_Aa2  = atoms_split_list.second[0];
+	this->list_Ab01 = atoms_split_list.second[1];
+	this->list_Ab2  = atoms_split_list.second[2];
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void Parallel_LRI_Spatial<TA,Tcell,Ndim,Tdata>::set_parallel_loop3_spatial(
+	const std::vector<TA> &atoms_vec,
+	const std::set<Label::Aab_Aab> &labels)
+{
+	constexpr std::size_t num_index = 2;
+	const std::vector<TAC> atoms_period_vec = Divide_Atoms::traversal_atom_period(atoms_vec, this->period);
+
+	std::pair<std::vector<TA>, std::vector<std::vector<TAC>>>
+		atoms_split_list1 = Distribute_Equally::distribute_atoms_periods(
+			this->mpi_comm, this->atoms_sort, this->atoms_period_sort, num_index, false);
+	std::vector<std::vector<TAC>>
+		atoms_split_list2 = Distribute_Equally::distribute_periods(
+			this->mpi_comm, this->atoms_period_sort, num_index, false);
+	std::sort(atoms_split_list1.first.begin(), atoms_split_list1.first.end());
+	for(std::vector<TAC> &atoms_split : atoms_split_list1.second)
+		std::sort(atoms_split.begin(), atoms_split.end());
+	for(std::vector<TAC> &atoms_split : atoms_split_list2)
+		std::sort(atoms_split.begin(), atoms_split.end());
+
+	this->set_list_A(atoms_vec, atoms_period_vec, atoms_split_list1, atoms_split_list2, labels);
+}
+
+}
\ No newline at end of file
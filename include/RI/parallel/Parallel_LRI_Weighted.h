@@ -0,0 +1,61 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Parallel_LRI_Equally.h"
+
+#include <vector>
+#include <map>
+#include <set>
+
+namespace RI
+{
+
+// Same process grid as Parallel_LRI_Equally,
+// but loop3 atoms are divided by estimated contraction cost atoms_weight[A] instead of by count.
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+class Parallel_LRI_Weighted: public Parallel_LRI_Equally<TA,Tcell,Ndim,Tdata>
+{
+  public:
+	using TC = std::array<Tcell,Ndim>;
+	using TAC = std::pair<TA,TC>;
+	using Tatom_pos = std::array<double,Ndim>;		// tmp
+
+	void set_parallel(
+		const MPI_Comm &mpi_comm_in,
+		const std::map<TA,Tatom_pos> &atoms_pos,
+		const std::array<Tatom_pos,Ndim> &latvec,
+		const std::array<Tcell,Ndim> &period_in,
+		const std::set<Label::Aab_Aab> &labels) override;
+
+	// atoms_weight[A] = max_{A',cell} Ds[A][{A',cell}].shape[0] * shape[1], e.g. Nabf(A)*Nao(A) for Cs.
+	// Ds can be distributed; weights are reduced over all processes in set_parallel().
+	void set_atoms_weight(const std::map<TA,std::map<TAC,Tensor<Tdata>>> &Ds);
+
+	// atoms_weight = atoms_cost summed over processes, and divide loop3 atoms again,
+	// if max/mean of the measured cost over processes exceeds threshold_rebalance.
+	bool rebalance(const std::map<TA,double> &atoms_cost) override;
+
+  public:	// private:
+	std::map<TA,double> atoms_weight;		// atoms not in atoms_weight are of weight 1
+	double imbalance = 1.0;					// max/mean of loop3 cost over processes, estimated in set_parallel(), measured in rebalance()
+	double threshold_rebalance = 1.1;
+
+	std::vector<TA> atoms_vec;
+	std::set<Label::Aab_Aab> labels;
+
+  public:	// private:
+	void reduce_atoms_weight(
+		const std::vector<TA> &atoms_vec);
+	void set_parallel_loop3_weighted(
+		const std::vector<TA> &atoms_vec,
+		const std::set<Label::Aab_Aab> &labels);
+	double cal_imbalance() const;
+};
+
+}
+
+#include "Parallel_LRI_Weighted.hpp"
\ No newline at end of file
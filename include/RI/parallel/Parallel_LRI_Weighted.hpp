@@ -0,0 +1,169 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Parallel_LRI_Weighted.h"
+#include "../global/Global_Func-1.h"
+#include "../global/MPI_Wrapper-func.h"
+#include "../distribute/Distribute_Weighted.h"
+#include "../distribute/Divide_Atoms.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace RI
+{
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void Parallel_LRI_Weighted<TA,Tcell,Ndim,Tdata>::set_parallel(
+	const MPI_Comm &mpi_comm_in,
+	const std::map<TA,Tatom_pos> &atoms_pos,
+	const std::array<Tatom_pos,Ndim> &,
+	const std::array<Tcell,Ndim> &period_in,
+	const std::set<Label::Aab_Aab> &labels)
+{
+	this->mpi_comm = mpi_comm_in;
+	this->period = period_in;
+	this->atoms_vec = Global_Func::map_key_to_vec(atoms_pos);
+	this->labels = labels;
+
+	this->reduce_atoms_weight(this->atoms_vec);
+	this->set_parallel_loop4(this->atoms_vec);
+	this->set_parallel_loop3_weighted(this->atoms_vec, this->labels);
+	this->imbalance = this->cal_imbalance();
+	++this->version_list_A;
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+bool Parallel_LRI_Weighted<TA,Tcell,Ndim,Tdata>::rebalance(
+	const std::map<TA,double> &atoms_cost)
+{
+	double cost_max = 0;
+	for(const auto &atom_cost : atoms_cost)
+		cost_max += atom_cost.second;
+	double cost_sum = cost_max;
+	MPI_Wrapper::mpi_allreduce(cost_max, MPI_MAX, this->mpi_comm);
+	MPI_Wrapper::mpi_allreduce(cost_sum, MPI_SUM, this->mpi_comm);
+	if(cost_sum<=0)
+		return false;
+	this->imbalance = cost_max / (cost_sum / MPI_Wrapper::mpi_get_size(this->mpi_comm));
+	if(this->imbalance < this->threshold_rebalance)
+		return false;
+
+	std::vector<double> costs(this->atoms_vec.size(), 0);
+	for(std::size_t iatom=0; iatom<this->atoms_vec.size(); ++iatom)
+	{
+		const auto ptr = atoms_cost.find(this->atoms_vec[iatom]);
+		if(ptr!=atoms_cost.end())
+			costs[iatom] = ptr->second;
+	}
+	MPI_Wrapper::mpi_allreduce(costs.data(), costs.size(), MPI_SUM, this->mpi_comm);
+	// atoms with no measured cost, e.g. all screened, still cost communication
+	const double cost_min = 1E-3 * cost_sum / this->atoms_vec.size();
+	for(std::size_t iatom=0; iatom<this->atoms_vec.size(); ++iatom)
+		this->atoms_weight[this->atoms_vec[iatom]] = std::max(costs[iatom], cost_min);
+
+	const std::unordered_map<Label::Aab_Aab, List_A<TA,TAC>> list_A_old = this->list_A;
+	this->set_parallel_loop3_weighted(this->atoms_vec, this->labels);
+
+	int flag_changed = 0;
+	for(const auto &list_atom : this->list_A)
+	{
+		const List_A<TA,TAC> &list_atom_old = list_A_old.at(list_atom.first);
+		if(list_atom.second.a01 != list_atom_old.a01 || list_atom.second.a2 != list_atom_old.a2
+		|| list_atom.second.b01 != list_atom_old.b01 || list_atom.second.b2 != list_atom_old.b2)
+			flag_changed = 1;
+	}
+	MPI_Wrapper::mpi_allreduce(flag_changed, MPI_MAX, this->mpi_comm);
+	if(flag_changed)
+		++this->version_list_A;
+	return flag_changed;
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void Parallel_LRI_Weighted<TA,Tcell,Ndim,Tdata>::set_atoms_weight(
+	const std::map<TA,std::map<TAC,Tensor<Tdata>>> &Ds)
+{
+	for(const auto &Ds_A : Ds)
+	{
+		double &weight = this->atoms_weight[Ds_A.first];
+		for(const auto &Ds_B : Ds_A.second)
+		{
+			const Shape_Vector &shape = Ds_B.second.shape;
+			double weight_D = 1;
+			for(std::size_t i=0; i<std::min(shape.size(), std::size_t(2)); ++i)
+				weight_D *= shape[i];
+			weight = std::max(weight, weight_D);
+		}
+	}
+}
+
+// atoms_weight may be known only on processes holding the tensors
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void Parallel_LRI_Weighted<TA,Tcell,Ndim,Tdata>::reduce_atoms_weight(
+	const std::vector<TA> &atoms_vec)
+{
+	std::vector<double> weights(atoms_vec.size(), 0);
+	for(std::size_t iatom=0; iatom<atoms_vec.size(); ++iatom)
+	{
+		const auto ptr = this->atoms_weight.find(atoms_vec[iatom]);
+		if(ptr!=this->atoms_weight.end())
+			weights[iatom] = ptr->second;
+	}
+	MPI_Wrapper::mpi_allreduce(weights.data(), weights.size(), MPI_MAX, this->mpi_comm);
+	for(std::size_t iatom=0; iatom<atoms_vec.size(); ++iatom)
+		if(weights[iatom]>0)
+			this->atoms_weight[atoms_vec[iatom]] = weights[iatom];
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void Parallel_LRI_Weighted<TA,Tcell,Ndim,Tdata>::set_parallel_loop3_weighted(
+	const std::vector<TA> &atoms_vec,
+	const std::set<Label::Aab_Aab> &labels)
+{
+	constexpr std::size_t num_index = 2;
+	const std::vector<TAC> atoms_period_vec = Divide_Atoms::traversal_atom_period(atoms_vec, this->period);
+
+	const std::pair<std::vector<TA>, std::vector<std::vector<std::pair<TA,TC>>>>
+		atoms_split_list1 = Distribute_Weighted::distribute_atoms_periods(
+			this->mpi_comm, atoms_vec, this->period, num_index, false, this->atoms_weight);
+	const std::vector<std::vector<std::pair<TA,TC>>>
+		atoms_split_list2 = Distribute_Weighted::distribute_periods(
+			this->mpi_comm, atoms_vec, this->period, num_index, false, this->atoms_weight);
+	this->set_list_A(atoms_vec, atoms_period_vec, atoms_split_list1, atoms_split_list2, labels);
+}
+
+// cost of process = \sum_label \prod_{a01,a2,b01,b2} \sum_{atom in list} atoms_weight[atom]
+// imbalance = max(cost) / mean(cost)
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+double Parallel_LRI_Weighted<TA,Tcell,Ndim,Tdata>::cal_imbalance() const
+{
+	auto sum_weight = [this](const std::vector<TAC> &list) -> double
+	{
+		double weight = 0;
+		for(const TAC &Ax : list)
+			weight += Divide_Atoms::get_atom_weight(this->atoms_weight, Ax.first);
+		return weight;
+	};
+
+	double cost = 0;
+	for(const auto &list_atom : this->list_A)
+	{
+		double weight_a01 = 0;
+		for(const TA &Aa01 : list_atom.second.a01)
+			weight_a01 += Divide_Atoms::get_atom_weight(this->atoms_weight, Aa01);
+		cost += weight_a01 * sum_weight(list_atom.second.a2) * sum_weight(list_atom.second.b01) * sum_weight(list_atom.second.b2);
+	}
+
+	double cost_max = cost, cost_sum = cost;
+	MPI_Wrapper::mpi_allreduce(cost_max, MPI_MAX, this->mpi_comm);
+	MPI_Wrapper::mpi_allreduce(cost_sum, MPI_SUM, this->mpi_comm);
+	const double cost_mean = cost_sum / MPI_Wrapper::mpi_get_size(this->mpi_comm);
+	return (cost_mean>0) ? cost_max/cost_mean : 1.0;
+}
+
+}
\ No newline at end of file
@@ -25,6 +25,7 @@ public:
 	using TC = std::array<Tcell,Ndim>;
 	using TAC = std::pair<TA,TC>;
 	using Tdata_real = Global_Func::To_Real_t<Tdata>;
+	using Tdata_float = Global_Func::To_Float_t<Tdata>;
 	using Tpos = double;							// tmp
 	constexpr static std::size_t Npos = Ndim;		// tmp
 	using Tatom_pos = std::array<Tpos,Npos>;		// tmp
@@ -51,6 +52,10 @@ public:
 		const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds,
 		const Tdata_real &threshold,
 		const std::string &save_name_suffix="");
+	// Only tensors of Ds changed beyond threshold since last sent are sent and added to Ds of set_Ds().
+	// A change within threshold is kept in Ds_input until it accumulates beyond threshold,
+	// so each tensor used differs from Ds by at most threshold (summed over periodic images of the same cell) in every call, without drift.
+	// Exactly the same as set_Ds() with threshold=0.
 	void set_Ds_delta(
 		const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds,
 		const Tdata_real &threshold,
@@ -88,6 +93,18 @@ public:
 
 	Exx_Post_2D<TA,TC,Tdata> post_2D;
 
+	// cal_Hs() by lri_float, with Cs, Vs, Ds converted to Tdata_float and Hs still added in Tdata. Set false for the final iterations.
+	// cal_force() and cal_stress() are always in Tdata.
+	bool flag_float = false;
+
+	// set_Cs() and set_Vs() with "flag_out_of_core" of LRI::set_tensors_map2(), for cells whose Cs and Vs exceed memory.
+	// Files are written with lri.prefix_out_of_core.
+	bool flag_out_of_core = false;
+	double memory_out_of_core_max = 1e9;		// bytes of each of Cs and Vs kept in memory
+	// set_Cs() and set_Vs() with "flag_shared_memory" of LRI::set_tensors_map2(), for several processes on one node.
+	// Blocks used are still copied in each process, up to memory_out_of_core_max.
+	bool flag_shared_memory = false;
+
 	void free_Cs(const std::string &save_name_suffix="");
 	void free_Vs(const std::string &save_name_suffix="");
 	void free_Ds(const std::string &save_name_suffix="");
@@ -97,8 +114,23 @@ public:
 	void free_dCRs(const std::string &save_name_suffix="");
 	void free_dVRs(const std::string &save_name_suffix="");
 
+	// lri, flag_finish, Hs and energy in the binary format of Checkpoint, one file for each process.
+	// read_checkpoint() after set_parallel() and set_symmetry() for restart, instead of set_Cs(), set_Vs(), ... and their communication.
+	// post_2D is not saved.
+	void write_checkpoint(const std::string &file_name) const;
+	void read_checkpoint(const std::string &file_name);
+
 public:
 	LRI<TA,Tcell,Ndim,Tdata> lri;
+	LRI<TA,Tcell,Ndim,Tdata_float> lri_float;		// data_pool converted from lri when first used by cal_Hs() with flag_float
+
+	// convert data_pool of lri used by cal_Hs() into lri_float, if not yet.
+	void set_lri_float();
+
+	// Ds_input[save_name_suffix]: local Ds as last sent by set_Ds() or set_Ds_delta(), compared with the next set_Ds_delta().
+	std::map<std::string, std::map<TA, std::map<TAC, Tensor<Tdata>>>> Ds_input;
+	// whether D passes lri.filter_funcs of Ds
+	bool judge_Ds_filter(const Tensor<Tdata> &D, const Tdata_real &threshold) const;
 
 	struct Flag_Finish
 	{
@@ -9,9 +9,11 @@
 #include "../ri/Cell_Nearest.h"
 #include "../ri/Label.h"
 #include "../global/Map_Operator.h"
+#include "../global/Checkpoint.h"
 #include "./symmetry/Filter_Atom_Symmetry.h"
 
 #include <cassert>
+#include <fstream>
 
 namespace RI
 {
@@ -26,6 +28,9 @@ void Exx<TA,Tcell,Ndim,Tdata>::set_parallel(
 	this->lri.set_parallel(
 		mpi_comm, atoms_pos, latvec, period,
 		{Label::ab_ab::a0b0_a1b1, Label::ab_ab::a0b0_a1b2, Label::ab_ab::a0b0_a2b1, Label::ab_ab::a0b0_a2b2});
+	this->lri_float.set_parallel(
+		mpi_comm, atoms_pos, latvec, period,
+		{Label::ab_ab::a0b0_a1b1, Label::ab_ab::a0b0_a1b2, Label::ab_ab::a0b0_a2b1, Label::ab_ab::a0b0_a2b2});
 	this->flag_finish.stru = true;
 	//if()
 		this->post_2D.set_parallel(mpi_comm, atoms_pos, period);
@@ -41,6 +46,7 @@ void Exx<TA,Tcell,Ndim,Tdata>::set_symmetry(
 			this->lri.period, irreducible_sector);
 	else
 		this->lri.filter_atom = std::make_shared<Filter_Atom<TA,TAC>>();
+	this->lri_float.filter_atom = this->lri.filter_atom;
 }
 
 template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
@@ -52,14 +58,16 @@ void Exx<TA,Tcell,Ndim,Tdata>::set_Cs(
 	this->lri.set_tensors_map2(
 		Cs,
 		{Label::ab::a, Label::ab::b},
-		{{"threshold_filter", threshold}},
+		{{"threshold_filter", threshold}, {"flag_out_of_core", this->flag_out_of_core}, {"memory_out_of_core_max", this->memory_out_of_core_max}, {"flag_shared_memory", this->flag_shared_memory}},
 		"Cs_"+save_name_suffix );
+	this->lri_float.free_tensors_map2("Cs_"+save_name_suffix);
 	this->flag_finish.Cs = true;
 }
 template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
 void Exx<TA,Tcell,Ndim,Tdata>::free_Cs(const std::string &save_name_suffix)
 {
 	this->lri.free_tensors_map2("Cs_"+save_name_suffix);
+	this->lri_float.free_tensors_map2("Cs_"+save_name_suffix);
 	this->flag_finish.Cs = false;
 }
 
@@ -72,14 +80,16 @@ void Exx<TA,Tcell,Ndim,Tdata>::set_Vs(
 	this->lri.set_tensors_map2(
 		Vs,
 		{Label::ab::a0b0},
-		{{"threshold_filter", threshold}},
+		{{"threshold_filter", threshold}, {"flag_out_of_core", this->flag_out_of_core}, {"memory_out_of_core_max", this->memory_out_of_core_max}, {"flag_shared_memory", this->flag_shared_memory}},
 		"Vs_"+save_name_suffix );
+	this->lri_float.free_tensors_map2("Vs_"+save_name_suffix);
 	this->flag_finish.Vs = true;
 }
 template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
 void Exx<TA,Tcell,Ndim,Tdata>::free_Vs(const std::string &save_name_suffix)
 {
 	this->lri.free_tensors_map2("Vs_"+save_name_suffix);
+	this->lri_float.free_tensors_map2("Vs_"+save_name_suffix);
 	this->flag_finish.Vs = false;
 }
 
@@ -92,11 +102,19 @@ void Exx<TA,Tcell,Ndim,Tdata>::set_Ds(
 	this->lri.set_tensors_map2(
 		Ds,
 		{Label::ab::a1b1, Label::ab::a1b2, Label::ab::a2b1, Label::ab::a2b2},
-		{{"threshold_filter", threshold}},
+		{{"flag_comm_plan", true}, {"threshold_filter", threshold}},
 		"Ds_"+save_name_suffix );
+	this->lri_float.free_tensors_map2("Ds_"+save_name_suffix);
 	this->flag_finish.Ds = true;
 	this->flag_finish.Ds_delta = false;
 
+	std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_input = this->Ds_input[save_name_suffix];
+	Ds_input.clear();
+	for(const auto &Ds_A : Ds)
+		for(const auto &D_A : Ds_A.second)
+			if(this->judge_Ds_filter(D_A.second, threshold))
+				Ds_input[Ds_A.first][D_A.first] = D_A.second;
+
 	//if()
 		this->post_2D.saves["Ds_"+save_name_suffix] = this->post_2D.set_tensors_map2(Ds);
 }
@@ -104,6 +122,8 @@ template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
 void Exx<TA,Tcell,Ndim,Tdata>::free_Ds(const std::string &save_name_suffix)
 {
 	this->lri.free_tensors_map2("Ds_"+save_name_suffix);
+	this->lri_float.free_tensors_map2("Ds_"+save_name_suffix);
+	this->Ds_input.erase(save_name_suffix);
 	this->flag_finish.Ds = false;
 }
 
@@ -113,35 +133,65 @@ void Exx<TA,Tcell,Ndim,Tdata>::set_Ds_delta(
 	const Tdata_real &threshold,
 	const std::string &save_name_suffix)
 {
-	using namespace Map_Operator;
-
 	assert(flag_finish.Ds);
-	this->lri.set_tensors_map2(
-		Ds,
-		{Label::ab::a1b1, Label::ab::a1b2, Label::ab::a2b1, Label::ab::a2b2},
-		{{"flag_filter", false}},
-		"Ds_tmp" );
-	this->lri.set_tensors_map2(
-		this->lri.data_pool["Ds_tmp"].Ds_ab - this->lri.data_pool["Ds_"+save_name_suffix].Ds_ab,
-		{Label::ab::a1b1, Label::ab::a1b2, Label::ab::a2b1, Label::ab::a2b2},
-		{{"flag_period", false}, {"flag_comm", false}, {"flag_filter", true}, {"threshold_filter", threshold}},
-		"Ds_delta_"+save_name_suffix);
-	this->lri.data_pool.erase("Ds_tmp");
-	this->lri.set_tensors_map2(
-		this->lri.data_pool["Ds_delta_"+save_name_suffix].Ds_ab + this->lri.data_pool["Ds_"+save_name_suffix].Ds_ab,
-		{Label::ab::a1b1, Label::ab::a1b2, Label::ab::a2b1, Label::ab::a2b2},
-		{{"flag_period", false}, {"flag_comm", false}, {"flag_filter", false}},
-		"Ds_"+save_name_suffix);
+	// Ds_input is not in checkpoint
+	if(this->lri.data_pool.find("Ds_"+save_name_suffix) == this->lri.data_pool.end()
+		|| this->Ds_input.find(save_name_suffix) == this->Ds_input.end())
+	{
+		this->set_Ds(Ds, threshold, save_name_suffix);
+		return;
+	}
+
+	// Only tensors changed beyond threshold since the last set_Ds() or set_Ds_delta() are communicated,
+	// and patched into "Ds_" in place. The others stay in Ds_input as before, to be compared next time.
+	std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_input = this->Ds_input.at(save_name_suffix);
+	std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_delta;
+	for(const auto &Ds_A : Ds)
+		for(const auto &D_A : Ds_A.second)
+		{
+			const Tensor<Tdata> &D_input = Global_Func::find(Ds_input, Ds_A.first, D_A.first);
+			const Tensor<Tdata> D_delta = D_input.empty() ? D_A.second : D_A.second - D_input;
+			if(this->judge_Ds_filter(D_delta, threshold))
+			{
+				Ds_delta[Ds_A.first][D_A.first] = D_delta;
+				Ds_input[Ds_A.first][D_A.first] = D_A.second;
+			}
+		}
+	for(auto &Ds_A : Ds_input)
+		for(auto ptr=Ds_A.second.begin(); ptr!=Ds_A.second.end(); )
+		{
+			if(Global_Func::find(Ds, Ds_A.first, ptr->first).empty() && this->judge_Ds_filter(ptr->second, threshold))
+			{
+				Ds_delta[Ds_A.first][ptr->first] = -ptr->second;
+				ptr = Ds_A.second.erase(ptr);
+			}
+			else
+				++ptr;
+		}
+
+	this->lri.add_tensors_map2(Ds_delta, "Ds_"+save_name_suffix, "Ds_delta_"+save_name_suffix);
+	this->lri_float.free_tensors_map2("Ds_delta_"+save_name_suffix);
+	this->lri_float.free_tensors_map2("Ds_"+save_name_suffix);
 	this->flag_finish.Ds_delta = true;
 	this->flag_finish.Ds = true;
 
 	//if()
 		this->post_2D.saves["Ds_"+save_name_suffix] = this->post_2D.set_tensors_map2(Ds);
 }
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+bool Exx<TA,Tcell,Ndim,Tdata>::judge_Ds_filter(const Tensor<Tdata> &D, const Tdata_real &threshold) const
+{
+	for(const Label::ab label : {Label::ab::a1b1, Label::ab::a1b2, Label::ab::a2b1, Label::ab::a2b2})
+		if(this->lri.filter_funcs.at(label)(D, threshold))
+			return true;
+	return false;
+}
+
 template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
 void Exx<TA,Tcell,Ndim,Tdata>::free_Ds_delta(const std::string &save_name_suffix)
 {
 	this->lri.free_tensors_map2("Ds_delta_"+save_name_suffix);
+	this->lri_float.free_tensors_map2("Ds_delta_"+save_name_suffix);
 	this->flag_finish.Ds_delta = false;
 }
 
@@ -266,12 +316,21 @@ void Exx<TA,Tcell,Ndim,Tdata>::cal_Hs(
 
 	if(!this->flag_finish.Ds_delta)
 		this->Hs.clear();
-	this->lri.cal_loop3(
-		{Label::ab_ab::a0b0_a1b1,
-		 Label::ab_ab::a0b0_a1b2,
-		 Label::ab_ab::a0b0_a2b1,
-		 Label::ab_ab::a0b0_a2b2},
-		this->Hs);
+	const std::vector<Label::ab_ab> labels = {
+		Label::ab_ab::a0b0_a1b1,
+		Label::ab_ab::a0b0_a1b2,
+		Label::ab_ab::a0b0_a2b1,
+		Label::ab_ab::a0b0_a2b2};
+	if(this->flag_float)
+	{
+		this->set_lri_float();
+		this->lri_float.cal_loop3(labels, this->Hs);
+	}
+	else
+	{
+		this->lri_float.data_pool.clear();
+		this->lri.cal_loop3(labels, this->Hs);
+	}
 
 	//if()
 		this->energy = this->post_2D.cal_energy(
@@ -282,6 +341,42 @@ void Exx<TA,Tcell,Ndim,Tdata>::cal_Hs(
 		this->Hs.clear();
 }
 
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void Exx<TA,Tcell,Ndim,Tdata>::set_lri_float()
+{
+	this->lri_float.data_ab_name = this->lri.data_ab_name;
+	this->lri_float.prefix_out_of_core = this->lri.prefix_out_of_core+"float_";
+	this->lri_float.threshold_cs.clear();
+	for(const auto &threshold : this->lri.threshold_cs)
+		this->lri_float.threshold_cs[threshold.first] = threshold.second;
+
+	for(const auto &name : this->lri.data_ab_name)
+	{
+		if(this->lri_float.data_pool.find(name.second) != this->lri_float.data_pool.end())
+			continue;
+		const Data_Pack<TA,TC,Tdata> &data_pack = this->lri.data_pool.at(name.second);
+		std::map<TA, std::map<TAC, Tensor<Tdata_float>>> Ds_float;
+		std::vector<std::shared_ptr<const typename Tensors_Map2_Disk<TA,TAC,Tdata>::Block>> blocks_holder;
+		for(const auto &Ds_A : data_pack.Ds_ab)
+		{
+			for(const auto &D_A : Ds_A.second)
+				Ds_float[Ds_A.first][D_A.first] = Global_Func::convert<Tdata_float>(
+					data_pack.Ds_ab_disk
+					? data_pack.Ds_ab_disk->find(Ds_A.first, D_A.first, blocks_holder)
+					: D_A.second);
+			blocks_holder.clear();
+		}
+		// data_pack is already periodic, distributed and filtered
+		this->lri_float.set_tensors_map2(
+			Ds_float,
+			data_pack.label_list,
+			{{"flag_period", false}, {"flag_comm", false}, {"flag_filter", false},
+			 {"flag_out_of_core", data_pack.para.at("flag_out_of_core")}, {"memory_out_of_core_max", data_pack.para.at("memory_out_of_core_max")},
+			 {"flag_shared_memory", data_pack.para.at("flag_shared_memory")}},
+			name.second );
+	}
+}
+
 template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
 void Exx<TA,Tcell,Ndim,Tdata>::cal_force(
 	const std::array<std::string,5> &save_names_suffix)						// "Cs","Vs","Ds","dCs","dVs"
@@ -442,4 +537,29 @@ void Exx<TA,Tcell,Ndim,Tdata>::cal_stress(
 		}
 }
 
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void Exx<TA,Tcell,Ndim,Tdata>::write_checkpoint(const std::string &file_name) const
+{
+	std::ofstream ofs(file_name, std::ios::binary);
+	Checkpoint::check(ofs, __FILE__, __LINE__);
+	this->lri.write_checkpoint(ofs);
+	Checkpoint::write(ofs, this->flag_finish);
+	Checkpoint::write_tensors_map2(ofs, this->Hs);
+	Checkpoint::write(ofs, this->energy);
+	Checkpoint::check(ofs, __FILE__, __LINE__);
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void Exx<TA,Tcell,Ndim,Tdata>::read_checkpoint(const std::string &file_name)
+{
+	std::ifstream ifs(file_name, std::ios::binary);
+	Checkpoint::check(ifs, __FILE__, __LINE__);
+	this->lri.read_checkpoint(ifs);
+	Checkpoint::read(ifs, this->flag_finish);
+	this->Hs = Checkpoint::read_tensors_map2<TA,TAC,Tdata>(ifs);
+	Checkpoint::read(ifs, this->energy);
+	Checkpoint::check(ifs, __FILE__, __LINE__);
+	this->lri_float.data_pool.clear();
+}
+
 }
\ No newline at end of file
@@ -65,6 +65,11 @@ public:
 	void free_Ws(const std::string &save_name_suffix="");
 	void free_Gs(const std::string &save_name_suffix="");
 
+	// lri, flag_finish and Sigmas in the binary format of Checkpoint, one file for each process.
+	// read_checkpoint() after set_parallel() and set_symmetry() for restart.
+	void write_checkpoint(const std::string &file_name) const;
+	void read_checkpoint(const std::string &file_name);
+
 public:
 	LRI<TA,Tcell,Ndim,Tdata> lri;
 
@@ -7,6 +7,9 @@
 #include "GW.h"
 #include "../ri/Label.h"
 #include "./symmetry/Filter_Atom_Symmetry.h"
+#include "../global/Checkpoint.h"
+
+#include <fstream>
 
 namespace RI
 {
@@ -124,4 +127,26 @@ void GW<TA, Tcell, Ndim, Tdata>::cal_Sigmas(
 		this->Sigmas);
 }
 
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void GW<TA,Tcell,Ndim,Tdata>::write_checkpoint(const std::string &file_name) const
+{
+	std::ofstream ofs(file_name, std::ios::binary);
+	Checkpoint::check(ofs, __FILE__, __LINE__);
+	this->lri.write_checkpoint(ofs);
+	Checkpoint::write(ofs, this->flag_finish);
+	Checkpoint::write_tensors_map2(ofs, this->Sigmas);
+	Checkpoint::check(ofs, __FILE__, __LINE__);
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void GW<TA,Tcell,Ndim,Tdata>::read_checkpoint(const std::string &file_name)
+{
+	std::ifstream ifs(file_name, std::ios::binary);
+	Checkpoint::check(ifs, __FILE__, __LINE__);
+	this->lri.read_checkpoint(ifs);
+	Checkpoint::read(ifs, this->flag_finish);
+	this->Sigmas = Checkpoint::read_tensors_map2<TA,TAC,Tdata>(ifs);
+	Checkpoint::check(ifs, __FILE__, __LINE__);
+}
+
 } // namespace RI
\ No newline at end of file
@@ -5,12 +5,17 @@
 
 #pragma once
 
+#include "Label.h"
 #include "../global/Tensor.h"
 #include "../global/Global_Func-1.h"
+#include "../global/Tensors_Map2_Frozen.h"
+#include "../global/Tensors_Map2_Disk.h"
 
 #include <vector>
 #include <map>
 #include <set>
+#include <string>
+#include <memory>
 
 namespace RI
 {
@@ -23,6 +28,29 @@ struct Data_Pack
 
 	std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_ab;					// Ds_ab[A0][{A1,C1}]
 	std::vector<std::set<TA>> index_Ds_ab;								// index_Ds_ab[0]=A1
+	Tensors_Map2_Frozen<TA,TAC,Tdata> Ds_ab_frozen;						// read-only copy of Ds_ab, for calculation, made again at the beginning of LRI::cal_loop3()
+
+	// if para["flag_out_of_core"] or para["flag_shared_memory"], tensors are kept in Ds_ab_disk, while Ds_ab and Ds_ab_frozen keep only their shapes.
+	std::shared_ptr<Tensors_Map2_Disk<TA,TAC,Tdata>> Ds_ab_disk;
+
+	// for Cauchy-Schwarz screening
+	std::map<TA, std::map<TAC, Tdata_real>> Ds_ab_norm;					// Ds_ab_norm[A0][{A1,C1}] = ||Ds_ab[A0][{A1,C1}]||_F
+	std::map<TA, Tdata_real> Ds_ab_norm_max0;							// Ds_ab_norm_max0[A0] = max_{A1,C1} Ds_ab_norm[A0][{A1,C1}]
+	std::map<TA, Tdata_real> Ds_ab_norm_max1;							// Ds_ab_norm_max1[A1] = max_{A0,C1} Ds_ab_norm[A0][{A1,C1}]
+	Tdata_real Ds_ab_norm_max = 0;										// max of all Ds_ab_norm
+	std::map<TA, Tdata_real> Ds_ab_norm_sum0;							// Ds_ab_norm_sum0[A0] = sum_{A1,C1} Ds_ab_norm[A0][{A1,C1}]
+	std::map<TA, Tdata_real> Ds_ab_norm_sum1;							// Ds_ab_norm_sum1[A1] = sum_{A0,C1} Ds_ab_norm[A0][{A1,C1}]
+	Tdata_real Ds_ab_norm_sum = 0;										// sum of all Ds_ab_norm
+
+	// Ds_ab_transpose[A0][{A1,C1}](i1,i0,i2) = Ds_ab[A0][{A1,C1}](i0,i1,i2), for LRI::cal_loop3().
+	// Created when first used, and kept until set_tensors_map2() or out of LRI::memory_transpose_max.
+	bool flag_transpose = false;
+	std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_ab_transpose;
+	std::shared_ptr<Tensors_Map2_Disk<TA,TAC,Tdata>> Ds_ab_transpose_disk;	// instead of Ds_ab_transpose if Ds_ab_disk
+
+	// of LRI::set_tensors_map2(), for LRI::add_tensors_map2() and LRI::rebalance()
+	std::vector<Label::ab> label_list;
+	std::map<std::string, double> para;
 };
 
 
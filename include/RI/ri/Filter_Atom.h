@@ -10,6 +10,10 @@
 namespace RI
 {
 
+// filter_for*() are called by all threads of cal_loop3() at the same time,
+// and filter_for1() of the same atom may be called once by each thread, e.g. in LRI_Cal_Aux::get_tasks().
+// So they must be thread-safe and return the same value for the same arguments without side effects,
+// except for statistics kept by each thread as in Filter_Atom_CS.
 template<typename TA, typename TAC>
 class Filter_Atom
 {
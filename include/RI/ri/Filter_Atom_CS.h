@@ -0,0 +1,270 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Filter_Atom.h"
+#include "Data_Pack.h"
+#include "Label_Tools.h"
+#include "../global/Global_Func-1.h"
+#include "../global/Array_Operator.h"
+
+#include <omp.h>
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <cassert>
+
+namespace RI
+{
+
+// Cauchy-Schwarz screening.
+// D_result += D_a * D_ab_first * D_ab_second * D_b,
+// ||D_result|| <= ||D_a|| * ||D_ab_first|| * ||D_ab_second|| * ||D_b||.
+// Each D_result sums over the atom of D_a and the atom of D_b not in D_result, e.g. Aa01 of D_mul and Ab01 in a0b0_a1b1.
+// So ||D_a|| and ||D_b|| are summed over these atoms, whether fixed in the loop or not,
+// and ||D_ab|| is the max among the atoms not fixed yet.
+// Skip when the upper limit < threshold[label],
+// then the parts skipped of each D_result of label add up to less than threshold[label].
+// filter_next is checked first, e.g. Filter_Atom_Symmetry.
+template<typename TA, typename TC, typename Tdata>
+class Filter_Atom_CS: public Filter_Atom<TA, std::pair<TA,TC>>
+{
+public:
+	using TAC = std::pair<TA,TC>;
+	using Tdata_real = Global_Func::To_Real_t<Tdata>;
+
+	struct Statistics
+	{
+		std::array<std::size_t,4> n_check = {};		// filter_for1, filter_for2, filter_for31, filter_for32
+		std::array<std::size_t,4> n_skip  = {};
+	};
+
+	Filter_Atom_CS(
+		const std::shared_ptr<Filter_Atom<TA,TAC>> &filter_next_in,
+		const std::unordered_map<Label::ab_ab, Tdata_real> &threshold_in,
+		const TC &period_in,
+		const std::map<std::string, Data_Pack<TA,TC,Tdata>> &data_pool,
+		const std::unordered_map<Label::ab, std::string> &data_ab_name)
+		:filter_next(filter_next_in),
+		 threshold(threshold_in),
+		 period(period_in),
+		 stats_thread(omp_get_max_threads())
+	{
+		this->data_packs.fill(nullptr);
+		for(const auto &name : data_ab_name)
+			if(!name.second.empty())
+				this->data_packs[static_cast<std::size_t>(name.first)] = &data_pool.at(name.second);
+	}
+
+	virtual bool filter_for1(const Label::ab_ab &label, const TA &A1) const override
+	{
+		if(this->filter_next->filter_for1(label, A1))	return true;
+		// a01b01_a2b01, a01b01_a2b2, a01b2_a2b01:  Aa01
+		return this->filter(label, 0, &A1, nullptr, nullptr, nullptr);
+	}
+	virtual bool filter_for1(const Label::ab_ab &label, const TAC &A1) const override
+	{
+		if(this->filter_next->filter_for1(label, A1))	return true;
+		switch(Label_Tools::to_Aab_Aab(label))
+		{
+			case Label::Aab_Aab::a01b01_a01b01:			// Aa2
+				return this->filter(label, 0, nullptr, &A1, nullptr, nullptr);
+			case Label::Aab_Aab::a01b01_a01b2:			// Ab01
+				return this->filter(label, 0, nullptr, nullptr, &A1, nullptr);
+			default:
+				throw std::invalid_argument("label "+Label_Tools::get_name(label)+" error in "+std::string(__FILE__)+" line "+std::to_string(__LINE__));
+		}
+	}
+
+	virtual bool filter_for2(const Label::ab_ab &label, const TA &A1, const TAC &A2) const override
+	{
+		if(this->filter_next->filter_for2(label, A1, A2))	return true;
+		switch(Label_Tools::to_Aab_Aab(label))
+		{
+			case Label::Aab_Aab::a01b01_a2b01:			// Aa01, Ab01
+			case Label::Aab_Aab::a01b2_a2b01:			// Aa01, Ab01
+				return this->filter(label, 1, &A1, nullptr, &A2, nullptr);
+			case Label::Aab_Aab::a01b01_a2b2:			// Aa01, Ab2
+				return this->filter(label, 1, &A1, nullptr, nullptr, &A2);
+			default:
+				throw std::invalid_argument("label "+Label_Tools::get_name(label)+" error in "+std::string(__FILE__)+" line "+std::to_string(__LINE__));
+		}
+	}
+	virtual bool filter_for2(const Label::ab_ab &label, const TAC &A1, const TA &A2) const override
+	{
+		if(this->filter_next->filter_for2(label, A1, A2))	return true;
+		// a01b01_a01b2:  Ab01, Aa01
+		return this->filter(label, 1, &A2, nullptr, &A1, nullptr);
+	}
+	virtual bool filter_for2(const Label::ab_ab &label, const TAC &A1, const TAC &A2) const override
+	{
+		if(this->filter_next->filter_for2(label, A1, A2))	return true;
+		// a01b01_a01b01:  Aa2, Ab01
+		return this->filter(label, 1, nullptr, &A1, &A2, nullptr);
+	}
+
+	virtual bool filter_for31(const Label::ab_ab &label, const TA &A1, const TAC &A2, const TAC &A3) const override
+	{
+		if(this->filter_next->filter_for31(label, A1, A2, A3))	return true;
+		switch(Label_Tools::to_Aab_Aab(label))
+		{
+			case Label::Aab_Aab::a01b01_a2b01:			// Aa01, Ab01, Aa2
+				return this->filter(label, 2, &A1, &A3, &A2, nullptr);
+			case Label::Aab_Aab::a01b01_a2b2:			// Aa01, Ab2, Aa2
+				return this->filter(label, 2, &A1, &A3, nullptr, &A2);
+			case Label::Aab_Aab::a01b2_a2b01:			// Aa01, Ab01, Ab2
+				return this->filter(label, 2, &A1, nullptr, &A2, &A3);
+			default:
+				throw std::invalid_argument("label "+Label_Tools::get_name(label)+" error in "+std::string(__FILE__)+" line "+std::to_string(__LINE__));
+		}
+	}
+	virtual bool filter_for31(const Label::ab_ab &label, const TAC &A1, const TA &A2, const TAC &A3) const override
+	{
+		if(this->filter_next->filter_for31(label, A1, A2, A3))	return true;
+		// a01b01_a01b2:  Ab01, Aa01, Ab2
+		return this->filter(label, 2, &A2, nullptr, &A1, &A3);
+	}
+	virtual bool filter_for31(const Label::ab_ab &label, const TAC &A1, const TAC &A2, const TA &A3) const override
+	{
+		if(this->filter_next->filter_for31(label, A1, A2, A3))	return true;
+		// a01b01_a01b01:  Aa2, Ab01, Aa01
+		return this->filter(label, 2, &A3, &A1, &A2, nullptr);
+	}
+
+	virtual bool filter_for32(const Label::ab_ab &label, const TA &A1, const TAC &A2, const TAC &A3) const override
+	{
+		if(this->filter_next->filter_for32(label, A1, A2, A3))	return true;
+		switch(Label_Tools::to_Aab_Aab(label))
+		{
+			case Label::Aab_Aab::a01b01_a2b01:			// Aa01, Ab01, Ab2
+				return this->filter(label, 3, &A1, nullptr, &A2, &A3);
+			case Label::Aab_Aab::a01b01_a2b2:			// Aa01, Ab2, Ab01
+				return this->filter(label, 3, &A1, nullptr, &A3, &A2);
+			case Label::Aab_Aab::a01b2_a2b01:			// Aa01, Ab01, Aa2
+				return this->filter(label, 3, &A1, &A3, &A2, nullptr);
+			default:
+				throw std::invalid_argument("label "+Label_Tools::get_name(label)+" error in "+std::string(__FILE__)+" line "+std::to_string(__LINE__));
+		}
+	}
+	virtual bool filter_for32(const Label::ab_ab &label, const TAC &A1, const TA &A2, const TAC &A3) const override
+	{
+		if(this->filter_next->filter_for32(label, A1, A2, A3))	return true;
+		// a01b01_a01b2:  Ab01, Aa01, Aa2
+		return this->filter(label, 3, &A2, &A3, &A1, nullptr);
+	}
+	virtual bool filter_for32(const Label::ab_ab &label, const TAC &A1, const TAC &A2, const TAC &A3) const override
+	{
+		if(this->filter_next->filter_for32(label, A1, A2, A3))	return true;
+		// a01b01_a01b01:  Aa2, Ab01, Ab2
+		return this->filter(label, 3, nullptr, &A1, &A2, &A3);
+	}
+
+	// sum of all threads
+	std::unordered_map<Label::ab_ab, Statistics> get_statistics() const
+	{
+		std::unordered_map<Label::ab_ab, Statistics> stats;
+		for(const auto &stats_tmp : this->stats_thread)
+			for(const auto &stat_tmp : stats_tmp)
+			{
+				Statistics &stat = stats[stat_tmp.first];
+				for(std::size_t level=0; level<stat.n_check.size(); ++level)
+				{
+					stat.n_check[level] += stat_tmp.second.n_check[level];
+					stat.n_skip [level] += stat_tmp.second.n_skip [level];
+				}
+			}
+		return stats;
+	}
+
+public:		// private:
+	std::shared_ptr<Filter_Atom<TA,TAC>> filter_next;
+	const std::unordered_map<Label::ab_ab, Tdata_real> &threshold;
+	const TC &period;
+	std::array<const Data_Pack<TA,TC,Tdata>*, Label::array_ab.size()> data_packs;		// data_packs[label]
+	mutable std::vector<std::unordered_map<Label::ab_ab, Statistics>> stats_thread;		// stats_thread[thread][label]
+
+	// nullptr for atoms not fixed
+	bool filter(
+		const Label::ab_ab &label, const std::size_t level,
+		const TA *Aa01, const TAC *Aa2, const TAC *Ab01, const TAC *Ab2) const
+	{
+		const auto ptr_threshold = this->threshold.find(label);
+		if(ptr_threshold==this->threshold.end())
+			return false;
+
+		Statistics &stat = this->stats_thread[omp_get_thread_num()][label];
+		++stat.n_check[level];
+
+		// D_result has atom Aa01 and sums over Aa2 if a2 in label, else has Aa2 and sums over Aa01. Same for b.
+		const std::array<Label::ab,2> labels_ab = Label_Tools::split(label);
+		const bool flag_sum_a2 = std::any_of(labels_ab.begin(), labels_ab.end(), [](const Label::ab &label_ab){ return Label_Tools::get_a(label_ab)==2; });
+		const bool flag_sum_b2 = std::any_of(labels_ab.begin(), labels_ab.end(), [](const Label::ab &label_ab){ return Label_Tools::get_b(label_ab)==2; });
+
+		Tdata_real uplimit = this->get_norm_sum(Label::ab::a, Aa01, Aa2, flag_sum_a2)
+		                   * this->get_norm_sum(Label::ab::b, Ab01, Ab2, flag_sum_b2);
+		for(const Label::ab &label_ab : labels_ab)
+		{
+			const TAC *Ab = (Label_Tools::get_b(label_ab)==2) ? Ab2 : Ab01;
+			if(Label_Tools::get_a(label_ab)==2)
+				uplimit *= this->get_norm(label_ab, Aa2, Ab);
+			else
+				uplimit *= this->get_norm(label_ab, Aa01, Ab);
+		}
+
+		if(uplimit < ptr_threshold->second)
+		{
+			++stat.n_skip[level];
+			return true;
+		}
+		return false;
+	}
+
+	// same key as LRI_Cal_Tools::get_Ds_ab()
+	Tdata_real get_norm(const Label::ab &label, const TA *A0, const TAC *A1) const
+	{
+		const Data_Pack<TA,TC,Tdata> *data_pack = this->data_packs[static_cast<std::size_t>(label)];
+		assert(data_pack);
+		if(A0 && A1)	return Global_Func::find(data_pack->Ds_ab_norm, *A0, *A1);
+		if(A0)			return Global_Func::find(data_pack->Ds_ab_norm_max0, *A0);
+		if(A1)			return Global_Func::find(data_pack->Ds_ab_norm_max1, A1->first);
+		return data_pack->Ds_ab_norm_max;
+	}
+	Tdata_real get_norm(const Label::ab &label, const TAC *A0, const TAC *A1) const
+	{
+		using namespace Array_Operator;
+		const Data_Pack<TA,TC,Tdata> *data_pack = this->data_packs[static_cast<std::size_t>(label)];
+		assert(data_pack);
+		if(A0 && A1)	return Global_Func::find(data_pack->Ds_ab_norm, A0->first, TAC{A1->first, (A1->second-A0->second)%this->period});
+		if(A0)			return Global_Func::find(data_pack->Ds_ab_norm_max0, A0->first);
+		if(A1)			return Global_Func::find(data_pack->Ds_ab_norm_max1, A1->first);
+		return data_pack->Ds_ab_norm_max;
+	}
+
+	// sum of norms over A1 if flag_sum1, else over A0. The other atom is fixed, or the max is bounded by the sum of all.
+	Tdata_real get_norm_sum(const Label::ab &label, const TA *A0, const TAC *A1, const bool flag_sum1) const
+	{
+		return this->get_norm_sum(label, A0, A1 ? &A1->first : nullptr, flag_sum1);
+	}
+	Tdata_real get_norm_sum(const Label::ab &label, const TAC *A0, const TAC *A1, const bool flag_sum1) const
+	{
+		return this->get_norm_sum(label, A0 ? &A0->first : nullptr, A1 ? &A1->first : nullptr, flag_sum1);
+	}
+	Tdata_real get_norm_sum(const Label::ab &label, const TA *A0, const TA *A1, const bool flag_sum1) const
+	{
+		const Data_Pack<TA,TC,Tdata> *data_pack = this->data_packs[static_cast<std::size_t>(label)];
+		assert(data_pack);
+		if(flag_sum1 && A0)		return Global_Func::find(data_pack->Ds_ab_norm_sum0, *A0);
+		if(!flag_sum1 && A1)	return Global_Func::find(data_pack->Ds_ab_norm_sum1, *A1);
+		return data_pack->Ds_ab_norm_sum;
+	}
+};
+
+}
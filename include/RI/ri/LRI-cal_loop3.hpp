@@ -9,8 +9,13 @@
 #include "LRI_Cal_Aux.h"
 #include "../global/Array_Operator.h"
 #include "../global/Tensor_Multiply.h"
+#include "../global/Tensor_Multiply_Batch.h"
+#include "../global/Tensor_Multiply_Accumulate.h"
+#include "../global/Tensor_Pool.h"
+#include "../global/Map_Operator.h"
 
 #include <omp.h>
+#include <memory>
 #ifdef __MKL_RI
 #include <mkl_service.h>
 #endif
@@ -19,18 +24,87 @@ namespace RI
 {
 
 template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+template<typename Tdata_result>
 void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 	const std::vector<Label::ab_ab> &labels,
-	std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_result,
-	const double fac_add_Ds)
+	std::map<TA, std::map<TAC, Tensor<Tdata_result>>> &Ds_result,
+	const double fac_add_Ds,
+	const std::map<std::string, double> &para_in)
 {
 	using namespace Array_Operator;
 
+	const std::map<std::string, double> para_default = {
+		{"flag_gemm_batch", false},
+		{"flag_tensor_pool", false},
+		{"flag_add_Ds_owner", false},
+		{"flag_sort_tasks", false},
+		{"flag_record_time", false},
+		{"flag_order_a01b01_a01b01", false}};
+	const std::map<std::string, double> para = Map_Operator::cover(para_default, para_in);
+	const bool flag_gemm_batch = para.at("flag_gemm_batch");
+	const bool flag_tensor_pool = para.at("flag_tensor_pool");
+	const bool flag_add_Ds_owner = para.at("flag_add_Ds_owner");
+	const bool flag_sort_tasks = para.at("flag_sort_tasks");
+	const bool flag_record_time = para.at("flag_record_time") || this->flag_rebalance;
+	const bool flag_order_a01b01_a01b01 = para.at("flag_order_a01b01_a01b01");
+
+	// labels with all tensors set are calculated first, during the communication of set_tensors_map2_async()
+	if(!this->sets_async.empty())
+	{
+		std::vector<Label::ab_ab> labels_ready, labels_async;
+		for(const Label::ab_ab &label : labels)
+			(this->judge_async(label) ? labels_async : labels_ready).push_back(label);
+		if(!labels_ready.empty() && !labels_async.empty())
+		{
+			std::map<std::string, double> para_split = para;
+			para_split["flag_record_time"] = flag_record_time;
+			const bool flag_rebalance = this->flag_rebalance;
+			this->flag_rebalance = false;		// rebalance() communicates, so after all waited
+
+			this->cal_loop3(labels_ready, Ds_result, fac_add_Ds, para_split);
+			const std::map<TA,double> time_atoms_ready = std::move(this->time_atoms);
+			this->wait_tensors_map2();
+			this->cal_loop3(labels_async, Ds_result, fac_add_Ds, para_split);
+			for(const auto &time_atom : time_atoms_ready)
+				this->time_atoms[time_atom.first] += time_atom.second;
+
+			this->flag_rebalance = flag_rebalance;
+			if(this->flag_rebalance)
+				this->rebalance();
+			return;
+		}
+		else if(!labels_async.empty())
+		{
+			this->wait_tensors_map2();
+		}
+	}
+
+	// Ds_ab may have been changed directly after set_tensors_map2()
+	for(auto &data_pack : this->data_pool)
+		if(!data_pack.second.Ds_ab_disk)
+			data_pack.second.Ds_ab_frozen = Tensors_Map2_Frozen<TA,TAC,Tdata>(data_pack.second.Ds_ab);
+
 	const Data_Pack_Wrapper<TA,TC,Tdata> data_wrapper(this->data_pool, this->data_ab_name);
 	const LRI_Cal_Tools<TA,TC,Tdata> tools(this->period, this->data_pool, this->data_ab_name);
 
-	std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_a_transpose, Ds_b_transpose;
-	std::tie(Ds_a_transpose, Ds_b_transpose) = tools.cal_Ds_transpose(labels);
+	const std::shared_ptr<Filter_Atom_CS<TA,TC,Tdata>> filter_atom_cs
+		= this->threshold_cs.empty()
+		? nullptr
+		: std::make_shared<Filter_Atom_CS<TA,TC,Tdata>>(this->filter_atom, this->threshold_cs, this->period, this->data_pool, this->data_ab_name);
+	const std::shared_ptr<Filter_Atom<TA,TAC>> filter_atom
+		= filter_atom_cs
+		? filter_atom_cs
+		: this->filter_atom;
+
+	const std::array<std::map<TA,std::size_t>,2> sizes_a = LRI_Cal_Aux::cal_atom_sizes(data_wrapper(Label::ab::a).Ds_ab);		// sizes_a[0][Aa01], sizes_a[1][Aa2]
+	const std::array<std::map<TA,std::size_t>,2> sizes_b = LRI_Cal_Aux::cal_atom_sizes(data_wrapper(Label::ab::b).Ds_ab);		// sizes_b[0][Ab01], sizes_b[1][Ab2]
+
+	const std::array<bool,2> flags_transpose = tools.judge_Ds_transpose(labels, flag_order_a01b01_a01b01);
+	const std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_transpose_empty;
+	const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_a_transpose
+		= flags_transpose[0] ? this->get_Ds_ab_transpose(Label::ab::a) : Ds_transpose_empty;
+	const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_b_transpose
+		= flags_transpose[1] ? this->get_Ds_ab_transpose(Label::ab::b) : Ds_transpose_empty;
 
   #ifdef __MKL_RI
 	const std::size_t mkl_threads = mkl_get_max_threads();
@@ -39,9 +113,20 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 
 	std::map<TA, omp_lock_t> lock_Ds_result_add_map = LRI_Cal_Aux::init_lock_result(labels, this->parallel->list_A, Ds_result);
 
+	this->tensor_pools = std::vector<Tensor_Pool<Tdata>>(omp_get_max_threads());
+
+	std::vector<std::map<TA, std::map<TAC, Tensor<Tdata>>>> Ds_result_threads(omp_get_max_threads());
+
+	this->time_atoms.clear();
+
 	#pragma omp parallel
 	{
-		std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_result_thread;
+		std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_result_thread = Ds_result_threads[omp_get_thread_num()];
+		Gemm_Batch<Tdata> gemm_batch;
+		LRI_Cal_Aux::Task_Timer<TA> task_timer;
+		std::unique_ptr<typename Tensor_Pool<Tdata>::Scope> tensor_pool_scope;
+		if(flag_tensor_pool)
+			tensor_pool_scope.reset(new typename Tensor_Pool<Tdata>::Scope(this->tensor_pools[omp_get_thread_num()]));
 
 		for(const Label::ab_ab &label : labels)
 		{
@@ -69,53 +154,101 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 					const std::vector<TAC> &list_Ab2 =
 						list_Ab2_Db;
 
-					for(const TAC &Aa2 : list_Aa2)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Aa2, list_Ab01, sizes_a[1], sizes_b[0], flag_sort_tasks,
+						[&](const TAC &Aa2){ return filter_atom->filter_for1(label,Aa2); });
+					std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
+					const auto add_Ds_fixed = [&](const TAC &Aa2)
 					{
-						if(this->filter_atom->filter_for1(label,Aa2))	continue;
-						std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
-
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ib01=0; ib01<list_Ab01.size(); ++ib01)
+						if(!Ds_result_fixed.empty())
+							LRI_Cal_Aux::add_Ds(LRI_Cal_Aux::Ds_translate(std::move(Ds_result_fixed), Aa2.second, this->period),
+												Ds_result_thread[Aa2.first]);
+						Ds_result_fixed.clear();
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
+
+					std::size_t ia2_fixed = list_Aa2.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ia2_fixed)
+						{
+							if(ia2_fixed!=list_Aa2.size())
+								add_Ds_fixed(list_Aa2[ia2_fixed]);
+							ia2_fixed = tasks[itask][0];
+						}
+						const TAC &Aa2 = list_Aa2[tasks[itask][0]];
+						const TAC &Ab01 = list_Ab01[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Aa2, Ab01);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Aa2,Ab01))	continue;
+						// D_mul = D_a * D_a0b0 * D_a1b1
+						// order 0: a2b0b1 = a0a1a2 * a0b0 * a1b1
+						// order 1: a2b1b0 = a1a0a2 * a1b1 * a0b0, if cheaper for the shapes of this task and flag_order_a01b01_a01b01
+						std::vector<std::array<const Tensor<Tdata>*,4>> Ds_factor;		// {D_a, D_a_transpose, D_a0b0, D_a1b1}
+						std::array<double,2> costs = {0.0, 0.0};
+						for(const TA &Aa01 : list_Aa01)
 						{
-							const TAC &Ab01 = list_Ab01[ib01];
-							if(this->filter_atom->filter_for2(label,Aa2,Ab01))	continue;
-							// D_mul = D_a * D_a0b0 * D_a1b1
-							Tensor<Tdata> D_mul;
-							for(const TA &Aa01 : list_Aa01)
+							if(filter_atom->filter_for31(label,Aa2,Ab01,Aa01))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							const Tensor<Tdata> &D_a0b0 = tools.get_Ds_ab(Label::ab::a0b0, Aa01, Ab01);
+							if(D_a0b0.empty())	continue;
+							const Tensor<Tdata> &D_a1b1 = tools.get_Ds_ab(Label::ab::a1b1, Aa01, Ab01);
+							if(D_a1b1.empty())	continue;
+							const Tensor<Tdata>* const D_a_transpose = flag_order_a01b01_a01b01 ? &tools.get_Ds_ab_transpose(Label::ab::a, Ds_a_transpose, Aa01, Aa2) : nullptr;
+							Ds_factor.push_back({&D_a, D_a_transpose, &D_a0b0, &D_a1b1});
+							if(flag_order_a01b01_a01b01)
 							{
-								if(this->filter_atom->filter_for31(label,Aa2,Ab01,Aa01))	continue;
-								const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								const Tensor<Tdata> &D_a0b0 = tools.get_Ds_ab(Label::ab::a0b0, Aa01, Ab01);
-								if(D_a0b0.empty())	continue;
-								const Tensor<Tdata> &D_a1b1 = tools.get_Ds_ab(Label::ab::a1b1, Aa01, Ab01);
-								if(D_a1b1.empty())	continue;
+								costs[0] += LRI_Cal_Aux::cost_x2y1z1_abx2_ay1_bz1(D_a.shape[0], D_a.shape[1], D_a.shape[2], D_a0b0.shape[1], D_a1b1.shape[1]);
+								costs[1] += LRI_Cal_Aux::cost_x2y1z1_abx2_ay1_bz1(D_a.shape[1], D_a.shape[0], D_a.shape[2], D_a1b1.shape[1], D_a0b0.shape[1]);
+							}
+						}
+						const bool flag_order1 = costs[1] < costs[0];
 
+						Tensor<Tdata> D_mul;
+						for(const std::array<const Tensor<Tdata>*,4> &D_factor : Ds_factor)
+						{
+							if(!flag_order1)
+							{
 								// a1a2b0 = a0a1a2 * a0b0
-								const Tensor<Tdata> D_tmp1 = Tensor_Multiply::x1x2y1_ax1x2_ay1(D_a, D_a0b0);
+								const Tensor<Tdata> D_tmp1 = Tensor_Multiply::x1x2y1_ax1x2_ay1(*D_factor[0], *D_factor[2]);
 								// a2b0b1 = a1a2b0 * a1b1
-								Tensor<Tdata> D_tmp2 = Tensor_Multiply::x1x2y1_ax1x2_ay1(D_tmp1, D_a1b1);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp2), D_mul);
+								Tensor_Multiply::x1x2y1_ax1x2_ay1(D_tmp1, *D_factor[3], D_mul, Tdata(1.0), Tdata(1.0));
 							}
-							if(D_mul.empty())	continue;
-
-							// D_result = D_mul * D_b
-							for(const TAC &Ab2 : list_Ab2)
+							else
 							{
-								if(this->filter_atom->filter_for32(label,Aa2,Ab01,Ab2))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-								// a2b2 = a2b0b1 * b0b1b2
-								Tensor<Tdata> D_tmp3 = Tensor_Multiply::x0y2_x0ab_aby2(D_mul, D_b);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp3), Ds_result_fixed[Ab2]);
+								// a0a2b1 = a1a0a2 * a1b1
+								const Tensor<Tdata> D_tmp1 = Tensor_Multiply::x1x2y1_ax1x2_ay1(*D_factor[1], *D_factor[3]);
+								// a2b1b0 = a0a2b1 * a0b0
+								Tensor_Multiply::x1x2y1_ax1x2_ay1(D_tmp1, *D_factor[2], D_mul, Tdata(1.0), Tdata(1.0));
 							}
-						} // end for Ab01
+						}
+						if(D_mul.empty())	continue;
 
-						if(!Ds_result_fixed.empty())
-							LRI_Cal_Aux::add_Ds(LRI_Cal_Aux::Ds_translate(std::move(Ds_result_fixed), Aa2.second, this->period),
-												Ds_result_thread[Aa2.first]);
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Ab2
+						// D_result = D_mul * D_b
+						for(const TAC &Ab2 : list_Ab2)
+						{
+							if(filter_atom->filter_for32(label,Aa2,Ab01,Ab2))	continue;
+							// a2b2 = a2b0b1 * b0b1b2, or a2b2 = a2b1b0 * b1b0b2 in order 1
+							const Tensor<Tdata> &D_b
+								= flag_order1
+								? tools.get_Ds_ab_transpose(Label::ab::b, Ds_b_transpose, Ab01.first, TAC{Ab2.first, (Ab2.second-Ab01.second)%this->period})
+								: tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+							if(flag_gemm_batch)
+								Tensor_Multiply::x0y2_x0ab_aby2(D_mul, D_b, Ds_result_fixed[Ab2], gemm_batch);
+							else
+							{
+								Tensor_Multiply::x0y2_x0ab_aby2(D_mul, D_b, Ds_result_fixed[Ab2], Tdata(1.0), Tdata(1.0));
+							}
+						}
+						gemm_batch.execute();
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ia2_fixed!=list_Aa2.size())
+						add_Ds_fixed(list_Aa2[ia2_fixed]);
 				} break; // end case a0b0_a1b1
 
 				case Label::ab_ab::a0b1_a1b0:
@@ -133,53 +266,101 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 					const std::vector<TAC> &list_Ab2 =
 						list_Ab2_Db;
 
-					for(const TAC &Aa2 : list_Aa2)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Aa2, list_Ab01, sizes_a[1], sizes_b[0], flag_sort_tasks,
+						[&](const TAC &Aa2){ return filter_atom->filter_for1(label,Aa2); });
+					std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
+					const auto add_Ds_fixed = [&](const TAC &Aa2)
 					{
-						if(this->filter_atom->filter_for1(label,Aa2))	continue;
-						std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
-
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ib01=0; ib01<list_Ab01.size(); ++ib01)
+						if(!Ds_result_fixed.empty())
+							LRI_Cal_Aux::add_Ds(LRI_Cal_Aux::Ds_translate(std::move(Ds_result_fixed), Aa2.second, this->period),
+												Ds_result_thread[Aa2.first]);
+						Ds_result_fixed.clear();
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
+
+					std::size_t ia2_fixed = list_Aa2.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ia2_fixed)
 						{
-							const TAC &Ab01 = list_Ab01[ib01];
-							if(this->filter_atom->filter_for2(label,Aa2,Ab01))	continue;
-							// D_mul = D_a * D_a0b1 * D_a1b0
-							Tensor<Tdata> D_mul;
-							for(const TA &Aa01 : list_Aa01)
+							if(ia2_fixed!=list_Aa2.size())
+								add_Ds_fixed(list_Aa2[ia2_fixed]);
+							ia2_fixed = tasks[itask][0];
+						}
+						const TAC &Aa2 = list_Aa2[tasks[itask][0]];
+						const TAC &Ab01 = list_Ab01[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Aa2, Ab01);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Aa2,Ab01))	continue;
+						// D_mul = D_a * D_a0b1 * D_a1b0
+						// order 0: a2b0b1 = a1a0a2 * a1b0 * a0b1
+						// order 1: a2b1b0 = a0a1a2 * a0b1 * a1b0, if cheaper for the shapes of this task and flag_order_a01b01_a01b01
+						std::vector<std::array<const Tensor<Tdata>*,4>> Ds_factor;		// {D_a_transpose, D_a, D_a0b1, D_a1b0}
+						std::array<double,2> costs = {0.0, 0.0};
+						for(const TA &Aa01 : list_Aa01)
+						{
+							if(filter_atom->filter_for31(label,Aa2,Ab01,Aa01))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab_transpose(Label::ab::a, Ds_a_transpose, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							const Tensor<Tdata> &D_a0b1 = tools.get_Ds_ab(Label::ab::a0b1, Aa01, Ab01);
+							if(D_a0b1.empty())	continue;
+							const Tensor<Tdata> &D_a1b0 = tools.get_Ds_ab(Label::ab::a1b0, Aa01, Ab01);
+							if(D_a1b0.empty())	continue;
+							const Tensor<Tdata>* const D_a_origin = flag_order_a01b01_a01b01 ? &tools.get_Ds_ab(Label::ab::a, Aa01, Aa2) : nullptr;
+							Ds_factor.push_back({&D_a, D_a_origin, &D_a0b1, &D_a1b0});
+							if(flag_order_a01b01_a01b01)
 							{
-								if(this->filter_atom->filter_for31(label,Aa2,Ab01,Aa01))	continue;
-								const Tensor<Tdata> &D_a = Global_Func::find(Ds_a_transpose, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								const Tensor<Tdata> &D_a0b1 = tools.get_Ds_ab(Label::ab::a0b1, Aa01, Ab01);
-								if(D_a0b1.empty())	continue;
-								const Tensor<Tdata> &D_a1b0 = tools.get_Ds_ab(Label::ab::a1b0, Aa01, Ab01);
-								if(D_a1b0.empty())	continue;
+								costs[0] += LRI_Cal_Aux::cost_x2y1z1_abx2_ay1_bz1(D_a.shape[0], D_a.shape[1], D_a.shape[2], D_a1b0.shape[1], D_a0b1.shape[1]);
+								costs[1] += LRI_Cal_Aux::cost_x2y1z1_abx2_ay1_bz1(D_a.shape[1], D_a.shape[0], D_a.shape[2], D_a0b1.shape[1], D_a1b0.shape[1]);
+							}
+						}
+						const bool flag_order1 = costs[1] < costs[0];
 
+						Tensor<Tdata> D_mul;
+						for(const std::array<const Tensor<Tdata>*,4> &D_factor : Ds_factor)
+						{
+							if(!flag_order1)
+							{
 								// a0a2b0 = a1a0a2 * a1b0
-								const Tensor<Tdata> D_tmp1 = Tensor_Multiply::x1x2y1_ax1x2_ay1(D_a, D_a1b0);
+								const Tensor<Tdata> D_tmp1 = Tensor_Multiply::x1x2y1_ax1x2_ay1(*D_factor[0], *D_factor[3]);
 								// a2b0b1 = a0a2b0 * a0b1
-								Tensor<Tdata> D_tmp2 = Tensor_Multiply::x1x2y1_ax1x2_ay1(D_tmp1, D_a0b1);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp2), D_mul);
+								Tensor_Multiply::x1x2y1_ax1x2_ay1(D_tmp1, *D_factor[2], D_mul, Tdata(1.0), Tdata(1.0));
 							}
-							if(D_mul.empty())	continue;
-
-							// D_result = D_mul * D_b
-							for(const TAC &Ab2 : list_Ab2)
+							else
 							{
-								if(this->filter_atom->filter_for32(label,Aa2,Ab01,Ab2))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-								// a2b2 = a2b0b1 * b0b1b2
-								Tensor<Tdata> D_tmp3 = Tensor_Multiply::x0y2_x0ab_aby2(D_mul, D_b);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp3), Ds_result_fixed[Ab2]);
+								// a1a2b1 = a0a1a2 * a0b1
+								const Tensor<Tdata> D_tmp1 = Tensor_Multiply::x1x2y1_ax1x2_ay1(*D_factor[1], *D_factor[2]);
+								// a2b1b0 = a1a2b1 * a1b0
+								Tensor_Multiply::x1x2y1_ax1x2_ay1(D_tmp1, *D_factor[3], D_mul, Tdata(1.0), Tdata(1.0));
 							}
-						} // end for Ab01
+						}
+						if(D_mul.empty())	continue;
 
-						if(!Ds_result_fixed.empty())
-							LRI_Cal_Aux::add_Ds(LRI_Cal_Aux::Ds_translate(std::move(Ds_result_fixed), Aa2.second, this->period),
-												Ds_result_thread[Aa2.first]);
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Ab2
+						// D_result = D_mul * D_b
+						for(const TAC &Ab2 : list_Ab2)
+						{
+							if(filter_atom->filter_for32(label,Aa2,Ab01,Ab2))	continue;
+							// a2b2 = a2b0b1 * b0b1b2, or a2b2 = a2b1b0 * b1b0b2 in order 1
+							const Tensor<Tdata> &D_b
+								= flag_order1
+								? tools.get_Ds_ab_transpose(Label::ab::b, Ds_b_transpose, Ab01.first, TAC{Ab2.first, (Ab2.second-Ab01.second)%this->period})
+								: tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+							if(flag_gemm_batch)
+								Tensor_Multiply::x0y2_x0ab_aby2(D_mul, D_b, Ds_result_fixed[Ab2], gemm_batch);
+							else
+							{
+								Tensor_Multiply::x0y2_x0ab_aby2(D_mul, D_b, Ds_result_fixed[Ab2], Tdata(1.0), Tdata(1.0));
+							}
+						}
+						gemm_batch.execute();
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ia2_fixed!=list_Aa2.size())
+						add_Ds_fixed(list_Aa2[ia2_fixed]);
 				} break; // end case a0b1_a1b0
 
 			  // Aab_Aab::a01b01_a01b2
@@ -199,53 +380,75 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 						list_Ab2_Db,
 						data_wrapper(Label::ab::a1b2).index_Ds_ab[0]);
 
-					for(const TAC &Ab01 : list_Ab01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Ab01, list_Aa01, sizes_b[0], sizes_a[0], flag_sort_tasks,
+						[&](const TAC &Ab01){ return filter_atom->filter_for1(label,Ab01); });
+					std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
+					const auto add_Ds_fixed = [&](const TAC &Ab01)
 					{
-						if(this->filter_atom->filter_for1(label,Ab01))	continue;
-						std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
-
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ia01=0; ia01<list_Aa01.size(); ++ia01)
-						{
-							const TA &Aa01 = list_Aa01[ia01];
-							if(this->filter_atom->filter_for2(label,Ab01,Aa01))	continue;
-							const Tensor<Tdata> &D_a0b0 = tools.get_Ds_ab(Label::ab::a0b0, Aa01, Ab01);
-							if(D_a0b0.empty())	continue;
-							// D_mul = D_b * D_a1b2
-							Tensor<Tdata> D_mul;
-							for(const TAC &Ab2 : list_Ab2)
-							{
-								if(this->filter_atom->filter_for31(label,Ab01,Aa01,Ab2))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-								const Tensor<Tdata> &D_a1b2 = tools.get_Ds_ab(Label::ab::a1b2, Aa01, Ab2);
-								if(D_a1b2.empty())	continue;
-
-								// b0b1a1 = b0b1b2 * a1b2
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x0x1y0_x0x1a_y0a(D_b, D_a1b2);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul);
-							}
-							if(D_mul.empty())	continue;
-
-							// D_result = D_mul * D_a * D_a0b0
-							for(const TAC &Aa2 : list_Aa2)
-							{
-								if(this->filter_atom->filter_for32(label,Ab01,Aa01,Aa2))	continue;
-								const Tensor<Tdata> &D_a = Global_Func::find(Ds_a_transpose, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								// b1a1a0 = b0b1a1 * a0b0
-								const Tensor<Tdata> D_tmp2 = Tensor_Multiply::x1x2y0_ax1x2_y0a(D_mul, D_a0b0);
-								// a2b1 = a1a0a2 * b1a1a0
-								Tensor<Tdata> D_tmp3 = Tensor_Multiply::x2y0_abx2_y0ab(D_a, D_tmp2);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp3), Ds_result_fixed[Aa2]);
-							}
-						} // end for Aa01
-
 						if(!Ds_result_fixed.empty())
 							LRI_Cal_Aux::add_Ds(LRI_Cal_Aux::Ds_exchange(std::move(Ds_result_fixed), Ab01, this->period),
 												Ds_result_thread);
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Ab01
+						Ds_result_fixed.clear();
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
+
+					std::size_t ib01_fixed = list_Ab01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ib01_fixed)
+						{
+							if(ib01_fixed!=list_Ab01.size())
+								add_Ds_fixed(list_Ab01[ib01_fixed]);
+							ib01_fixed = tasks[itask][0];
+						}
+						const TAC &Ab01 = list_Ab01[tasks[itask][0]];
+						const TA &Aa01 = list_Aa01[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Ab01, Aa01);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Ab01,Aa01))	continue;
+						const Tensor<Tdata> &D_a0b0 = tools.get_Ds_ab(Label::ab::a0b0, Aa01, Ab01);
+						if(D_a0b0.empty())	continue;
+						// D_mul = D_b * D_a1b2
+						Tensor<Tdata> D_mul;
+						for(const TAC &Ab2 : list_Ab2)
+						{
+							if(filter_atom->filter_for31(label,Ab01,Aa01,Ab2))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+							const Tensor<Tdata> &D_a1b2 = tools.get_Ds_ab(Label::ab::a1b2, Aa01, Ab2);
+							if(D_a1b2.empty())	continue;
+
+							// b0b1a1 = b0b1b2 * a1b2
+							Tensor_Multiply::x0x1y0_x0x1a_y0a(D_b, D_a1b2, D_mul, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul.empty())	continue;
+
+						// D_result = D_mul * D_a * D_a0b0
+						Tensor<Tdata> D_tmp2;
+						for(const TAC &Aa2 : list_Aa2)
+						{
+							if(filter_atom->filter_for32(label,Ab01,Aa01,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab_transpose(Label::ab::a, Ds_a_transpose, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							// b1a1a0 = b0b1a1 * a0b0
+							if(D_tmp2.empty())
+								D_tmp2 = Tensor_Multiply::x1x2y0_ax1x2_y0a(D_mul, D_a0b0);
+							// a2b1 = a1a0a2 * b1a1a0
+							if(flag_gemm_batch)
+								Tensor_Multiply::x2y0_abx2_y0ab(D_a, D_tmp2, Ds_result_fixed[Aa2], gemm_batch);
+							else
+							{
+								Tensor_Multiply::x2y0_abx2_y0ab(D_a, D_tmp2, Ds_result_fixed[Aa2], Tdata(1.0), Tdata(1.0));
+							}
+						}
+						gemm_batch.execute();
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ib01_fixed!=list_Ab01.size())
+						add_Ds_fixed(list_Ab01[ib01_fixed]);
 				} break; // end case a0b0_a1b2
 
 				case Label::ab_ab::a0b1_a1b2:
@@ -263,53 +466,75 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 						list_Ab2_Db,
 						data_wrapper(Label::ab::a1b2).index_Ds_ab[0]);
 
-					for(const TAC &Ab01 : list_Ab01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Ab01, list_Aa01, sizes_b[0], sizes_a[0], flag_sort_tasks,
+						[&](const TAC &Ab01){ return filter_atom->filter_for1(label,Ab01); });
+					std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
+					const auto add_Ds_fixed = [&](const TAC &Ab01)
 					{
-						if(this->filter_atom->filter_for1(label,Ab01))	continue;
-						std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
-
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ia01=0; ia01<list_Aa01.size(); ++ia01)
-						{
-							const TA &Aa01 = list_Aa01[ia01];
-							if(this->filter_atom->filter_for2(label,Ab01,Aa01))	continue;
-							const Tensor<Tdata> &D_a0b1 = tools.get_Ds_ab(Label::ab::a0b1, Aa01, Ab01);
-							if(D_a0b1.empty())	continue;
-							// D_mul = D_b * D_a1b2
-							Tensor<Tdata> D_mul;
-							for(const TAC &Ab2 : list_Ab2)
-							{
-								if(this->filter_atom->filter_for31(label,Ab01,Aa01,Ab2))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-								const Tensor<Tdata> &D_a1b2 = tools.get_Ds_ab(Label::ab::a1b2, Aa01, Ab2);
-								if(D_a1b2.empty())	continue;
-
-								// a1b0b1 = a1b2 * b0b1b2
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x0y0y1_x0a_y0y1a(D_a1b2, D_b);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul);
-							}
-							if(D_mul.empty())	continue;
-
-							// D_result = D_mul * D_a * D_a0b1
-							for(const TAC &Aa2 : list_Aa2)
-							{
-								if(this->filter_atom->filter_for32(label,Ab01,Aa01,Aa2))	continue;
-								const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								// a0a1b0 = a0b1 * a1b0b1
-								const Tensor<Tdata> D_tmp2 = Tensor_Multiply::x0y0y1_x0a_y0y1a(D_a0b1, D_mul);
-								// a2b0 = a0a1a2 * a0a1b0
-								Tensor<Tdata> D_tmp3 = Tensor_Multiply::x2y2_abx2_aby2(D_a, D_tmp2);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp3), Ds_result_fixed[Aa2]);
-							}
-						} // end for Aa01
-
 						if(!Ds_result_fixed.empty())
 							LRI_Cal_Aux::add_Ds(LRI_Cal_Aux::Ds_exchange(std::move(Ds_result_fixed), Ab01, this->period),
 												Ds_result_thread);
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Ab01
+						Ds_result_fixed.clear();
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
+
+					std::size_t ib01_fixed = list_Ab01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ib01_fixed)
+						{
+							if(ib01_fixed!=list_Ab01.size())
+								add_Ds_fixed(list_Ab01[ib01_fixed]);
+							ib01_fixed = tasks[itask][0];
+						}
+						const TAC &Ab01 = list_Ab01[tasks[itask][0]];
+						const TA &Aa01 = list_Aa01[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Ab01, Aa01);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Ab01,Aa01))	continue;
+						const Tensor<Tdata> &D_a0b1 = tools.get_Ds_ab(Label::ab::a0b1, Aa01, Ab01);
+						if(D_a0b1.empty())	continue;
+						// D_mul = D_b * D_a1b2
+						Tensor<Tdata> D_mul;
+						for(const TAC &Ab2 : list_Ab2)
+						{
+							if(filter_atom->filter_for31(label,Ab01,Aa01,Ab2))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+							const Tensor<Tdata> &D_a1b2 = tools.get_Ds_ab(Label::ab::a1b2, Aa01, Ab2);
+							if(D_a1b2.empty())	continue;
+
+							// a1b0b1 = a1b2 * b0b1b2
+							Tensor_Multiply::x0y0y1_x0a_y0y1a(D_a1b2, D_b, D_mul, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul.empty())	continue;
+
+						// D_result = D_mul * D_a * D_a0b1
+						Tensor<Tdata> D_tmp2;
+						for(const TAC &Aa2 : list_Aa2)
+						{
+							if(filter_atom->filter_for32(label,Ab01,Aa01,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							// a0a1b0 = a0b1 * a1b0b1
+							if(D_tmp2.empty())
+								D_tmp2 = Tensor_Multiply::x0y0y1_x0a_y0y1a(D_a0b1, D_mul);
+							// a2b0 = a0a1a2 * a0a1b0
+							if(flag_gemm_batch)
+								Tensor_Multiply::x2y2_abx2_aby2(D_a, D_tmp2, Ds_result_fixed[Aa2], gemm_batch);
+							else
+							{
+								Tensor_Multiply::x2y2_abx2_aby2(D_a, D_tmp2, Ds_result_fixed[Aa2], Tdata(1.0), Tdata(1.0));
+							}
+						}
+						gemm_batch.execute();
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ib01_fixed!=list_Ab01.size())
+						add_Ds_fixed(list_Ab01[ib01_fixed]);
 				} break; // end case a0b1_a1b2
 
 				case Label::ab_ab::a0b2_a1b0:
@@ -327,53 +552,75 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 						list_Ab2_Db,
 						data_wrapper(Label::ab::a0b2).index_Ds_ab[0]);
 
-					for(const TAC &Ab01 : list_Ab01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Ab01, list_Aa01, sizes_b[0], sizes_a[0], flag_sort_tasks,
+						[&](const TAC &Ab01){ return filter_atom->filter_for1(label,Ab01); });
+					std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
+					const auto add_Ds_fixed = [&](const TAC &Ab01)
 					{
-						if(this->filter_atom->filter_for1(label,Ab01))	continue;
-						std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
-
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ia01=0; ia01<list_Aa01.size(); ++ia01)
-						{
-							const TA &Aa01 = list_Aa01[ia01];
-							if(this->filter_atom->filter_for2(label,Ab01,Aa01))	continue;
-							const Tensor<Tdata> &D_a1b0 = tools.get_Ds_ab(Label::ab::a1b0, Aa01, Ab01);
-							if(D_a1b0.empty())	continue;
-							// D_mul = D_b * D_a0b2
-							Tensor<Tdata> D_mul;
-							for(const TAC &Ab2 : list_Ab2)
-							{
-								if(this->filter_atom->filter_for31(label,Ab01,Aa01,Ab2))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-								const Tensor<Tdata> &D_a0b2 = tools.get_Ds_ab(Label::ab::a0b2, Aa01, Ab2);
-								if(D_a0b2.empty())	continue;
-
-								// b0b1a0 = b0b1b2 * a0b2
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x0x1y0_x0x1a_y0a(D_b, D_a0b2);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul);
-							}
-							if(D_mul.empty())	continue;
-
-							// D_result = D_mul * D_a * D_a1b0
-							for(const TAC &Aa2 : list_Aa2)
-							{
-								if(this->filter_atom->filter_for32(label,Ab01,Aa01,Aa2))	continue;
-								const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								// b1a0a1 = b0b1a0 * a1b0
-								const Tensor<Tdata> D_tmp2 = Tensor_Multiply::x1x2y0_ax1x2_y0a(D_mul, D_a1b0);
-								// a2b1 = a0a1a2 * b1a0a1
-								Tensor<Tdata> D_tmp3 = Tensor_Multiply::x2y0_abx2_y0ab(D_a, D_tmp2);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp3), Ds_result_fixed[Aa2]);
-							}
-						} // end for Aa01
-
 						if(!Ds_result_fixed.empty())
 							LRI_Cal_Aux::add_Ds(LRI_Cal_Aux::Ds_exchange(std::move(Ds_result_fixed), Ab01, this->period),
 												Ds_result_thread);
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Ab01
+						Ds_result_fixed.clear();
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
+
+					std::size_t ib01_fixed = list_Ab01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ib01_fixed)
+						{
+							if(ib01_fixed!=list_Ab01.size())
+								add_Ds_fixed(list_Ab01[ib01_fixed]);
+							ib01_fixed = tasks[itask][0];
+						}
+						const TAC &Ab01 = list_Ab01[tasks[itask][0]];
+						const TA &Aa01 = list_Aa01[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Ab01, Aa01);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Ab01,Aa01))	continue;
+						const Tensor<Tdata> &D_a1b0 = tools.get_Ds_ab(Label::ab::a1b0, Aa01, Ab01);
+						if(D_a1b0.empty())	continue;
+						// D_mul = D_b * D_a0b2
+						Tensor<Tdata> D_mul;
+						for(const TAC &Ab2 : list_Ab2)
+						{
+							if(filter_atom->filter_for31(label,Ab01,Aa01,Ab2))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+							const Tensor<Tdata> &D_a0b2 = tools.get_Ds_ab(Label::ab::a0b2, Aa01, Ab2);
+							if(D_a0b2.empty())	continue;
+
+							// b0b1a0 = b0b1b2 * a0b2
+							Tensor_Multiply::x0x1y0_x0x1a_y0a(D_b, D_a0b2, D_mul, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul.empty())	continue;
+
+						// D_result = D_mul * D_a * D_a1b0
+						Tensor<Tdata> D_tmp2;
+						for(const TAC &Aa2 : list_Aa2)
+						{
+							if(filter_atom->filter_for32(label,Ab01,Aa01,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							// b1a0a1 = b0b1a0 * a1b0
+							if(D_tmp2.empty())
+								D_tmp2 = Tensor_Multiply::x1x2y0_ax1x2_y0a(D_mul, D_a1b0);
+							// a2b1 = a0a1a2 * b1a0a1
+							if(flag_gemm_batch)
+								Tensor_Multiply::x2y0_abx2_y0ab(D_a, D_tmp2, Ds_result_fixed[Aa2], gemm_batch);
+							else
+							{
+								Tensor_Multiply::x2y0_abx2_y0ab(D_a, D_tmp2, Ds_result_fixed[Aa2], Tdata(1.0), Tdata(1.0));
+							}
+						}
+						gemm_batch.execute();
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ib01_fixed!=list_Ab01.size())
+						add_Ds_fixed(list_Ab01[ib01_fixed]);
 				} break; // end case a0b2_a1b0
 
 				case Label::ab_ab::a0b2_a1b1:
@@ -391,53 +638,75 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 						list_Ab2_Db,
 						data_wrapper(Label::ab::a0b2).index_Ds_ab[0]);
 
-					for(const TAC &Ab01 : list_Ab01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Ab01, list_Aa01, sizes_b[0], sizes_a[0], flag_sort_tasks,
+						[&](const TAC &Ab01){ return filter_atom->filter_for1(label,Ab01); });
+					std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
+					const auto add_Ds_fixed = [&](const TAC &Ab01)
 					{
-						if(this->filter_atom->filter_for1(label,Ab01))	continue;
-						std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
-
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ia01=0; ia01<list_Aa01.size(); ++ia01)
-						{
-							const TA &Aa01 = list_Aa01[ia01];
-							if(this->filter_atom->filter_for2(label,Ab01,Aa01))	continue;
-							const Tensor<Tdata> &D_a1b1 = tools.get_Ds_ab(Label::ab::a1b1, Aa01, Ab01);
-							if(D_a1b1.empty())	continue;
-							// D_mul = D_b * D_a0b2
-							Tensor<Tdata> D_mul;
-							for(const TAC &Ab2 : list_Ab2)
-							{
-								if(this->filter_atom->filter_for31(label,Ab01,Aa01,Ab2))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-								const Tensor<Tdata> &D_a0b2 = tools.get_Ds_ab(Label::ab::a0b2, Aa01, Ab2);
-								if(D_a0b2.empty())	continue;
-
-								// a0b0b1 = a0b2 * b0b1b2
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x0y0y1_x0a_y0y1a(D_a0b2, D_b);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul);
-							}
-							if(D_mul.empty())	continue;
-
-							// D_result = D_mul * D_a * D_a1b1
-							for(const TAC &Aa2 : list_Aa2)
-							{
-								if(this->filter_atom->filter_for32(label,Ab01,Aa01,Aa2))	continue;
-								const Tensor<Tdata> &D_a = Global_Func::find(Ds_a_transpose, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								// a1a0b0 = a1b1 * a0b0b1
-								const Tensor<Tdata> D_tmp2 = Tensor_Multiply::x0y0y1_x0a_y0y1a(D_a1b1, D_mul);
-								// a2b0 = a1a0a2 * a1a0b0
-								Tensor<Tdata> D_tmp3 = Tensor_Multiply::x2y2_abx2_aby2(D_a, D_tmp2);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp3), Ds_result_fixed[Aa2]);
-							}
-						} // end for Aa01
-
 						if(!Ds_result_fixed.empty())
 							LRI_Cal_Aux::add_Ds(LRI_Cal_Aux::Ds_exchange(std::move(Ds_result_fixed), Ab01, this->period),
 												Ds_result_thread);
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Ab01
+						Ds_result_fixed.clear();
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
+
+					std::size_t ib01_fixed = list_Ab01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ib01_fixed)
+						{
+							if(ib01_fixed!=list_Ab01.size())
+								add_Ds_fixed(list_Ab01[ib01_fixed]);
+							ib01_fixed = tasks[itask][0];
+						}
+						const TAC &Ab01 = list_Ab01[tasks[itask][0]];
+						const TA &Aa01 = list_Aa01[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Ab01, Aa01);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Ab01,Aa01))	continue;
+						const Tensor<Tdata> &D_a1b1 = tools.get_Ds_ab(Label::ab::a1b1, Aa01, Ab01);
+						if(D_a1b1.empty())	continue;
+						// D_mul = D_b * D_a0b2
+						Tensor<Tdata> D_mul;
+						for(const TAC &Ab2 : list_Ab2)
+						{
+							if(filter_atom->filter_for31(label,Ab01,Aa01,Ab2))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+							const Tensor<Tdata> &D_a0b2 = tools.get_Ds_ab(Label::ab::a0b2, Aa01, Ab2);
+							if(D_a0b2.empty())	continue;
+
+							// a0b0b1 = a0b2 * b0b1b2
+							Tensor_Multiply::x0y0y1_x0a_y0y1a(D_a0b2, D_b, D_mul, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul.empty())	continue;
+
+						// D_result = D_mul * D_a * D_a1b1
+						Tensor<Tdata> D_tmp2;
+						for(const TAC &Aa2 : list_Aa2)
+						{
+							if(filter_atom->filter_for32(label,Ab01,Aa01,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab_transpose(Label::ab::a, Ds_a_transpose, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							// a1a0b0 = a1b1 * a0b0b1
+							if(D_tmp2.empty())
+								D_tmp2 = Tensor_Multiply::x0y0y1_x0a_y0y1a(D_a1b1, D_mul);
+							// a2b0 = a1a0a2 * a1a0b0
+							if(flag_gemm_batch)
+								Tensor_Multiply::x2y2_abx2_aby2(D_a, D_tmp2, Ds_result_fixed[Aa2], gemm_batch);
+							else
+							{
+								Tensor_Multiply::x2y2_abx2_aby2(D_a, D_tmp2, Ds_result_fixed[Aa2], Tdata(1.0), Tdata(1.0));
+							}
+						}
+						gemm_batch.execute();
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ib01_fixed!=list_Ab01.size())
+						add_Ds_fixed(list_Ab01[ib01_fixed]);
 				} break; // end case a0b2_a1b1
 
 			  // Aab_Aab::a01b01_a2b01
@@ -457,54 +726,76 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 					const std::vector<TAC> &list_Ab2 =
 						list_Ab2_Db;
 
-					for(const TA &Aa01 : list_Aa01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Aa01, list_Ab01, sizes_a[0], sizes_b[0], flag_sort_tasks,
+						[&](const TA &Aa01){ return filter_atom->filter_for1(label,Aa01); });
+					std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
+					const auto add_Ds_fixed = [&](const TA &Aa01)
 					{
-						if(this->filter_atom->filter_for1(label,Aa01))	continue;
-						std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
-
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ib01=0; ib01<list_Ab01.size(); ++ib01)
-						{
-							const TAC &Ab01 = list_Ab01[ib01];
-							if(this->filter_atom->filter_for2(label,Aa01,Ab01))	continue;
-							const Tensor<Tdata> &D_a0b0 = tools.get_Ds_ab(Label::ab::a0b0, Aa01, Ab01);
-							if(D_a0b0.empty())	continue;
-							// D_mul = D_a * D_a2b1
-							Tensor<Tdata> D_mul;
-							for(const TAC &Aa2 : list_Aa2)
-							{
-								if(this->filter_atom->filter_for31(label,Aa01,Ab01,Aa2))	continue;
-								const Tensor<Tdata> &D_a = Global_Func::find(Ds_a_transpose, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								const Tensor<Tdata> &D_a2b1 = tools.get_Ds_ab(Label::ab::a2b1, Aa2, Ab01);
-								if(D_a2b1.empty())	continue;
-
-								// b1a1a0 = a2b1 * a1a0a2
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b1, D_a);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul);
-							}
-							if(D_mul.empty())	continue;
-
-							// D_result = D_mul * D_a0b0 * D_b
-							for(const TAC &Ab2 : list_Ab2)
-							{
-								if(this->filter_atom->filter_for32(label,Aa01,Ab01,Ab2))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-
-								// b0b1a1 = a0b0 * b1a1a0
-								const Tensor<Tdata> D_tmp2 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a0b0, D_mul);
-								// a1b2 = b0b1a1 * b0b1b2
-								Tensor<Tdata> D_tmp3 = Tensor_Multiply::x2y2_abx2_aby2(D_tmp2, D_b);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp3), Ds_result_fixed[Ab2]);
-							}
-						} // end for Ab01
-
 						if(!Ds_result_fixed.empty())
 							LRI_Cal_Aux::add_Ds(std::move(Ds_result_fixed),
 												Ds_result_thread[Aa01]);
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Aa01
+						Ds_result_fixed.clear();
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
+
+					std::size_t ia01_fixed = list_Aa01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ia01_fixed)
+						{
+							if(ia01_fixed!=list_Aa01.size())
+								add_Ds_fixed(list_Aa01[ia01_fixed]);
+							ia01_fixed = tasks[itask][0];
+						}
+						const TA &Aa01 = list_Aa01[tasks[itask][0]];
+						const TAC &Ab01 = list_Ab01[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Aa01, Ab01);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Aa01,Ab01))	continue;
+						const Tensor<Tdata> &D_a0b0 = tools.get_Ds_ab(Label::ab::a0b0, Aa01, Ab01);
+						if(D_a0b0.empty())	continue;
+						// D_mul = D_a * D_a2b1
+						Tensor<Tdata> D_mul;
+						for(const TAC &Aa2 : list_Aa2)
+						{
+							if(filter_atom->filter_for31(label,Aa01,Ab01,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab_transpose(Label::ab::a, Ds_a_transpose, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							const Tensor<Tdata> &D_a2b1 = tools.get_Ds_ab(Label::ab::a2b1, Aa2, Ab01);
+							if(D_a2b1.empty())	continue;
+
+							// b1a1a0 = a2b1 * a1a0a2
+							Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b1, D_a, D_mul, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul.empty())	continue;
+
+						// D_result = D_mul * D_a0b0 * D_b
+						Tensor<Tdata> D_tmp2;
+						for(const TAC &Ab2 : list_Ab2)
+						{
+							if(filter_atom->filter_for32(label,Aa01,Ab01,Ab2))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+
+							// b0b1a1 = a0b0 * b1a1a0
+							if(D_tmp2.empty())
+								D_tmp2 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a0b0, D_mul);
+							// a1b2 = b0b1a1 * b0b1b2
+							if(flag_gemm_batch)
+								Tensor_Multiply::x2y2_abx2_aby2(D_tmp2, D_b, Ds_result_fixed[Ab2], gemm_batch);
+							else
+							{
+								Tensor_Multiply::x2y2_abx2_aby2(D_tmp2, D_b, Ds_result_fixed[Ab2], Tdata(1.0), Tdata(1.0));
+							}
+						}
+						gemm_batch.execute();
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ia01_fixed!=list_Aa01.size())
+						add_Ds_fixed(list_Aa01[ia01_fixed]);
 				} break; // end case a0b0_a2b1
 
 				case Label::ab_ab::a0b1_a2b0:
@@ -522,54 +813,76 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 					const std::vector<TAC> &list_Ab2 =
 						list_Ab2_Db;
 
-					for(const TA &Aa01 : list_Aa01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Aa01, list_Ab01, sizes_a[0], sizes_b[0], flag_sort_tasks,
+						[&](const TA &Aa01){ return filter_atom->filter_for1(label,Aa01); });
+					std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
+					const auto add_Ds_fixed = [&](const TA &Aa01)
 					{
-						if(this->filter_atom->filter_for1(label,Aa01))	continue;
-						std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
-
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ib01=0; ib01<list_Ab01.size(); ++ib01)
-						{
-							const TAC &Ab01 = list_Ab01[ib01];
-							if(this->filter_atom->filter_for2(label,Aa01,Ab01))	continue;
-							const Tensor<Tdata> &D_a0b1 = tools.get_Ds_ab(Label::ab::a0b1, Aa01, Ab01);
-							if(D_a0b1.empty())	continue;
-							// D_mul = D_a * D_a2b0
-							Tensor<Tdata> D_mul;
-							for(const TAC &Aa2 : list_Aa2)
-							{
-								if(this->filter_atom->filter_for31(label,Aa01,Ab01,Aa2))	continue;
-								const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								const Tensor<Tdata> &D_a2b0 = tools.get_Ds_ab(Label::ab::a2b0, Aa2, Ab01);
-								if(D_a2b0.empty())	continue;
-
-								// a0a1b0 = a0a1a2 * a2b0
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x0x1y1_x0x1a_ay1(D_a, D_a2b0);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul);
-							}
-							if(D_mul.empty())	continue;
-
-							// D_result = D_mul * D_a0b1 * D_b
-							for(const TAC &Ab2 : list_Ab2)
-							{
-								if(this->filter_atom->filter_for32(label,Aa01,Ab01,Ab2))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-
-								// a1b0b1 = a0a1b0 * a0b1
-								const Tensor<Tdata> D_tmp2 = Tensor_Multiply::x1x2y1_ax1x2_ay1(D_mul, D_a0b1);
-								// a1b2 = a1b0b1 * b0b1b2
-								Tensor<Tdata> D_tmp3 = Tensor_Multiply::x0y2_x0ab_aby2(D_tmp2, D_b);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp3), Ds_result_fixed[Ab2]);
-							}
-						} // end for Ab01
-
 						if(!Ds_result_fixed.empty())
 							LRI_Cal_Aux::add_Ds(std::move(Ds_result_fixed),
 												Ds_result_thread[Aa01]);
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Aa01
+						Ds_result_fixed.clear();
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
+
+					std::size_t ia01_fixed = list_Aa01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ia01_fixed)
+						{
+							if(ia01_fixed!=list_Aa01.size())
+								add_Ds_fixed(list_Aa01[ia01_fixed]);
+							ia01_fixed = tasks[itask][0];
+						}
+						const TA &Aa01 = list_Aa01[tasks[itask][0]];
+						const TAC &Ab01 = list_Ab01[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Aa01, Ab01);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Aa01,Ab01))	continue;
+						const Tensor<Tdata> &D_a0b1 = tools.get_Ds_ab(Label::ab::a0b1, Aa01, Ab01);
+						if(D_a0b1.empty())	continue;
+						// D_mul = D_a * D_a2b0
+						Tensor<Tdata> D_mul;
+						for(const TAC &Aa2 : list_Aa2)
+						{
+							if(filter_atom->filter_for31(label,Aa01,Ab01,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							const Tensor<Tdata> &D_a2b0 = tools.get_Ds_ab(Label::ab::a2b0, Aa2, Ab01);
+							if(D_a2b0.empty())	continue;
+
+							// a0a1b0 = a0a1a2 * a2b0
+							Tensor_Multiply::x0x1y1_x0x1a_ay1(D_a, D_a2b0, D_mul, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul.empty())	continue;
+
+						// D_result = D_mul * D_a0b1 * D_b
+						Tensor<Tdata> D_tmp2;
+						for(const TAC &Ab2 : list_Ab2)
+						{
+							if(filter_atom->filter_for32(label,Aa01,Ab01,Ab2))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+
+							// a1b0b1 = a0a1b0 * a0b1
+							if(D_tmp2.empty())
+								D_tmp2 = Tensor_Multiply::x1x2y1_ax1x2_ay1(D_mul, D_a0b1);
+							// a1b2 = a1b0b1 * b0b1b2
+							if(flag_gemm_batch)
+								Tensor_Multiply::x0y2_x0ab_aby2(D_tmp2, D_b, Ds_result_fixed[Ab2], gemm_batch);
+							else
+							{
+								Tensor_Multiply::x0y2_x0ab_aby2(D_tmp2, D_b, Ds_result_fixed[Ab2], Tdata(1.0), Tdata(1.0));
+							}
+						}
+						gemm_batch.execute();
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ia01_fixed!=list_Aa01.size())
+						add_Ds_fixed(list_Aa01[ia01_fixed]);
 				} break; // end case a0b1_a2b0
 
 				case Label::ab_ab::a1b0_a2b1:
@@ -587,54 +900,76 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 					const std::vector<TAC> &list_Ab2 =
 						list_Ab2_Db;
 
-					for(const TA &Aa01 : list_Aa01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Aa01, list_Ab01, sizes_a[0], sizes_b[0], flag_sort_tasks,
+						[&](const TA &Aa01){ return filter_atom->filter_for1(label,Aa01); });
+					std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
+					const auto add_Ds_fixed = [&](const TA &Aa01)
 					{
-						if(this->filter_atom->filter_for1(label,Aa01))	continue;
-						std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
-
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ib01=0; ib01<list_Ab01.size(); ++ib01)
-						{
-							const TAC &Ab01 = list_Ab01[ib01];
-							if(this->filter_atom->filter_for2(label,Aa01,Ab01))	continue;
-							const Tensor<Tdata> &D_a1b0 = tools.get_Ds_ab(Label::ab::a1b0, Aa01, Ab01);
-							if(D_a1b0.empty())	continue;
-							// D_mul = D_a * D_a2b1
-							Tensor<Tdata> D_mul;
-							for(const TAC &Aa2 : list_Aa2)
-							{
-								if(this->filter_atom->filter_for31(label,Aa01,Ab01,Aa2))	continue;
-								const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								const Tensor<Tdata> &D_a2b1 = tools.get_Ds_ab(Label::ab::a2b1, Aa2, Ab01);
-								if(D_a2b1.empty())	continue;
-
-								// b1a0a1 = a2b1 * a0a1a2
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b1, D_a);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul);
-							}
-							if(D_mul.empty())	continue;
-
-							// D_result = D_mul * D_a1b0 * D_b
-							for(const TAC &Ab2 : list_Ab2)
-							{
-								if(this->filter_atom->filter_for32(label,Aa01,Ab01,Ab2))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-
-								// b0b1a0 = a1b0 * b1a0a1
-								const Tensor<Tdata> D_tmp2 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a1b0, D_mul);
-								// a0b2 = b0b1a0 * b0b1b2
-								Tensor<Tdata> D_tmp3 = Tensor_Multiply::x2y2_abx2_aby2(D_tmp2, D_b);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp3), Ds_result_fixed[Ab2]);
-							}
-						} // end for Ab01
-
 						if(!Ds_result_fixed.empty())
 							LRI_Cal_Aux::add_Ds(std::move(Ds_result_fixed),
 												Ds_result_thread[Aa01]);
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Aa01
+						Ds_result_fixed.clear();
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
+
+					std::size_t ia01_fixed = list_Aa01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ia01_fixed)
+						{
+							if(ia01_fixed!=list_Aa01.size())
+								add_Ds_fixed(list_Aa01[ia01_fixed]);
+							ia01_fixed = tasks[itask][0];
+						}
+						const TA &Aa01 = list_Aa01[tasks[itask][0]];
+						const TAC &Ab01 = list_Ab01[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Aa01, Ab01);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Aa01,Ab01))	continue;
+						const Tensor<Tdata> &D_a1b0 = tools.get_Ds_ab(Label::ab::a1b0, Aa01, Ab01);
+						if(D_a1b0.empty())	continue;
+						// D_mul = D_a * D_a2b1
+						Tensor<Tdata> D_mul;
+						for(const TAC &Aa2 : list_Aa2)
+						{
+							if(filter_atom->filter_for31(label,Aa01,Ab01,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							const Tensor<Tdata> &D_a2b1 = tools.get_Ds_ab(Label::ab::a2b1, Aa2, Ab01);
+							if(D_a2b1.empty())	continue;
+
+							// b1a0a1 = a2b1 * a0a1a2
+							Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b1, D_a, D_mul, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul.empty())	continue;
+
+						// D_result = D_mul * D_a1b0 * D_b
+						Tensor<Tdata> D_tmp2;
+						for(const TAC &Ab2 : list_Ab2)
+						{
+							if(filter_atom->filter_for32(label,Aa01,Ab01,Ab2))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+
+							// b0b1a0 = a1b0 * b1a0a1
+							if(D_tmp2.empty())
+								D_tmp2 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a1b0, D_mul);
+							// a0b2 = b0b1a0 * b0b1b2
+							if(flag_gemm_batch)
+								Tensor_Multiply::x2y2_abx2_aby2(D_tmp2, D_b, Ds_result_fixed[Ab2], gemm_batch);
+							else
+							{
+								Tensor_Multiply::x2y2_abx2_aby2(D_tmp2, D_b, Ds_result_fixed[Ab2], Tdata(1.0), Tdata(1.0));
+							}
+						}
+						gemm_batch.execute();
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ia01_fixed!=list_Aa01.size())
+						add_Ds_fixed(list_Aa01[ia01_fixed]);
 				} break; // end case a1b0_a2b1
 
 				case Label::ab_ab::a1b1_a2b0:
@@ -652,54 +987,76 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 					const std::vector<TAC> &list_Ab2 =
 						list_Ab2_Db;
 
-					for(const TA &Aa01 : list_Aa01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Aa01, list_Ab01, sizes_a[0], sizes_b[0], flag_sort_tasks,
+						[&](const TA &Aa01){ return filter_atom->filter_for1(label,Aa01); });
+					std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
+					const auto add_Ds_fixed = [&](const TA &Aa01)
 					{
-						if(this->filter_atom->filter_for1(label,Aa01))	continue;
-						std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
-
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ib01=0; ib01<list_Ab01.size(); ++ib01)
-						{
-							const TAC &Ab01 = list_Ab01[ib01];
-							if(this->filter_atom->filter_for2(label,Aa01,Ab01))	continue;
-							const Tensor<Tdata> &D_a1b1 = tools.get_Ds_ab(Label::ab::a1b1, Aa01, Ab01);
-							if(D_a1b1.empty())	continue;
-							// D_mul = D_a * D_a2b0
-							Tensor<Tdata> D_mul;
-							for(const TAC &Aa2 : list_Aa2)
-							{
-								if(this->filter_atom->filter_for31(label,Aa01,Ab01,Aa2))	continue;
-								const Tensor<Tdata> &D_a = Global_Func::find(Ds_a_transpose, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								const Tensor<Tdata> &D_a2b0 = tools.get_Ds_ab(Label::ab::a2b0, Aa2, Ab01);
-								if(D_a2b0.empty())	continue;
-
-								// a1a0b0 = a1a0a2 * a2b0
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x0x1y1_x0x1a_ay1(D_a, D_a2b0);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul);
-							}
-							if(D_mul.empty())	continue;
-
-							// D_result = D_mul * D_a1b1 * D_b
-							for(const TAC &Ab2 : list_Ab2)
-							{
-								if(this->filter_atom->filter_for32(label,Aa01,Ab01,Ab2))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-
-								// a0b0b1 = a1a0b0 * a1b1
-								const Tensor<Tdata> D_tmp2 = Tensor_Multiply::x1x2y1_ax1x2_ay1(D_mul, D_a1b1);
-								// a0b2 = a0b0b1 * b0b1b2
-								Tensor<Tdata> D_tmp3 = Tensor_Multiply::x0y2_x0ab_aby2(D_tmp2, D_b);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp3), Ds_result_fixed[Ab2]);
-							}
-						} // end for Ab01
-
 						if(!Ds_result_fixed.empty())
 							LRI_Cal_Aux::add_Ds(std::move(Ds_result_fixed),
 												Ds_result_thread[Aa01]);
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Aa01
+						Ds_result_fixed.clear();
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
+
+					std::size_t ia01_fixed = list_Aa01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ia01_fixed)
+						{
+							if(ia01_fixed!=list_Aa01.size())
+								add_Ds_fixed(list_Aa01[ia01_fixed]);
+							ia01_fixed = tasks[itask][0];
+						}
+						const TA &Aa01 = list_Aa01[tasks[itask][0]];
+						const TAC &Ab01 = list_Ab01[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Aa01, Ab01);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Aa01,Ab01))	continue;
+						const Tensor<Tdata> &D_a1b1 = tools.get_Ds_ab(Label::ab::a1b1, Aa01, Ab01);
+						if(D_a1b1.empty())	continue;
+						// D_mul = D_a * D_a2b0
+						Tensor<Tdata> D_mul;
+						for(const TAC &Aa2 : list_Aa2)
+						{
+							if(filter_atom->filter_for31(label,Aa01,Ab01,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab_transpose(Label::ab::a, Ds_a_transpose, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							const Tensor<Tdata> &D_a2b0 = tools.get_Ds_ab(Label::ab::a2b0, Aa2, Ab01);
+							if(D_a2b0.empty())	continue;
+
+							// a1a0b0 = a1a0a2 * a2b0
+							Tensor_Multiply::x0x1y1_x0x1a_ay1(D_a, D_a2b0, D_mul, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul.empty())	continue;
+
+						// D_result = D_mul * D_a1b1 * D_b
+						Tensor<Tdata> D_tmp2;
+						for(const TAC &Ab2 : list_Ab2)
+						{
+							if(filter_atom->filter_for32(label,Aa01,Ab01,Ab2))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+
+							// a0b0b1 = a1a0b0 * a1b1
+							if(D_tmp2.empty())
+								D_tmp2 = Tensor_Multiply::x1x2y1_ax1x2_ay1(D_mul, D_a1b1);
+							// a0b2 = a0b0b1 * b0b1b2
+							if(flag_gemm_batch)
+								Tensor_Multiply::x0y2_x0ab_aby2(D_tmp2, D_b, Ds_result_fixed[Ab2], gemm_batch);
+							else
+							{
+								Tensor_Multiply::x0y2_x0ab_aby2(D_tmp2, D_b, Ds_result_fixed[Ab2], Tdata(1.0), Tdata(1.0));
+							}
+						}
+						gemm_batch.execute();
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ia01_fixed!=list_Aa01.size())
+						add_Ds_fixed(list_Aa01[ia01_fixed]);
 				} break; // end case a1b1_a2b0
 
 			  // Aab_Aab::a01b01_a2b2
@@ -719,54 +1076,85 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 						list_Ab2_Db,
 						data_wrapper(Label::ab::a2b2).index_Ds_ab[0]);
 
-					for(const TA &Aa01 : list_Aa01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Aa01, list_Ab2, sizes_a[0], sizes_b[1], flag_sort_tasks,
+						[&](const TA &Aa01){ return filter_atom->filter_for1(label,Aa01); });
+					std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
+					const auto add_Ds_fixed = [&](const TA &Aa01)
 					{
-						if(this->filter_atom->filter_for1(label,Aa01))	continue;
-						std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
-
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ib2=0; ib2<list_Ab2.size(); ++ib2)
+						if(!Ds_result_fixed.empty())
+							LRI_Cal_Aux::add_Ds(std::move(Ds_result_fixed),
+												Ds_result_thread[Aa01]);
+						Ds_result_fixed.clear();
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
+
+					std::size_t ia01_fixed = list_Aa01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ia01_fixed)
+						{
+							if(ia01_fixed!=list_Aa01.size())
+								add_Ds_fixed(list_Aa01[ia01_fixed]);
+							ia01_fixed = tasks[itask][0];
+						}
+						const TA &Aa01 = list_Aa01[tasks[itask][0]];
+						const TAC &Ab2 = list_Ab2[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Aa01, Ab2);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Aa01,Ab2))	continue;
+						// D_mul = D_a * D_a2b2
+						Tensor<Tdata> D_mul;
+						for(const TAC &Aa2 : list_Aa2)
 						{
-							const TAC &Ab2 = list_Ab2[ib2];
-							if(this->filter_atom->filter_for2(label,Aa01,Ab2))	continue;
-							// D_mul = D_a * D_a2b2
-							Tensor<Tdata> D_mul;
-							for(const TAC &Aa2 : list_Aa2)
+							if(filter_atom->filter_for31(label,Aa01,Ab2,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab_transpose(Label::ab::a, Ds_a_transpose, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							const Tensor<Tdata> &D_a2b2 = tools.get_Ds_ab(Label::ab::a2b2, Aa2, Ab2);
+							if(D_a2b2.empty())	continue;
+
+							// b2a1a0 = a2b2 * a1a0a2
+							Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b2, D_a, D_mul, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul.empty())	continue;
+
+						// D_result = D_mul * D_a0b0 * D_b
+						std::vector<Tensor<Tdata>> Ds_tmp2;										// for flag_gemm_batch
+						std::vector<std::pair<const Tensor<Tdata>*, Tensor<Tdata>*>> Ds_b_result;		// for flag_gemm_batch
+						for(const TAC &Ab01 : list_Ab01)
+						{
+							if(filter_atom->filter_for32(label,Aa01,Ab2,Ab01))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab_transpose(Label::ab::b, Ds_b_transpose, Ab01.first, TAC{Ab2.first, (Ab2.second-Ab01.second)%this->period});
+							if(D_b.empty())	continue;
+							const Tensor<Tdata> &D_a0b0 = tools.get_Ds_ab(Label::ab::a0b0, Aa01, Ab01);
+							if(D_a0b0.empty())	continue;
+
+							if(flag_gemm_batch)
 							{
-								if(this->filter_atom->filter_for31(label,Aa01,Ab2,Aa2))	continue;
-								const Tensor<Tdata> &D_a = Global_Func::find(Ds_a_transpose, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								const Tensor<Tdata> &D_a2b2 = tools.get_Ds_ab(Label::ab::a2b2, Aa2, Ab2);
-								if(D_a2b2.empty())	continue;
-
-								// b2a1a0 = a2b2 * a1a0a2
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b2, D_a);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul);
+								// b0b2a1 = a0b0 * b2a1a0
+								Ds_tmp2.emplace_back();
+								Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a0b0, D_mul, Ds_tmp2.back(), gemm_batch);
+								Ds_b_result.emplace_back(&D_b, &Ds_result_fixed[Ab01]);
 							}
-							if(D_mul.empty())	continue;
-
-							// D_result = D_mul * D_a0b0 * D_b
-							for(const TAC &Ab01 : list_Ab01)
+							else
 							{
-								if(this->filter_atom->filter_for32(label,Aa01,Ab2,Ab01))	continue;
-								const Tensor<Tdata> &D_b = Global_Func::find(Ds_b_transpose, Ab01.first, TAC{Ab2.first, (Ab2.second-Ab01.second)%this->period});
-								if(D_b.empty())	continue;
-								const Tensor<Tdata> &D_a0b0 = tools.get_Ds_ab(Label::ab::a0b0, Aa01, Ab01);
-								if(D_a0b0.empty())	continue;
-
 								// b0b2a1 = a0b0 * b2a1a0
 								const Tensor<Tdata> D_tmp2 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a0b0, D_mul);
 								// a1b1 = b0b2a1 * b1b0b2
-								Tensor<Tdata> D_tmp3 = Tensor_Multiply::x2y0_abx2_y0ab(D_tmp2, D_b);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp3), Ds_result_fixed[Ab01]);
+								Tensor_Multiply::x2y0_abx2_y0ab(D_tmp2, D_b, Ds_result_fixed[Ab01], Tdata(1.0), Tdata(1.0));
 							}
-						} // end for Ab01
-
-						if(!Ds_result_fixed.empty())
-							LRI_Cal_Aux::add_Ds(std::move(Ds_result_fixed),
-												Ds_result_thread[Aa01]);
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Aa01
+						}
+						gemm_batch.execute();
+						// a1b1 = b0b2a1 * b1b0b2
+						for(std::size_t i=0; i<Ds_tmp2.size(); ++i)
+							Tensor_Multiply::x2y0_abx2_y0ab(Ds_tmp2[i], *Ds_b_result[i].first, *Ds_b_result[i].second, gemm_batch);
+						gemm_batch.execute();
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ia01_fixed!=list_Aa01.size())
+						add_Ds_fixed(list_Aa01[ia01_fixed]);
 				} break; // end case a0b0_a2b2
 
 				case Label::ab_ab::a0b1_a2b2:
@@ -784,54 +1172,85 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 						list_Ab2_Db,
 						data_wrapper(Label::ab::a2b2).index_Ds_ab[0]);
 
-					for(const TA &Aa01 : list_Aa01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Aa01, list_Ab2, sizes_a[0], sizes_b[1], flag_sort_tasks,
+						[&](const TA &Aa01){ return filter_atom->filter_for1(label,Aa01); });
+					std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
+					const auto add_Ds_fixed = [&](const TA &Aa01)
 					{
-						if(this->filter_atom->filter_for1(label,Aa01))	continue;
-						std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
-
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ib2=0; ib2<list_Ab2.size(); ++ib2)
+						if(!Ds_result_fixed.empty())
+							LRI_Cal_Aux::add_Ds(std::move(Ds_result_fixed),
+												Ds_result_thread[Aa01]);
+						Ds_result_fixed.clear();
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
+
+					std::size_t ia01_fixed = list_Aa01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ia01_fixed)
+						{
+							if(ia01_fixed!=list_Aa01.size())
+								add_Ds_fixed(list_Aa01[ia01_fixed]);
+							ia01_fixed = tasks[itask][0];
+						}
+						const TA &Aa01 = list_Aa01[tasks[itask][0]];
+						const TAC &Ab2 = list_Ab2[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Aa01, Ab2);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Aa01,Ab2))	continue;
+						// D_mul = D_a * D_a2b2
+						Tensor<Tdata> D_mul;
+						for(const TAC &Aa2 : list_Aa2)
 						{
-							const TAC &Ab2 = list_Ab2[ib2];
-							if(this->filter_atom->filter_for2(label,Aa01,Ab2))	continue;
-							// D_mul = D_a * D_a2b2
-							Tensor<Tdata> D_mul;
-							for(const TAC &Aa2 : list_Aa2)
+							if(filter_atom->filter_for31(label,Aa01,Ab2,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab_transpose(Label::ab::a, Ds_a_transpose, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							const Tensor<Tdata> &D_a2b2 = tools.get_Ds_ab(Label::ab::a2b2, Aa2, Ab2);
+							if(D_a2b2.empty())	continue;
+
+							// b2a1a0 = a2b2 * a1a0a2
+							Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b2, D_a, D_mul, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul.empty())	continue;
+
+						// D_result = D_mul * D_a0b1 * D_b
+						std::vector<Tensor<Tdata>> Ds_tmp2;										// for flag_gemm_batch
+						std::vector<std::pair<const Tensor<Tdata>*, Tensor<Tdata>*>> Ds_b_result;		// for flag_gemm_batch
+						for(const TAC &Ab01 : list_Ab01)
+						{
+							if(filter_atom->filter_for32(label,Aa01,Ab2,Ab01))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+							const Tensor<Tdata> &D_a0b1 = tools.get_Ds_ab(Label::ab::a0b1, Aa01, Ab01);
+							if(D_a0b1.empty())	continue;
+
+							if(flag_gemm_batch)
 							{
-								if(this->filter_atom->filter_for31(label,Aa01,Ab2,Aa2))	continue;
-								const Tensor<Tdata> &D_a = Global_Func::find(Ds_a_transpose, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								const Tensor<Tdata> &D_a2b2 = tools.get_Ds_ab(Label::ab::a2b2, Aa2, Ab2);
-								if(D_a2b2.empty())	continue;
-
-								// b2a1a0 = a2b2 * a1a0a2
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b2, D_a);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul);
+								// b1b2a1 = a0b1 * a2a1a0
+								Ds_tmp2.emplace_back();
+								Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a0b1, D_mul, Ds_tmp2.back(), gemm_batch);
+								Ds_b_result.emplace_back(&D_b, &Ds_result_fixed[Ab01]);
 							}
-							if(D_mul.empty())	continue;
-
-							// D_result = D_mul * D_a0b1 * D_b
-							for(const TAC &Ab01 : list_Ab01)
+							else
 							{
-								if(this->filter_atom->filter_for32(label,Aa01,Ab2,Ab01))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-								const Tensor<Tdata> &D_a0b1 = tools.get_Ds_ab(Label::ab::a0b1, Aa01, Ab01);
-								if(D_a0b1.empty())	continue;
-
 								// b1b2a1 = a0b1 * a2a1a0
 								const Tensor<Tdata> D_tmp2 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a0b1, D_mul);
 								// a1b0 = b1b2a1 * b0b1b2
-								Tensor<Tdata> D_tmp3 = Tensor_Multiply::x2y0_abx2_y0ab(D_tmp2, D_b);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp3), Ds_result_fixed[Ab01]);
+								Tensor_Multiply::x2y0_abx2_y0ab(D_tmp2, D_b, Ds_result_fixed[Ab01], Tdata(1.0), Tdata(1.0));
 							}
-						} // end for Ab01
-
-						if(!Ds_result_fixed.empty())
-							LRI_Cal_Aux::add_Ds(std::move(Ds_result_fixed),
-												Ds_result_thread[Aa01]);
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Aa01
+						}
+						gemm_batch.execute();
+						// a1b0 = b1b2a1 * b0b1b2
+						for(std::size_t i=0; i<Ds_tmp2.size(); ++i)
+							Tensor_Multiply::x2y0_abx2_y0ab(Ds_tmp2[i], *Ds_b_result[i].first, *Ds_b_result[i].second, gemm_batch);
+						gemm_batch.execute();
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ia01_fixed!=list_Aa01.size())
+						add_Ds_fixed(list_Aa01[ia01_fixed]);
 				} break; // end case a0b1_a2b2
 
 				case Label::ab_ab::a1b0_a2b2:
@@ -849,54 +1268,85 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 						list_Ab2_Db,
 						data_wrapper(Label::ab::a2b2).index_Ds_ab[0]);
 
-					for(const TA &Aa01 : list_Aa01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Aa01, list_Ab2, sizes_a[0], sizes_b[1], flag_sort_tasks,
+						[&](const TA &Aa01){ return filter_atom->filter_for1(label,Aa01); });
+					std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
+					const auto add_Ds_fixed = [&](const TA &Aa01)
 					{
-						if(this->filter_atom->filter_for1(label,Aa01))	continue;
-						std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
-
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ib2=0; ib2<list_Ab2.size(); ++ib2)
+						if(!Ds_result_fixed.empty())
+							LRI_Cal_Aux::add_Ds(std::move(Ds_result_fixed),
+												Ds_result_thread[Aa01]);
+						Ds_result_fixed.clear();
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
+
+					std::size_t ia01_fixed = list_Aa01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ia01_fixed)
+						{
+							if(ia01_fixed!=list_Aa01.size())
+								add_Ds_fixed(list_Aa01[ia01_fixed]);
+							ia01_fixed = tasks[itask][0];
+						}
+						const TA &Aa01 = list_Aa01[tasks[itask][0]];
+						const TAC &Ab2 = list_Ab2[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Aa01, Ab2);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Aa01,Ab2))	continue;
+						// D_mul = D_a * D_a2b2
+						Tensor<Tdata> D_mul;
+						for(const TAC &Aa2 : list_Aa2)
+						{
+							if(filter_atom->filter_for31(label,Aa01,Ab2,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							const Tensor<Tdata> &D_a2b2 = tools.get_Ds_ab(Label::ab::a2b2, Aa2, Ab2);
+							if(D_a2b2.empty())	continue;
+
+							// b2a0a1 = a2b2 * a0a1a2
+							Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b2, D_a, D_mul, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul.empty())	continue;
+
+						// D_result = D_mul * D_a1b0 * D_b
+						std::vector<Tensor<Tdata>> Ds_tmp2;										// for flag_gemm_batch
+						std::vector<std::pair<const Tensor<Tdata>*, Tensor<Tdata>*>> Ds_b_result;		// for flag_gemm_batch
+						for(const TAC &Ab01 : list_Ab01)
 						{
-							const TAC &Ab2 = list_Ab2[ib2];
-							if(this->filter_atom->filter_for2(label,Aa01,Ab2))	continue;
-							// D_mul = D_a * D_a2b2
-							Tensor<Tdata> D_mul;
-							for(const TAC &Aa2 : list_Aa2)
+							if(filter_atom->filter_for32(label,Aa01,Ab2,Ab01))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab_transpose(Label::ab::b, Ds_b_transpose, Ab01.first, TAC{Ab2.first, (Ab2.second-Ab01.second)%this->period});
+							if(D_b.empty())	continue;
+							const Tensor<Tdata> &D_a1b0 = tools.get_Ds_ab(Label::ab::a1b0, Aa01, Ab01);
+							if(D_a1b0.empty())	continue;
+
+							if(flag_gemm_batch)
 							{
-								if(this->filter_atom->filter_for31(label,Aa01,Ab2,Aa2))	continue;
-								const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								const Tensor<Tdata> &D_a2b2 = tools.get_Ds_ab(Label::ab::a2b2, Aa2, Ab2);
-								if(D_a2b2.empty())	continue;
-
-								// b2a0a1 = a2b2 * a0a1a2
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b2, D_a);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul);
+								// b0b2a0 = a1b0 * b2a0a1
+								Ds_tmp2.emplace_back();
+								Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a1b0, D_mul, Ds_tmp2.back(), gemm_batch);
+								Ds_b_result.emplace_back(&D_b, &Ds_result_fixed[Ab01]);
 							}
-							if(D_mul.empty())	continue;
-
-							// D_result = D_mul * D_a1b0 * D_b
-							for(const TAC &Ab01 : list_Ab01)
+							else
 							{
-								if(this->filter_atom->filter_for32(label,Aa01,Ab2,Ab01))	continue;
-								const Tensor<Tdata> &D_b = Global_Func::find(Ds_b_transpose, Ab01.first, TAC{Ab2.first, (Ab2.second-Ab01.second)%this->period});
-								if(D_b.empty())	continue;
-								const Tensor<Tdata> &D_a1b0 = tools.get_Ds_ab(Label::ab::a1b0, Aa01, Ab01);
-								if(D_a1b0.empty())	continue;
-
 								// b0b2a0 = a1b0 * b2a0a1
 								const Tensor<Tdata> D_tmp2 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a1b0, D_mul);
 								// a0b1 = b0b2a0 * b1b0b2
-								Tensor<Tdata> D_tmp3 = Tensor_Multiply::x2y0_abx2_y0ab(D_tmp2, D_b);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp3), Ds_result_fixed[Ab01]);
+								Tensor_Multiply::x2y0_abx2_y0ab(D_tmp2, D_b, Ds_result_fixed[Ab01], Tdata(1.0), Tdata(1.0));
 							}
-						} // end for Ab01
-
-						if(!Ds_result_fixed.empty())
-							LRI_Cal_Aux::add_Ds(std::move(Ds_result_fixed),
-												Ds_result_thread[Aa01]);
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Aa01
+						}
+						gemm_batch.execute();
+						// a0b1 = b0b2a0 * b1b0b2
+						for(std::size_t i=0; i<Ds_tmp2.size(); ++i)
+							Tensor_Multiply::x2y0_abx2_y0ab(Ds_tmp2[i], *Ds_b_result[i].first, *Ds_b_result[i].second, gemm_batch);
+						gemm_batch.execute();
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ia01_fixed!=list_Aa01.size())
+						add_Ds_fixed(list_Aa01[ia01_fixed]);
 				} break; // end case a1b0_a2b2
 
 				case Label::ab_ab::a1b1_a2b2:
@@ -914,54 +1364,85 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 						list_Ab2_Db,
 						data_wrapper(Label::ab::a2b2).index_Ds_ab[0]);
 
-					for(const TA &Aa01 : list_Aa01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Aa01, list_Ab2, sizes_a[0], sizes_b[1], flag_sort_tasks,
+						[&](const TA &Aa01){ return filter_atom->filter_for1(label,Aa01); });
+					std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
+					const auto add_Ds_fixed = [&](const TA &Aa01)
 					{
-						if(this->filter_atom->filter_for1(label,Aa01))	continue;
-						std::map<TAC,Tensor<Tdata>> Ds_result_fixed;
-
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ib2=0; ib2<list_Ab2.size(); ++ib2)
+						if(!Ds_result_fixed.empty())
+							LRI_Cal_Aux::add_Ds(std::move(Ds_result_fixed),
+												Ds_result_thread[Aa01]);
+						Ds_result_fixed.clear();
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
+
+					std::size_t ia01_fixed = list_Aa01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ia01_fixed)
+						{
+							if(ia01_fixed!=list_Aa01.size())
+								add_Ds_fixed(list_Aa01[ia01_fixed]);
+							ia01_fixed = tasks[itask][0];
+						}
+						const TA &Aa01 = list_Aa01[tasks[itask][0]];
+						const TAC &Ab2 = list_Ab2[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Aa01, Ab2);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Aa01,Ab2))	continue;
+						// D_mul = D_a * D_a2b2
+						Tensor<Tdata> D_mul;
+						for(const TAC &Aa2 : list_Aa2)
+						{
+							if(filter_atom->filter_for31(label,Aa01,Ab2,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							const Tensor<Tdata> &D_a2b2 = tools.get_Ds_ab(Label::ab::a2b2, Aa2, Ab2);
+							if(D_a2b2.empty())	continue;
+
+							// b2a0a1 = a2b2 * a0a1a2
+							Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b2, D_a, D_mul, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul.empty())	continue;
+
+						// D_result = D_mul * D_a1b1 * D_b
+						std::vector<Tensor<Tdata>> Ds_tmp2;										// for flag_gemm_batch
+						std::vector<std::pair<const Tensor<Tdata>*, Tensor<Tdata>*>> Ds_b_result;		// for flag_gemm_batch
+						for(const TAC &Ab01 : list_Ab01)
 						{
-							const TAC &Ab2 = list_Ab2[ib2];
-							if(this->filter_atom->filter_for2(label,Aa01,Ab2))	continue;
-							// D_mul = D_a * D_a2b2
-							Tensor<Tdata> D_mul;
-							for(const TAC &Aa2 : list_Aa2)
+							if(filter_atom->filter_for32(label,Aa01,Ab2,Ab01))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+							const Tensor<Tdata> &D_a1b1 = tools.get_Ds_ab(Label::ab::a1b1, Aa01, Ab01);
+							if(D_a1b1.empty())	continue;
+
+							if(flag_gemm_batch)
 							{
-								if(this->filter_atom->filter_for31(label,Aa01,Ab2,Aa2))	continue;
-								const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								const Tensor<Tdata> &D_a2b2 = tools.get_Ds_ab(Label::ab::a2b2, Aa2, Ab2);
-								if(D_a2b2.empty())	continue;
-
-								// b2a0a1 = a2b2 * a0a1a2
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b2, D_a);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul);
+								// b1b2a0 = a1b1 * b2a0a1
+								Ds_tmp2.emplace_back();
+								Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a1b1, D_mul, Ds_tmp2.back(), gemm_batch);
+								Ds_b_result.emplace_back(&D_b, &Ds_result_fixed[Ab01]);
 							}
-							if(D_mul.empty())	continue;
-
-							// D_result = D_mul * D_a1b1 * D_b
-							for(const TAC &Ab01 : list_Ab01)
+							else
 							{
-								if(this->filter_atom->filter_for32(label,Aa01,Ab2,Ab01))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-								const Tensor<Tdata> &D_a1b1 = tools.get_Ds_ab(Label::ab::a1b1, Aa01, Ab01);
-								if(D_a1b1.empty())	continue;
-
 								// b1b2a0 = a1b1 * b2a0a1
 								const Tensor<Tdata> D_tmp2 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a1b1, D_mul);
 								// a0b0 = b1b2a0 * b0b1b2
-								Tensor<Tdata> D_tmp3 = Tensor_Multiply::x2y0_abx2_y0ab(D_tmp2, D_b);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp3), Ds_result_fixed[Ab01]);
+								Tensor_Multiply::x2y0_abx2_y0ab(D_tmp2, D_b, Ds_result_fixed[Ab01], Tdata(1.0), Tdata(1.0));
 							}
-						} // end for Ab01
-
-						if(!Ds_result_fixed.empty())
-							LRI_Cal_Aux::add_Ds(std::move(Ds_result_fixed),
-												Ds_result_thread[Aa01]);
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Aa01
+						}
+						gemm_batch.execute();
+						// a0b0 = b1b2a0 * b0b1b2
+						for(std::size_t i=0; i<Ds_tmp2.size(); ++i)
+							Tensor_Multiply::x2y0_abx2_y0ab(Ds_tmp2[i], *Ds_b_result[i].first, *Ds_b_result[i].second, gemm_batch);
+						gemm_batch.execute();
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ia01_fixed!=list_Aa01.size())
+						add_Ds_fixed(list_Aa01[ia01_fixed]);
 				} break; // end case a1b1_a2b2
 
 			  // Aab_Aab::a01b2_a2b01
@@ -981,54 +1462,68 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 						list_Ab2_Db,
 						data_wrapper(Label::ab::a1b2).index_Ds_ab[0]);
 
-					for(const TA &Aa01 : list_Aa01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Aa01, list_Ab01, sizes_a[0], sizes_b[0], flag_sort_tasks,
+						[&](const TA &Aa01){ return filter_atom->filter_for1(label,Aa01); });
+					const auto add_Ds_fixed = [&](const TA &)
 					{
-						if(this->filter_atom->filter_for1(label,Aa01))	continue;
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ib01=0; ib01<list_Ab01.size(); ++ib01)
-						{
-							const TAC &Ab01 = list_Ab01[ib01];
-							if(this->filter_atom->filter_for2(label,Aa01,Ab01))	continue;
-							// D_mul1 = D_b * D_a1b2
-							Tensor<Tdata> D_mul1;
-							for(const TAC &Ab2 : list_Ab2)
-							{
-								if(this->filter_atom->filter_for31(label,Aa01,Ab01,Ab2))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-								const Tensor<Tdata> &D_a1b2 = tools.get_Ds_ab(Label::ab::a1b2, Aa01, Ab2);
-								if(D_a1b2.empty())	continue;
-
-								// b0b1a1 = b0b1b2 * a1b2
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x0x1y0_x0x1a_y0a(D_b, D_a1b2);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul1);
-							}
-							if(D_mul1.empty())	continue;
-
-							// D_mul2 = D_a2b1 * D_a
-							Tensor<Tdata> D_mul2;
-							for(const TAC &Aa2 : list_Aa2)
-							{
-								if(this->filter_atom->filter_for32(label,Aa01,Ab01,Aa2))	continue;
-								const Tensor<Tdata> &D_a = Global_Func::find(Ds_a_transpose, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								const Tensor<Tdata> &D_a2b1 = tools.get_Ds_ab(Label::ab::a2b1, Aa2, Ab01);
-								if(D_a2b1.empty())	continue;
-								// b1a1a0 = a2b1 * a1a0a2
-								Tensor<Tdata> D_tmp2 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b1, D_a);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp2), D_mul2);
-							}
-							if(D_mul2.empty())	continue;
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
 
-							// D_result = D_mul2 * D_mul1
-							// a0b0 = b1a1a0 * b0b1a1
-							Tensor<Tdata> D_mul3 = Tensor_Multiply::x2y0_abx2_y0ab(D_mul2, D_mul1);
-							LRI_Cal_Aux::add_Ds(std::move(D_mul3),
-												Ds_result_thread[Aa01][Ab01]);
-						} // end for Aa01
-
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Ab01
+					std::size_t ia01_fixed = list_Aa01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ia01_fixed)
+						{
+							if(ia01_fixed!=list_Aa01.size())
+								add_Ds_fixed(list_Aa01[ia01_fixed]);
+							ia01_fixed = tasks[itask][0];
+						}
+						const TA &Aa01 = list_Aa01[tasks[itask][0]];
+						const TAC &Ab01 = list_Ab01[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Aa01, Ab01);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Aa01,Ab01))	continue;
+						// D_mul1 = D_b * D_a1b2
+						Tensor<Tdata> D_mul1;
+						for(const TAC &Ab2 : list_Ab2)
+						{
+							if(filter_atom->filter_for31(label,Aa01,Ab01,Ab2))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+							const Tensor<Tdata> &D_a1b2 = tools.get_Ds_ab(Label::ab::a1b2, Aa01, Ab2);
+							if(D_a1b2.empty())	continue;
+
+							// b0b1a1 = b0b1b2 * a1b2
+							Tensor_Multiply::x0x1y0_x0x1a_y0a(D_b, D_a1b2, D_mul1, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul1.empty())	continue;
+
+						// D_mul2 = D_a2b1 * D_a
+						Tensor<Tdata> D_mul2;
+						for(const TAC &Aa2 : list_Aa2)
+						{
+							if(filter_atom->filter_for32(label,Aa01,Ab01,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab_transpose(Label::ab::a, Ds_a_transpose, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							const Tensor<Tdata> &D_a2b1 = tools.get_Ds_ab(Label::ab::a2b1, Aa2, Ab01);
+							if(D_a2b1.empty())	continue;
+							// b1a1a0 = a2b1 * a1a0a2
+							Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b1, D_a, D_mul2, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul2.empty())	continue;
+
+						// D_result = D_mul2 * D_mul1
+						// a0b0 = b1a1a0 * b0b1a1
+						Tensor<Tdata> D_mul3 = Tensor_Multiply::x2y0_abx2_y0ab(D_mul2, D_mul1);
+						LRI_Cal_Aux::add_Ds(std::move(D_mul3),
+											Ds_result_thread[Aa01][Ab01]);
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ia01_fixed!=list_Aa01.size())
+						add_Ds_fixed(list_Aa01[ia01_fixed]);
 				} break; // end case a1b2_a2b1
 
 				case Label::ab_ab::a0b2_a2b0:
@@ -1046,54 +1541,68 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 						list_Ab2_Db,
 						data_wrapper(Label::ab::a0b2).index_Ds_ab[0]);
 
-					for(const TA &Aa01 : list_Aa01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Aa01, list_Ab01, sizes_a[0], sizes_b[0], flag_sort_tasks,
+						[&](const TA &Aa01){ return filter_atom->filter_for1(label,Aa01); });
+					const auto add_Ds_fixed = [&](const TA &)
 					{
-						if(this->filter_atom->filter_for1(label,Aa01))	continue;
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ib01=0; ib01<list_Ab01.size(); ++ib01)
-						{
-							const TAC &Ab01 = list_Ab01[ib01];
-							if(this->filter_atom->filter_for2(label,Aa01,Ab01))	continue;
-							// D_mul1 = D_b * D_a0b2
-							Tensor<Tdata> D_mul1;
-							for(const TAC &Ab2 : list_Ab2)
-							{
-								if(this->filter_atom->filter_for31(label,Aa01,Ab01,Ab2))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-								const Tensor<Tdata> &D_a0b2 = tools.get_Ds_ab(Label::ab::a0b2, Aa01, Ab2);
-								if(D_a0b2.empty())	continue;
-
-								// a0b0b1 = a0b2 * b0b1b2
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x0y0y1_x0a_y0y1a(D_a0b2, D_b);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul1);
-							}
-							if(D_mul1.empty())	continue;
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
 
-							// D_mul2 = D_a2b0 * D_a
-							Tensor<Tdata> D_mul2;
-							for(const TAC &Aa2 : list_Aa2)
-							{
-								if(this->filter_atom->filter_for32(label,Aa01,Ab01,Aa2))	continue;
-								const Tensor<Tdata> &D_a = Global_Func::find(Ds_a_transpose, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								const Tensor<Tdata> &D_a2b0 = tools.get_Ds_ab(Label::ab::a2b0, Aa2, Ab01);
-								if(D_a2b0.empty())	continue;
-								// a1a0b0 = a1a0a2 * a2b0
-								Tensor<Tdata> D_tmp2 = Tensor_Multiply::x0x1y1_x0x1a_ay1(D_a, D_a2b0);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp2), D_mul2);
-							}
-							if(D_mul2.empty())	continue;
-
-							// D_result = D_mul2 * D_mul1
-							// b1a1 = a1a0b0 * a0b0b1
-							Tensor<Tdata> D_mul3 = Tensor_Multiply::x0y2_x0ab_aby2(D_mul2, D_mul1);
-							LRI_Cal_Aux::add_Ds(std::move(D_mul3),
-												Ds_result_thread[Aa01][Ab01]);
-						} // end for Aa01
-
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Ab01
+					std::size_t ia01_fixed = list_Aa01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ia01_fixed)
+						{
+							if(ia01_fixed!=list_Aa01.size())
+								add_Ds_fixed(list_Aa01[ia01_fixed]);
+							ia01_fixed = tasks[itask][0];
+						}
+						const TA &Aa01 = list_Aa01[tasks[itask][0]];
+						const TAC &Ab01 = list_Ab01[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Aa01, Ab01);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Aa01,Ab01))	continue;
+						// D_mul1 = D_b * D_a0b2
+						Tensor<Tdata> D_mul1;
+						for(const TAC &Ab2 : list_Ab2)
+						{
+							if(filter_atom->filter_for31(label,Aa01,Ab01,Ab2))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+							const Tensor<Tdata> &D_a0b2 = tools.get_Ds_ab(Label::ab::a0b2, Aa01, Ab2);
+							if(D_a0b2.empty())	continue;
+
+							// a0b0b1 = a0b2 * b0b1b2
+							Tensor_Multiply::x0y0y1_x0a_y0y1a(D_a0b2, D_b, D_mul1, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul1.empty())	continue;
+
+						// D_mul2 = D_a2b0 * D_a
+						Tensor<Tdata> D_mul2;
+						for(const TAC &Aa2 : list_Aa2)
+						{
+							if(filter_atom->filter_for32(label,Aa01,Ab01,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab_transpose(Label::ab::a, Ds_a_transpose, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							const Tensor<Tdata> &D_a2b0 = tools.get_Ds_ab(Label::ab::a2b0, Aa2, Ab01);
+							if(D_a2b0.empty())	continue;
+							// a1a0b0 = a1a0a2 * a2b0
+							Tensor_Multiply::x0x1y1_x0x1a_ay1(D_a, D_a2b0, D_mul2, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul2.empty())	continue;
+
+						// D_result = D_mul2 * D_mul1
+						// b1a1 = a1a0b0 * a0b0b1
+						Tensor<Tdata> D_mul3 = Tensor_Multiply::x0y2_x0ab_aby2(D_mul2, D_mul1);
+						LRI_Cal_Aux::add_Ds(std::move(D_mul3),
+											Ds_result_thread[Aa01][Ab01]);
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ia01_fixed!=list_Aa01.size())
+						add_Ds_fixed(list_Aa01[ia01_fixed]);
 				} break; // end case a0b2_a2b0
 
 				case Label::ab_ab::a0b2_a2b1:
@@ -1111,54 +1620,68 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 						list_Ab2_Db,
 						data_wrapper(Label::ab::a0b2).index_Ds_ab[0]);
 
-					for(const TA &Aa01 : list_Aa01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Aa01, list_Ab01, sizes_a[0], sizes_b[0], flag_sort_tasks,
+						[&](const TA &Aa01){ return filter_atom->filter_for1(label,Aa01); });
+					const auto add_Ds_fixed = [&](const TA &)
 					{
-						if(this->filter_atom->filter_for1(label,Aa01))	continue;
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ib01=0; ib01<list_Ab01.size(); ++ib01)
-						{
-							const TAC &Ab01 = list_Ab01[ib01];
-							if(this->filter_atom->filter_for2(label,Aa01,Ab01))	continue;
-							// D_mul1 = D_b * D_a0b2
-							Tensor<Tdata> D_mul1;
-							for(const TAC &Ab2 : list_Ab2)
-							{
-								if(this->filter_atom->filter_for31(label,Aa01,Ab01,Ab2))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-								const Tensor<Tdata> &D_a0b2 = tools.get_Ds_ab(Label::ab::a0b2, Aa01, Ab2);
-								if(D_a0b2.empty())	continue;
-
-								// b0b1a0 = b0b1b2 * a0b2
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x0x1y0_x0x1a_y0a(D_b, D_a0b2);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul1);
-							}
-							if(D_mul1.empty())	continue;
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
 
-							// D_mul2 = D_a2b1 * D_a
-							Tensor<Tdata> D_mul2;
-							for(const TAC &Aa2 : list_Aa2)
-							{
-								if(this->filter_atom->filter_for32(label,Aa01,Ab01,Aa2))	continue;
-								const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								const Tensor<Tdata> &D_a2b1 = tools.get_Ds_ab(Label::ab::a2b1, Aa2, Ab01);
-								if(D_a2b1.empty())	continue;
-								// b1a0a1 = a2b1 * a0a1a2
-								Tensor<Tdata> D_tmp2 = Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b1, D_a);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp2), D_mul2);
-							}
-							if(D_mul2.empty())	continue;
-
-							// D_result = D_mul2 * D_mul1
-							// a1b0 = b1a0a1 * b0b1a0
-							Tensor<Tdata> D_mul3 = Tensor_Multiply::x2y0_abx2_y0ab(D_mul2, D_mul1);
-							LRI_Cal_Aux::add_Ds(std::move(D_mul3),
-												Ds_result_thread[Aa01][Ab01]);
-						} // end for Aa01
-
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Ab01
+					std::size_t ia01_fixed = list_Aa01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ia01_fixed)
+						{
+							if(ia01_fixed!=list_Aa01.size())
+								add_Ds_fixed(list_Aa01[ia01_fixed]);
+							ia01_fixed = tasks[itask][0];
+						}
+						const TA &Aa01 = list_Aa01[tasks[itask][0]];
+						const TAC &Ab01 = list_Ab01[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Aa01, Ab01);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Aa01,Ab01))	continue;
+						// D_mul1 = D_b * D_a0b2
+						Tensor<Tdata> D_mul1;
+						for(const TAC &Ab2 : list_Ab2)
+						{
+							if(filter_atom->filter_for31(label,Aa01,Ab01,Ab2))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+							const Tensor<Tdata> &D_a0b2 = tools.get_Ds_ab(Label::ab::a0b2, Aa01, Ab2);
+							if(D_a0b2.empty())	continue;
+
+							// b0b1a0 = b0b1b2 * a0b2
+							Tensor_Multiply::x0x1y0_x0x1a_y0a(D_b, D_a0b2, D_mul1, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul1.empty())	continue;
+
+						// D_mul2 = D_a2b1 * D_a
+						Tensor<Tdata> D_mul2;
+						for(const TAC &Aa2 : list_Aa2)
+						{
+							if(filter_atom->filter_for32(label,Aa01,Ab01,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							const Tensor<Tdata> &D_a2b1 = tools.get_Ds_ab(Label::ab::a2b1, Aa2, Ab01);
+							if(D_a2b1.empty())	continue;
+							// b1a0a1 = a2b1 * a0a1a2
+							Tensor_Multiply::x1y0y1_ax1_y0y1a(D_a2b1, D_a, D_mul2, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul2.empty())	continue;
+
+						// D_result = D_mul2 * D_mul1
+						// a1b0 = b1a0a1 * b0b1a0
+						Tensor<Tdata> D_mul3 = Tensor_Multiply::x2y0_abx2_y0ab(D_mul2, D_mul1);
+						LRI_Cal_Aux::add_Ds(std::move(D_mul3),
+											Ds_result_thread[Aa01][Ab01]);
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ia01_fixed!=list_Aa01.size())
+						add_Ds_fixed(list_Aa01[ia01_fixed]);
 				} break; // end case a0b2_a2b1
 
 				case Label::ab_ab::a1b2_a2b0:
@@ -1176,54 +1699,68 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 						list_Ab2_Db,
 						data_wrapper(Label::ab::a1b2).index_Ds_ab[0]);
 
-					for(const TA &Aa01 : list_Aa01)
+					const std::vector<std::array<std::size_t,2>> tasks = LRI_Cal_Aux::get_tasks(
+						list_Aa01, list_Ab01, sizes_a[0], sizes_b[0], flag_sort_tasks,
+						[&](const TA &Aa01){ return filter_atom->filter_for1(label,Aa01); });
+					const auto add_Ds_fixed = [&](const TA &)
 					{
-						if(this->filter_atom->filter_for1(label,Aa01))	continue;
-						#pragma omp for schedule(dynamic) nowait
-						for(std::size_t ib01=0; ib01<list_Ab01.size(); ++ib01)
-						{
-							const TAC &Ab01 = list_Ab01[ib01];
-							if(this->filter_atom->filter_for2(label,Aa01,Ab01))	continue;
-							// D_mul1 = D_b * D_a1b2
-							Tensor<Tdata> D_mul1;
-							for(const TAC &Ab2 : list_Ab2)
-							{
-								if(this->filter_atom->filter_for31(label,Aa01,Ab01,Ab2))	continue;
-								const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
-								if(D_b.empty())	continue;
-								const Tensor<Tdata> &D_a1b2 = tools.get_Ds_ab(Label::ab::a1b2, Aa01, Ab2);
-								if(D_a1b2.empty())	continue;
-
-								// a1b0b1 = a1b2 * b0b1b2
-								Tensor<Tdata> D_tmp1 = Tensor_Multiply::x0y0y1_x0a_y0y1a(D_a1b2, D_b);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp1), D_mul1);
-							}
-							if(D_mul1.empty())	continue;
-
-							// D_mul2 = D_a2b0 * D_a
-							Tensor<Tdata> D_mul2;
-							for(const TAC &Aa2 : list_Aa2)
-							{
-								if(this->filter_atom->filter_for32(label,Aa01,Ab01,Aa2))	continue;
-								const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
-								if(D_a.empty())	continue;
-								const Tensor<Tdata> &D_a2b0 = tools.get_Ds_ab(Label::ab::a2b0, Aa2, Ab01);
-								if(D_a2b0.empty())	continue;
-								// a0a1b0 = a0a1a2 * a2b0
-								Tensor<Tdata> D_tmp2 = Tensor_Multiply::x0x1y1_x0x1a_ay1(D_a, D_a2b0);
-								LRI_Cal_Aux::add_Ds(std::move(D_tmp2), D_mul2);
-							}
-							if(D_mul2.empty())	continue;
+						if(!flag_add_Ds_owner)
+							LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+					};
 
-							// D_result = D_mul2 * D_mul1
-							// a0b1 = a0a1b0 * a1b0b1
-							Tensor<Tdata> D_mul3 = Tensor_Multiply::x0y2_x0ab_aby2(D_mul2, D_mul1);
-							LRI_Cal_Aux::add_Ds(std::move(D_mul3),
-												Ds_result_thread[Aa01][Ab01]);
-						} // end for Aa01
-
-						LRI_Cal_Aux::add_Ds_omp_try_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
-					} // end for Ab01
+					std::size_t ia01_fixed = list_Aa01.size();
+					#pragma omp for schedule(dynamic) nowait
+					for(std::size_t itask=0; itask<tasks.size(); ++itask)
+					{
+						if(tasks[itask][0]!=ia01_fixed)
+						{
+							if(ia01_fixed!=list_Aa01.size())
+								add_Ds_fixed(list_Aa01[ia01_fixed]);
+							ia01_fixed = tasks[itask][0];
+						}
+						const TA &Aa01 = list_Aa01[tasks[itask][0]];
+						const TAC &Ab01 = list_Ab01[tasks[itask][1]];
+						if(flag_record_time)	task_timer.start(Aa01, Ab01);
+						tools.release_blocks();
+						if(filter_atom->filter_for2(label,Aa01,Ab01))	continue;
+						// D_mul1 = D_b * D_a1b2
+						Tensor<Tdata> D_mul1;
+						for(const TAC &Ab2 : list_Ab2)
+						{
+							if(filter_atom->filter_for31(label,Aa01,Ab01,Ab2))	continue;
+							const Tensor<Tdata> &D_b = tools.get_Ds_ab(Label::ab::b, Ab01, Ab2);
+							if(D_b.empty())	continue;
+							const Tensor<Tdata> &D_a1b2 = tools.get_Ds_ab(Label::ab::a1b2, Aa01, Ab2);
+							if(D_a1b2.empty())	continue;
+
+							// a1b0b1 = a1b2 * b0b1b2
+							Tensor_Multiply::x0y0y1_x0a_y0y1a(D_a1b2, D_b, D_mul1, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul1.empty())	continue;
+
+						// D_mul2 = D_a2b0 * D_a
+						Tensor<Tdata> D_mul2;
+						for(const TAC &Aa2 : list_Aa2)
+						{
+							if(filter_atom->filter_for32(label,Aa01,Ab01,Aa2))	continue;
+							const Tensor<Tdata> &D_a = tools.get_Ds_ab(Label::ab::a, Aa01, Aa2);
+							if(D_a.empty())	continue;
+							const Tensor<Tdata> &D_a2b0 = tools.get_Ds_ab(Label::ab::a2b0, Aa2, Ab01);
+							if(D_a2b0.empty())	continue;
+							// a0a1b0 = a0a1a2 * a2b0
+							Tensor_Multiply::x0x1y1_x0x1a_ay1(D_a, D_a2b0, D_mul2, Tdata(1.0), Tdata(1.0));
+						}
+						if(D_mul2.empty())	continue;
+
+						// D_result = D_mul2 * D_mul1
+						// a0b1 = a0a1b0 * a1b0b1
+						Tensor<Tdata> D_mul3 = Tensor_Multiply::x0y2_x0ab_aby2(D_mul2, D_mul1);
+						LRI_Cal_Aux::add_Ds(std::move(D_mul3),
+											Ds_result_thread[Aa01][Ab01]);
+					} // end for tasks
+					if(flag_record_time)	task_timer.stop();
+					if(ia01_fixed!=list_Aa01.size())
+						add_Ds_fixed(list_Aa01[ia01_fixed]);
 				} break; // end case a1b2_a2b0
 
 				default:
@@ -1231,14 +1768,41 @@ void LRI<TA,Tcell,Ndim,Tdata>::cal_loop3(
 			} // end switch(label)
 		} // end for label
 
-		LRI_Cal_Aux::add_Ds_omp_wait_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+		if(flag_add_Ds_owner)
+		{
+			#pragma omp barrier
+			LRI_Cal_Aux::add_Ds_omp_owner(Ds_result_threads, Ds_result, fac_add_Ds);
+		}
+		else
+		{
+			LRI_Cal_Aux::add_Ds_omp_wait_map(Ds_result_thread, Ds_result, lock_Ds_result_add_map, fac_add_Ds);
+		}
+
+		if(flag_record_time)
+		{
+			#pragma omp critical(LRI_cal_loop3_time_atoms)
+			for(const auto &time_atom : task_timer.time_atoms)
+				this->time_atoms[time_atom.first] += time_atom.second;
+		}
 	} // end #pragma omp parallel
 
+	for(Tensor_Pool<Tdata> &tensor_pool : this->tensor_pools)
+		tensor_pool.clear();
+
+	this->stat_cs = filter_atom_cs
+		? filter_atom_cs->get_statistics()
+		: std::unordered_map<Label::ab_ab, typename Filter_Atom_CS<TA,TC,Tdata>::Statistics>{};
+
 	LRI_Cal_Aux::destroy_lock_result(lock_Ds_result_add_map, Ds_result);
 
   #ifdef __MKL_RI
 	mkl_set_num_threads(mkl_threads);
   #endif
+
+	this->limit_Ds_ab_transpose();
+
+	if(this->flag_rebalance)
+		this->rebalance();
 }	// end LRI::cal_loop3()
 
 }	// end namespace RI
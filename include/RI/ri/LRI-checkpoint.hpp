@@ -0,0 +1,88 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "LRI.h"
+#include "../global/Checkpoint.h"
+
+#include <cstdint>
+
+namespace RI
+{
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void LRI<TA,Tcell,Ndim,Tdata>::write_checkpoint(std::ostream &os) const
+{
+	Checkpoint::write_header<TA,Tcell,Ndim,Tdata>(os);
+
+	Checkpoint::write(os, static_cast<std::uint64_t>(this->data_pool.size()));
+	for(const auto &data : this->data_pool)
+	{
+		const Data_Pack<TA,TC,Tdata> &data_pack = data.second;
+		Checkpoint::write(os, data.first);
+		Checkpoint::write(os, data_pack.label_list);
+		Checkpoint::write(os, data_pack.para);
+		if(data_pack.Ds_ab_disk)
+		{
+			std::vector<std::shared_ptr<const typename Tensors_Map2_Disk<TA,TAC,Tdata>::Block>> blocks_holder;
+			Checkpoint::write_tensors_map2(os, data_pack.Ds_ab,
+				[&data_pack, &blocks_holder](const TA &A0, const TAC &A1, const Tensor<Tdata>&) -> const Tensor<Tdata>&
+				{
+					blocks_holder.clear();
+					return data_pack.Ds_ab_disk->find(A0, A1, blocks_holder);
+				});
+		}
+		else
+		{
+			Checkpoint::write_tensors_map2(os, data_pack.Ds_ab);
+		}
+	}
+	Checkpoint::write(os, this->data_ab_name);
+
+	Checkpoint::write(os, static_cast<std::uint64_t>(this->parallel->list_A.size()));
+	for(const auto &list_A : this->parallel->list_A)
+	{
+		Checkpoint::write(os, list_A.first);
+		Checkpoint::write(os, list_A.second.a01);
+		Checkpoint::write(os, list_A.second.a2);
+		Checkpoint::write(os, list_A.second.b01);
+		Checkpoint::write(os, list_A.second.b2);
+	}
+	Checkpoint::check(os, __FILE__, __LINE__);
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void LRI<TA,Tcell,Ndim,Tdata>::read_checkpoint(std::istream &is)
+{
+	Checkpoint::read_header<TA,Tcell,Ndim,Tdata>(is);
+
+	this->data_pool.clear();
+	std::uint64_t size_pool;	Checkpoint::read(is, size_pool);
+	for(std::uint64_t i=0; i<size_pool; ++i)
+	{
+		std::string save_name;						Checkpoint::read(is, save_name);
+		std::vector<Label::ab> label_list;			Checkpoint::read(is, label_list);
+		std::map<std::string, double> para;			Checkpoint::read(is, para);
+		std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_ab = Checkpoint::read_tensors_map2<TA,TAC,Tdata>(is);
+		this->set_data_pack(save_name, std::move(Ds_ab), label_list, para);
+	}
+	Checkpoint::read(is, this->data_ab_name);
+
+	std::uint64_t size_list_A;	Checkpoint::read(is, size_list_A);
+	for(std::uint64_t i=0; i<size_list_A; ++i)
+	{
+		Label::Aab_Aab label;			Checkpoint::read(is, label);
+		List_A<TA,TAC> &list_A = this->parallel->list_A[label];
+		Checkpoint::read(is, list_A.a01);
+		Checkpoint::read(is, list_A.a2);
+		Checkpoint::read(is, list_A.b01);
+		Checkpoint::read(is, list_A.b2);
+	}
+	++this->parallel->version_list_A;
+	Checkpoint::check(is, __FILE__, __LINE__);
+}
+
+}
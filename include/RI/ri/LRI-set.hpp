@@ -11,6 +11,10 @@
 #include "../global/Map_Operator.h"
 #include "../global/MPI_Wrapper-func.h"
 #include <algorithm>
+#include <future>
+#include <stdexcept>
+#include <mpi.h>
+#include <omp.h>
 
 namespace RI
 {
@@ -31,52 +35,326 @@ void LRI<TA,Tcell,Ndim,Tdata>::set_parallel(
 }
 
 template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
-void LRI<TA,Tcell,Ndim,Tdata>::set_tensors_map2(
-	const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_local,
-	const std::vector<Label::ab> &label_list,
-	const std::map<std::string, double> &para_in,
-	const std::string &save_name_in)
+std::map<std::string, double> LRI<TA,Tcell,Ndim,Tdata>::get_para_set(
+	const std::map<std::string, double> &para_in) const
 {
 	const std::map<std::string, double> para_default = {
 		{"flag_period",      true},
 		{"flag_comm",        (MPI_Wrapper::mpi_get_size(this->mpi_comm)>1)
 		                     ? true : false},
+		{"flag_comm_plan",   false},
 		{"flag_filter",      true},
-		{"threshold_filter", 0.0}};
-	const std::map<std::string, double> para = Map_Operator::cover(para_default, para_in);
+		{"threshold_filter", 0.0},
+		{"flag_filter_comm", false},
+		{"flag_out_of_core", false},
+		{"flag_shared_memory", false},
+		{"memory_out_of_core_max", 1e9}};
+	return Map_Operator::cover(para_default, para_in);
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void LRI<TA,Tcell,Ndim,Tdata>::set_tensors_map2(
+	const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_local,
+	const std::vector<Label::ab> &label_list,
+	const std::map<std::string, double> &para_in,
+	const std::string &save_name_in)
+{
+	this->wait_tensors_map2();
+
+	const std::map<std::string, double> para = this->get_para_set(para_in);
+
+	const std::string save_name =
+		save_name_in!="default"
+		? save_name_in
+		: Label_Tools::get_name(label_list);
+
+	this->set_data_pack(save_name, this->cal_tensors_map2(Ds_local, label_list, para, save_name), label_list, para);
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+std::string LRI<TA,Tcell,Ndim,Tdata>::set_tensors_map2_async(
+	const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_local,
+	const std::vector<Label::ab> &label_list,
+	const std::map<std::string, double> &para_in,
+	const std::string &save_name_in)
+{
+	const std::map<std::string, double> para = this->get_para_set(para_in);
+
+	const std::string save_name =
+		save_name_in!="default"
+		? save_name_in
+		: Label_Tools::get_name(label_list);
+
+	if(para.at("flag_comm"))
+	{
+		int mpi_thread_provided;
+		MPI_Query_thread(&mpi_thread_provided);
+		if(mpi_thread_provided < MPI_THREAD_MULTIPLE)
+			throw std::runtime_error("set_tensors_map2_async() needs MPI_THREAD_MULTIPLE. "+std::string(__FILE__)+" line "+std::to_string(__LINE__));
+	}
+
+	const std::shared_future<void> done_prev
+		= this->sets_async.empty()
+		? std::shared_future<void>()
+		: this->sets_async.back().done;
+
+	this->sets_async.push_back(Set_Async());
+	Set_Async &set_async = this->sets_async.back();
+	set_async.save_name = save_name;
+	set_async.label_list = label_list;
+	set_async.para = para;
+	set_async.Ds_local = Ds_local;
+	set_async.done = std::async(std::launch::async, [this, &set_async, done_prev]()
+	{
+		omp_set_num_threads(1);			// leave the cores to cal_loop3()
+		if(done_prev.valid())
+			done_prev.wait();			// communications in the same order in all processes
+		set_async.Ds_new = this->cal_tensors_map2(set_async.Ds_local, set_async.label_list, set_async.para, set_async.save_name);
+	}).share();
+
+	return save_name;
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void LRI<TA,Tcell,Ndim,Tdata>::wait_tensors_map2(const std::string &save_name)
+{
+	if(!save_name.empty()
+		&& std::none_of(this->sets_async.begin(), this->sets_async.end(),
+			[&save_name](const Set_Async &set_async){ return set_async.save_name==save_name; }))
+		return;
+	while(!this->sets_async.empty())
+	{
+		Set_Async &set_async = this->sets_async.front();
+		set_async.done.get();				// rethrow exception of the thread
+		const bool flag_last = (set_async.save_name==save_name);
+		this->set_data_pack(set_async.save_name, std::move(set_async.Ds_new), set_async.label_list, set_async.para);
+		this->sets_async.pop_front();
+		if(flag_last)
+			break;
+	}
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+bool LRI<TA,Tcell,Ndim,Tdata>::judge_async(const Label::ab_ab &label) const
+{
+	const std::array<Label::ab,2> labels_ab = Label_Tools::split(label);
+	for(const Set_Async &set_async : this->sets_async)
+		for(const Label::ab &label_ab : set_async.label_list)
+			if(label_ab==Label::ab::a || label_ab==Label::ab::b || label_ab==labels_ab[0] || label_ab==labels_ab[1])
+				return true;
+	return false;
+}
 
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+std::map<TA, std::map<std::pair<TA,std::array<Tcell,Ndim>>, Tensor<Tdata>>> LRI<TA,Tcell,Ndim,Tdata>::cal_tensors_map2(
+	const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_local,
+	const std::vector<Label::ab> &label_list,
+	const std::map<std::string, double> &para,
+	const std::string &save_name)
+{
 	std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_new =
 		para.at("flag_period")
 		? RI_Tools::cal_period(Ds_local, this->period)
 		: Ds_local;
 
-	if(para.at("flag_comm"))
-		Ds_new = this->parallel->comm_tensors_map2(label_list, std::move(Ds_new));
+	std::vector<RI_Tools::T_filter_func<Tdata>> filter_func_list;
+	for(const Label::ab &label : label_list)
+		filter_func_list.push_back(this->filter_funcs[label]);
+	const bool flag_filter_comm = para.at("flag_filter") && para.at("flag_comm") && para.at("flag_filter_comm");
 
-	if(para.at("flag_filter"))
+	if(flag_filter_comm)
 	{
-		std::vector<RI_Tools::T_filter_func<Tdata>> filter_func_list;
-		for(const Label::ab &label : label_list)
-			filter_func_list.push_back(this->filter_funcs[label]);
+		const double bytes_before = RI_Tools::cal_memory(Ds_new);
 		Ds_new = RI_Tools::filter(std::move(Ds_new), filter_func_list, para.at("threshold_filter"));
+		for(const Label::ab &label : label_list)
+			this->bytes_filter_comm[label] = bytes_before - RI_Tools::cal_memory(Ds_new);
 	}
 
-	const std::string save_name =
-		save_name_in!="default"
-		? save_name_in
-		: Label_Tools::get_name(label_list);
+	if(para.at("flag_comm"))
+	{
+		std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_comm =
+			para.at("flag_comm_plan")
+			? this->parallel->comm_tensors_map2(label_list, Ds_new,
+				this->comm_plans[save_name+"_"+Label_Tools::get_name(label_list)])
+			: this->parallel->comm_tensors_map2(label_list, Ds_new);
+		std::size_t n_recv = 0;
+		for(const auto &Ds_A : Ds_comm)
+			for(const auto &D_A : Ds_A.second)
+				if(Global_Func::find(Ds_new, Ds_A.first, D_A.first).empty())
+					++n_recv;
+		for(const Label::ab &label : label_list)
+			this->n_tensors_comm[label] = n_recv;
+		Ds_new = std::move(Ds_comm);
+	}
+
+	if(para.at("flag_filter") && (!flag_filter_comm || para.at("flag_period")))
+		Ds_new = RI_Tools::filter(std::move(Ds_new), filter_func_list, para.at("threshold_filter"));
+
+	return Ds_new;
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void LRI<TA,Tcell,Ndim,Tdata>::set_data_pack(
+	const std::string &save_name,
+	std::map<TA, std::map<TAC, Tensor<Tdata>>> &&Ds_new,
+	const std::vector<Label::ab> &label_list,
+	const std::map<std::string, double> &para)
+{
 	for(const Label::ab &label : label_list)
 		this->data_ab_name[label] = save_name;
 
+	// release old files before written again with the same name
+	this->data_pool[save_name].Ds_ab_disk.reset();
+	this->data_pool[save_name].Ds_ab_transpose_disk.reset();
+
 	this->data_pool[save_name].Ds_ab = std::move(Ds_new);
 
 	this->data_pool[save_name].index_Ds_ab = RI_Tools::get_index(this->data_pool[save_name].Ds_ab);
+
+	this->data_pool[save_name].Ds_ab_frozen = Tensors_Map2_Frozen<TA,TAC,Tdata>(this->data_pool[save_name].Ds_ab);
+
+	Data_Pack<TA,TC,Tdata> &data_pack = this->data_pool[save_name];
+
+	data_pack.label_list = label_list;
+	data_pack.para = para;
+
+	data_pack.flag_transpose = false;
+	data_pack.Ds_ab_transpose.clear();
+
+	data_pack.Ds_ab_norm = RI_Tools::cal_norm(data_pack.Ds_ab);
+	this->set_Ds_ab_norm_max(data_pack);
+
+	if(para.at("flag_shared_memory"))
+	{
+		data_pack.Ds_ab_disk = std::make_shared<Tensors_Map2_Disk<TA,TAC,Tdata>>(
+			data_pack.Ds_ab,
+			this->mpi_comm,
+			para.at("memory_out_of_core_max"));
+		data_pack.Ds_ab = data_pack.Ds_ab_disk->get_shapes();
+		data_pack.Ds_ab_frozen = Tensors_Map2_Frozen<TA,TAC,Tdata>(data_pack.Ds_ab);
+	}
+	else if(para.at("flag_out_of_core"))
+	{
+		data_pack.Ds_ab_disk = std::make_shared<Tensors_Map2_Disk<TA,TAC,Tdata>>(
+			data_pack.Ds_ab,
+			this->prefix_out_of_core+save_name+"_"+std::to_string(MPI_Wrapper::mpi_get_rank(this->mpi_comm))+".bin",
+			para.at("memory_out_of_core_max"));
+		data_pack.Ds_ab = data_pack.Ds_ab_disk->get_shapes();
+		data_pack.Ds_ab_frozen = Tensors_Map2_Frozen<TA,TAC,Tdata>(data_pack.Ds_ab);
+	}
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void LRI<TA,Tcell,Ndim,Tdata>::set_Ds_ab_norm_max(Data_Pack<TA,TC,Tdata> &data_pack) const
+{
+	data_pack.Ds_ab_norm_max0.clear();
+	data_pack.Ds_ab_norm_max1.clear();
+	data_pack.Ds_ab_norm_max = 0;
+	data_pack.Ds_ab_norm_sum0.clear();
+	data_pack.Ds_ab_norm_sum1.clear();
+	data_pack.Ds_ab_norm_sum = 0;
+	for(const auto &norms_A : data_pack.Ds_ab_norm)
+		for(const auto &norm_A : norms_A.second)
+		{
+			data_pack.Ds_ab_norm_max0[norms_A.first]     = std::max(data_pack.Ds_ab_norm_max0[norms_A.first],     norm_A.second);
+			data_pack.Ds_ab_norm_max1[norm_A.first.first] = std::max(data_pack.Ds_ab_norm_max1[norm_A.first.first], norm_A.second);
+			data_pack.Ds_ab_norm_max                      = std::max(data_pack.Ds_ab_norm_max,                      norm_A.second);
+			data_pack.Ds_ab_norm_sum0[norms_A.first]     += norm_A.second;
+			data_pack.Ds_ab_norm_sum1[norm_A.first.first] += norm_A.second;
+			data_pack.Ds_ab_norm_sum                      += norm_A.second;
+		}
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void LRI<TA,Tcell,Ndim,Tdata>::add_tensors_map2(
+	const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_local,
+	const std::string &save_name,
+	const std::string &save_name_delta)
+{
+	this->wait_tensors_map2();
+
+	Data_Pack<TA,TC,Tdata> &data_pack = this->data_pool.at(save_name);
+	if(data_pack.Ds_ab_disk)
+		throw std::invalid_argument("out-of-core or shared "+save_name+" cannot be added. "+std::string(__FILE__)+" line "+std::to_string(__LINE__));
+
+	std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_new =
+		data_pack.para.at("flag_period")
+		? RI_Tools::cal_period(Ds_local, this->period)
+		: Ds_local;
+	// keys of Ds_local change with each call, so not by comm_plans
+	if(data_pack.para.at("flag_comm"))
+		Ds_new = this->parallel->comm_tensors_map2(data_pack.label_list, std::move(Ds_new));
+
+	// only tensors in Ds_new are replaced. D+D_new is a new tensor, for D may share memory with the input of set_tensors_map2().
+	bool flag_new_key = false;
+	for(const auto &Ds_A : Ds_new)
+		for(const auto &D_A : Ds_A.second)
+		{
+			Tensor<Tdata> &D = data_pack.Ds_ab[Ds_A.first][D_A.first];
+			if(D.empty())
+			{
+				D = D_A.second;
+				flag_new_key = true;
+			}
+			else
+			{
+				D = D + D_A.second;
+			}
+			data_pack.Ds_ab_norm[Ds_A.first][D_A.first] = D.norm(2);
+			if(!flag_new_key)
+				data_pack.Ds_ab_frozen.Ds[data_pack.Ds_ab_frozen.find_index(Ds_A.first, D_A.first).second] = D;
+		}
+	if(flag_new_key)
+	{
+		data_pack.index_Ds_ab = RI_Tools::get_index(data_pack.Ds_ab);
+		data_pack.Ds_ab_frozen = Tensors_Map2_Frozen<TA,TAC,Tdata>(data_pack.Ds_ab);
+	}
+	this->set_Ds_ab_norm_max(data_pack);
+
+	data_pack.flag_transpose = false;
+	data_pack.Ds_ab_transpose.clear();
+
+	if(!save_name_delta.empty())
+	{
+		const std::vector<Label::ab> label_list = data_pack.label_list;
+		const std::map<std::string, double> para = data_pack.para;
+		this->set_data_pack(save_name_delta, std::move(Ds_new), label_list, para);
+	}
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+bool LRI<TA,Tcell,Ndim,Tdata>::rebalance()
+{
+	this->wait_tensors_map2();
+
+	for(const auto &data : this->data_pool)
+		if(data.second.para.at("flag_comm") && data.second.Ds_ab_disk)
+			throw std::invalid_argument("out-of-core or shared "+data.first+" cannot be redistributed. "+std::string(__FILE__)+" line "+std::to_string(__LINE__));
+
+	if(!this->parallel->rebalance(this->time_atoms))
+		return false;
+
+	// set_data_pack() points data_ab_name to each data pack in turn
+	const std::unordered_map<Label::ab, std::string> data_ab_name = this->data_ab_name;
+	for(auto &data : this->data_pool)
+	{
+		if(!data.second.para.at("flag_comm"))
+			continue;
+		std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_new = this->parallel->redistribute_tensors_map2(data.second.label_list, data.second.Ds_ab);
+		// copy, since data.second is overwritten in set_data_pack()
+		const std::vector<Label::ab> label_list = data.second.label_list;
+		const std::map<std::string, double> para = data.second.para;
+		this->set_data_pack(data.first, std::move(Ds_new), label_list, para);
+	}
+	this->data_ab_name = data_ab_name;
+	return true;
 }
 
 template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
 void LRI<TA,Tcell,Ndim,Tdata>::free_tensors_map2(
 	const std::string &save_name)
 {
+	this->wait_tensors_map2();
 	this->data_pool.erase(save_name);
 }
 
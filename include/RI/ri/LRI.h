@@ -8,11 +8,14 @@
 #include "LRI_Cal_Tools.h"
 #include "Label.h"
 #include "../global/Tensor.h"
+#include "../global/Tensor_Pool.h"
 #include "Data_Pack.h"
 #include "../parallel/Parallel_LRI_Equally.h"
+#include "../comm/mix/Communicate_Tensors_Map_Plan.h"
 #include "RI_Tools.h"
 #include "../global/Global_Func-2.h"
 #include "Filter_Atom.h"
+#include "Filter_Atom_CS.h"
 
 #include <mpi.h>
 #include <array>
@@ -22,6 +25,9 @@
 #include <unordered_map>
 #include <memory>
 #include <functional>
+#include <limits>
+#include <list>
+#include <future>
 
 namespace RI
 {
@@ -53,16 +59,70 @@ public:
 			// para:
 			//     "flag_period",      true
 			//     "flag_comm",        true
+			//     "flag_comm_plan",   false		// communicate by comm_plans[save_name], reused while the keys of Ds_local and list_A are unchanged
 			//     "flag_filter",      true
 			//     "threshold_filter", 0.0
+			//     "flag_filter_comm", false		// filter before communication, so that tensors filtered out are not sent. Filtered again after communication only if "flag_period",
+			//                         			// for the periodic images of a tensor in different processes are summed there. Assume the other keys of Ds_local different among processes.
+			//     "flag_out_of_core", false		// write tensors to file prefix_out_of_core by blocks of A0, and read them back when used in cal_loop3()
+			//     "memory_out_of_core_max", 1e9	// bytes of blocks kept in memory if flag_out_of_core or flag_shared_memory, the least recently used released first
+			//     "flag_shared_memory", false	// keep tensors once for all processes of the same node in MPI-3 shared memory, instead of file of flag_out_of_core,
+			//                         			// and copy them by blocks of A0 when used in cal_loop3(). For several processes on one node with the same tensors, e.g. Cs and Vs.
+			//                         			// Tensor owns its data by shared_ptr<valarray> and cannot alias the window, so the blocks copied are bounded only by
+			//                         			// "memory_out_of_core_max" in each process, besides the window once in the node.
 			// save_name:              Label_Tools::get_name(label)
 	void free_tensors_map2(
 		const std::string &save_name);
 
+	// set_tensors_map2() returning at once, with its period, communication and filter in a dedicated thread,
+	// one set_tensors_map2_async() after another in the order called, the same in all processes.
+	// data_pool[save_name] is set in wait_tensors_map2(), called by cal_loop3() only before the labels needing it,
+	// so that the labels with all tensors already set are calculated during the communication.
+	// Needs MPI_THREAD_MULTIPLE if "flag_comm". This LRI must not be moved before waited.
+	// return save_name, the handle for wait_tensors_map2().
+	std::string set_tensors_map2_async(
+		const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_local,
+		const std::vector<Label::ab> &label_list,
+		const std::map<std::string, double> &para_in = {},
+		const std::string &save_name_in = "default");
+	// wait set_tensors_map2_async() of save_name and all called before it, or all if save_name is empty.
+	// Other functions setting data_pool or communicating wait all first.
+	void wait_tensors_map2(const std::string &save_name="");
+
+	// data_pool[save_name].Ds_ab += Ds_local, periodic and communicated by the para of its set_tensors_map2(),
+	// with only the tensors of Ds_local communicated and patched in place. Not for "flag_out_of_core" or "flag_shared_memory".
+	// If save_name_delta is not empty, data_pool[save_name_delta] is set to the added tensors, e.g. for cal_loop3() of the difference.
+	void add_tensors_map2(
+		const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_local,
+		const std::string &save_name,
+		const std::string &save_name_delta="");
+
+	// data_pool and parallel->list_A in the binary format of Checkpoint, one stream for each process.
+	// read_checkpoint() after set_parallel() with the same processes, instead of set_tensors_map2() and its communication.
+	void write_checkpoint(std::ostream &os) const;
+	void read_checkpoint(std::istream &is);
+
+	// Ds_result may be in higher precision than Tdata, e.g. LRI<...,float> adding into Tensor<double>.
+	template<typename Tdata_result>
 	void cal_loop3(
 		const std::vector<Label::ab_ab> &labels,
-		std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_result,
-		const double fac_add_Ds = 1.0);
+		std::map<TA, std::map<TAC, Tensor<Tdata_result>>> &Ds_result,
+		const double fac_add_Ds = 1.0,
+		const std::map<std::string, double> &para_in = {});
+			// para:
+			//     "flag_gemm_batch",  false		// collect gemm of the last contractions and calculate them together
+			//     "flag_tensor_pool", false	// reuse memory of temporary tensors in each thread, see Tensor_Pool
+			//     "flag_add_Ds_owner", false	// keep results in each thread and add them to Ds_result at the end, each thread owning different atoms of Ds_result, instead of locks
+			//     "flag_sort_tasks",  false		// start from the tasks with larger atoms, estimated by the shapes of D_a and D_b
+			//     "flag_record_time", false		// record wall time of tasks into time_atoms, always true if flag_rebalance
+			//     "flag_order_a01b01_a01b01", false	// for a0b0_a1b1 and a0b1_a1b0 only, contract D_a with D_a1b? first instead of D_a0b?, if cheaper for the shapes of each task. Needs transposes of D_a and D_b
+
+	// parallel->rebalance() with time_atoms, and if list_A changed, redistribute data_pool by parallel->redistribute_tensors_map2(),
+	// i.e. only the tensors required by a process and not in it yet are sent to it.
+	// Data packs set with "flag_comm"=false are set in each process by the user, and kept as they are.
+	// Not for data packs with "flag_comm" and "flag_out_of_core" or "flag_shared_memory".
+	// return whether list_A changed.
+	bool rebalance();
 
 public:
 	std::shared_ptr<Parallel_LRI<TA,Tcell,Ndim,Tdata>>
@@ -70,12 +130,33 @@ public:
 	std::unordered_map< Label::ab, RI_Tools::T_filter_func<Tdata> >
 		filter_funcs;
 	std::shared_ptr<Filter_Atom<TA,TAC>> filter_atom = std::make_shared<Filter_Atom<TA,TAC>>();
+	std::unordered_map<Label::ab_ab, Tdata_real> threshold_cs;		// Cauchy-Schwarz screening in cal_loop3() for labels in threshold_cs
+	std::unordered_map<Label::ab_ab, typename Filter_Atom_CS<TA,TC,Tdata>::Statistics> stat_cs;		// of the last cal_loop3()
+	bool flag_rebalance = false;					// rebalance() at the end of each cal_loop3()
+	std::map<TA,double> time_atoms;					// time_atoms[A]: wall time of tasks involving atom A in the last cal_loop3() of this process
+	double memory_transpose_max = std::numeric_limits<double>::max();		// bytes of Data_Pack::Ds_ab_transpose kept in data_pool after cal_loop3(). If exceeded, all are released and calculated again when needed.
+	std::unordered_map<Label::ab, std::size_t> n_tensors_comm;	// n_tensors_comm[label]: number of tensors of this process received from others in the last set_tensors_map2() of label with "flag_comm", for comparing parallel schemes
+	std::unordered_map<Label::ab, double> bytes_filter_comm;		// bytes_filter_comm[label]: bytes of tensors in this process not sent in the last set_tensors_map2() of label with "flag_filter_comm"
+	std::string prefix_out_of_core = "./LRI_";		// files prefix_out_of_core+save_name+"_"+rank+".bin" of set_tensors_map2() with "flag_out_of_core", better on node-local scratch
 
 public:		// private:
 	TC period;
 	MPI_Comm mpi_comm;
 	std::map<std::string, Data_Pack<TA,TC,Tdata>> data_pool;
 	std::unordered_map<Label::ab, std::string> data_ab_name;
+	std::vector<Tensor_Pool<Tdata>> tensor_pools;		// tensor_pools[thread], counters of the last cal_loop3()
+	std::map<std::string, Communicate_Tensors_Map_Plan<TA,TC,Tdata>> comm_plans;		// comm_plans[save_name+labels]
+
+	struct Set_Async
+	{
+		std::string save_name;
+		std::vector<Label::ab> label_list;
+		std::map<std::string, double> para;
+		std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_local;
+		std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_new;		// set in the thread
+		std::shared_future<void> done;
+	};
+	std::list<Set_Async> sets_async;		// set_tensors_map2_async() not waited yet, in the order called
 
 public:		// private:
 	using T_cal_func = std::function<void(
@@ -87,6 +168,29 @@ public:		// private:
 		std::unordered_map<Label::ab_ab, Tdata_real> &Ds_b01_csm,
 		LRI_Cal_Tools<TA,TC,Tdata> &tools)>;
 	std::unordered_map<Label::ab_ab, T_cal_func> cal_funcs;
+
+	// Data_Pack::Ds_ab_transpose of data_ab_name[label], calculated if not yet.
+	const std::map<TA, std::map<TAC, Tensor<Tdata>>> &get_Ds_ab_transpose(const Label::ab &label);
+	// release all Data_Pack::Ds_ab_transpose if their memory exceeds memory_transpose_max.
+	void limit_Ds_ab_transpose();
+
+	std::map<std::string, double> get_para_set(const std::map<std::string, double> &para_in) const;
+	// Ds_local periodic, distributed and filtered, by para of set_tensors_map2()
+	std::map<TA, std::map<TAC, Tensor<Tdata>>> cal_tensors_map2(
+		const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_local,
+		const std::vector<Label::ab> &label_list,
+		const std::map<std::string, double> &para,
+		const std::string &save_name);
+	// whether label needs tensors of sets_async
+	bool judge_async(const Label::ab_ab &label) const;
+	// data_pool[save_name] from Ds_new already periodic, distributed and filtered.
+	void set_data_pack(
+		const std::string &save_name,
+		std::map<TA, std::map<TAC, Tensor<Tdata>>> &&Ds_new,
+		const std::vector<Label::ab> &label_list,
+		const std::map<std::string, double> &para);
+	// Data_Pack::Ds_ab_norm_max0, Ds_ab_norm_max1, Ds_ab_norm_max and Ds_ab_norm_sum* from Ds_ab_norm.
+	void set_Ds_ab_norm_max(Data_Pack<TA,TC,Tdata> &data_pack) const;
 };
 
 }
@@ -94,3 +198,4 @@ public:		// private:
 #include "LRI.hpp"
 #include "LRI-set.hpp"
 #include "LRI-cal_loop3.hpp"
+#include "LRI-checkpoint.hpp"
@@ -7,6 +7,7 @@
 
 #include "LRI.h"
 #include "../ri/Label.h"
+#include "LRI_Cal_Aux.h"
 #include <limits>
 
 namespace RI
@@ -28,4 +29,45 @@ LRI<TA,Tcell,Ndim,Tdata>::LRI()
 		this->period[i] = std::numeric_limits<Tcell>::max()/4;		// /4 for not out of range when Array_Operator::operator%
 }
 
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+const std::map<TA, std::map<std::pair<TA,std::array<Tcell,Ndim>>, Tensor<Tdata>>> &
+LRI<TA,Tcell,Ndim,Tdata>::get_Ds_ab_transpose(const Label::ab &label)
+{
+	Data_Pack<TA,TC,Tdata> &data_pack = this->data_pool.at(this->data_ab_name.at(label));
+	if(!data_pack.flag_transpose)
+	{
+		if(data_pack.Ds_ab_disk && data_pack.Ds_ab_disk->flag_shared())
+			data_pack.Ds_ab_transpose_disk = std::make_shared<Tensors_Map2_Disk<TA,TAC,Tdata>>(
+				*data_pack.Ds_ab_disk,
+				LRI_Cal_Aux::tensor3_transpose<Tdata>,
+				data_pack.Ds_ab_disk->memory_max);
+		else if(data_pack.Ds_ab_disk)
+			data_pack.Ds_ab_transpose_disk = std::make_shared<Tensors_Map2_Disk<TA,TAC,Tdata>>(
+				*data_pack.Ds_ab_disk,
+				LRI_Cal_Aux::tensor3_transpose<Tdata>,
+				data_pack.Ds_ab_disk->file_name+".transpose",
+				data_pack.Ds_ab_disk->memory_max);
+		else
+			data_pack.Ds_ab_transpose = LRI_Cal_Aux::cal_Ds_transpose(data_pack.Ds_ab);
+		data_pack.flag_transpose = true;
+	}
+	return data_pack.Ds_ab_transpose;		// empty if Ds_ab_transpose_disk, read by LRI_Cal_Tools::get_Ds_ab_transpose()
+}
+
+template<typename TA, typename Tcell, std::size_t Ndim, typename Tdata>
+void LRI<TA,Tcell,Ndim,Tdata>::limit_Ds_ab_transpose()
+{
+	double memory = 0;
+	for(const auto &data_pack : this->data_pool)
+		memory += RI_Tools::cal_memory(data_pack.second.Ds_ab_transpose);
+	if(memory <= this->memory_transpose_max)
+		return;
+	for(auto &data_pack : this->data_pool)
+	{
+		if(data_pack.second.Ds_ab_transpose_disk)	continue;		// on disk or in shared memory, not counted
+		data_pack.second.flag_transpose = false;
+		data_pack.second.Ds_ab_transpose.clear();
+	}
+}
+
 }
\ No newline at end of file
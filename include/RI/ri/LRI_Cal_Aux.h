@@ -12,6 +12,10 @@
 #include "../parallel/Parallel_LRI.h"
 
 #include <map>
+#include <set>
+#include <vector>
+#include <array>
+#include <algorithm>
 #include <memory.h>
 #include <cassert>
 #include <stdexcept>
@@ -83,6 +87,17 @@ namespace LRI_Cal_Aux
 		}
 	}
 
+	// D_result in different precision from D_add
+	template<typename Tdata_add, typename Tdata_result>
+	inline void add_Ds(
+		Tensor<Tdata_add> &&D_add,
+		Tensor<Tdata_result> &D_result,
+		const double fac = 1.0)
+	{
+		add_Ds(Global_Func::convert<Tdata_result>(D_add), D_result, fac);
+		D_add = Tensor<Tdata_add>();
+	}
+
 	template<typename Tkey, typename Tvalue>
 	void add_Ds(
 		std::map<Tkey, Tvalue> &&Ds_add,
@@ -101,6 +116,18 @@ namespace LRI_Cal_Aux
 		}
 	}
 
+	// Ds_result in different precision from Ds_add
+	template<typename Tkey, typename Tvalue_add, typename Tvalue_result>
+	void add_Ds(
+		std::map<Tkey, Tvalue_add> &&Ds_add,
+		std::map<Tkey, Tvalue_result> &Ds_result,
+		const double fac = 1.0)
+	{
+		for(auto &&Ds_add_A : Ds_add)
+			add_Ds(std::move(Ds_add_A.second), Ds_result[Ds_add_A.first], fac);
+		Ds_add.clear();
+	}
+
 	/*
 	template<typename Tvalue>
 	void add_Ds(
@@ -160,10 +187,10 @@ namespace LRI_Cal_Aux
 		}
 	}
 
-	template<typename TA, typename TAC, typename Tdata>
+	template<typename TA, typename TAC, typename Tdata, typename Tdata_result>
 	void add_Ds_omp_try_map(
 		std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_result_thread,
-		std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_result,
+		std::map<TA, std::map<TAC, Tensor<Tdata_result>>> &Ds_result,
 		std::map<TA, omp_lock_t> &lock_Ds_result_add_map,
 		const double &fac)
 	{
@@ -183,10 +210,10 @@ namespace LRI_Cal_Aux
 		}
 	}
 
-	template<typename TA, typename TAC, typename Tdata>
+	template<typename TA, typename TAC, typename Tdata, typename Tdata_result>
 	void add_Ds_omp_wait_map(
 		std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_result_thread,
-		std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_result,
+		std::map<TA, std::map<TAC, Tensor<Tdata_result>>> &Ds_result,
 		std::map<TA, omp_lock_t> &lock_Ds_result_add_map,
 		const double &fac)
 	{
@@ -201,6 +228,39 @@ namespace LRI_Cal_Aux
 		}
 	}
 
+	// Ds_result[A0] += fac * sum_thread Ds_result_threads[thread][A0].
+	// Called by all threads in #pragma omp parallel, after all Ds_result_threads are finished.
+	// Each thread owns different A0, so no lock is needed.
+	// A0 not yet in Ds_result are inserted first by one thread.
+	template<typename TA, typename TAC, typename Tdata, typename Tdata_result>
+	void add_Ds_omp_owner(
+		std::vector<std::map<TA, std::map<TAC, Tensor<Tdata>>>> &Ds_result_threads,
+		std::map<TA, std::map<TAC, Tensor<Tdata_result>>> &Ds_result,
+		const double &fac)
+	{
+		#pragma omp single
+		for(const auto &Ds_result_thread : Ds_result_threads)
+			for(const auto &Ds_result_thread_A : Ds_result_thread)
+				Ds_result[Ds_result_thread_A.first];
+
+		std::vector<std::pair<const TA, std::map<TAC, Tensor<Tdata_result>>>*> Ds_result_list;
+		Ds_result_list.reserve(Ds_result.size());
+		for(auto &Ds_result_A : Ds_result)
+			Ds_result_list.push_back(&Ds_result_A);
+
+		#pragma omp for schedule(dynamic)
+		for(std::size_t iA=0; iA<Ds_result_list.size(); ++iA)
+		{
+			const TA &key = Ds_result_list[iA]->first;
+			for(auto &Ds_result_thread : Ds_result_threads)
+			{
+				const auto ptr = Ds_result_thread.find(key);
+				if(ptr==Ds_result_thread.end())	continue;
+				LRI_Cal_Aux::add_Ds(std::move(ptr->second), Ds_result_list[iA]->second, fac);
+			}
+		}
+	}
+
 	/*
 	template<typename T>
 	inline bool judge_Ds_empty(const std::vector<T> &Ds)
@@ -338,6 +398,121 @@ namespace LRI_Cal_Aux
 		return list_filter;
 	}
 
+	// For D[A0][{A1,C1}] of shape {N0,N1,N2},
+	// sizes[0][A0] = N0*N1, sizes[1][A1] = N2.
+	template<typename TA, typename TAC, typename Tdata>
+	std::array<std::map<TA,std::size_t>,2> cal_atom_sizes(
+		const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds)
+	{
+		std::array<std::map<TA,std::size_t>,2> sizes;
+		for(const auto &Ds_A : Ds)
+			for(const auto &D_A : Ds_A.second)
+			{
+				if(D_A.second.shape.size()!=3)	continue;
+				sizes[0][Ds_A.first] = D_A.second.shape[0] * D_A.second.shape[1];
+				sizes[1][D_A.first.first] = D_A.second.shape[2];
+			}
+		return sizes;
+	}
+
+	template<typename TA>
+	inline std::size_t get_atom_size(const std::map<TA,std::size_t> &sizes, const TA &A)
+	{
+		const auto ptr = sizes.find(A);
+		return (ptr==sizes.end()) ? 1 : ptr->second;
+	}
+	template<typename TA, typename TC>
+	inline std::size_t get_atom_size(const std::map<TA,std::size_t> &sizes, const std::pair<TA,TC> &A)
+	{
+		return get_atom_size(sizes, A.first);
+	}
+
+	// Estimated cost of Txyz(x2,y1,z1) = Tx(a,b,x2) * Ty(a,y1) * Tz(b,z1) in the order
+	//     Tmp(b,x2,y1) = Tx(a,b,x2) * Ty(a,y1),  Txyz(x2,y1,z1) = Tmp(b,x2,y1) * Tz(b,z1),
+	// i.e. flops of the two gemm plus the sizes of Tmp and Txyz written.
+	inline double cost_x2y1z1_abx2_ay1_bz1(
+		const std::size_t na, const std::size_t nb, const std::size_t nx2, const std::size_t ny1, const std::size_t nz1)
+	{
+		const double n_tmp = static_cast<double>(nb) * nx2 * ny1;
+		return n_tmp * na + n_tmp * nz1 + n_tmp + static_cast<double>(nx2) * ny1 * nz1;
+	}
+
+	// Flatten the outer loop over list_x and the inner loop over list_y into tasks {ix,iy}, skipping x with filter_x(x).
+	// Tasks with the same ix are contiguous.
+	// Each thread calls get_tasks() for itself, so filter_x should be thread-safe and free of side effects as Filter_Atom.
+	// If flag_sort, the cost of {ix,iy} is estimated by sizes_x[x]*sizes_y[y],
+	//     and tasks with larger costs go first, i.e. sort x by sizes_x and y by sizes_y.
+	// Else, in the order of list_x and list_y.
+	template<typename TA, typename Tx, typename Ty, typename Tfilter>
+	std::vector<std::array<std::size_t,2>> get_tasks(
+		const std::vector<Tx> &list_x, const std::vector<Ty> &list_y,
+		const std::map<TA,std::size_t> &sizes_x, const std::map<TA,std::size_t> &sizes_y,
+		const bool flag_sort,
+		const Tfilter &filter_x)
+	{
+		std::vector<std::size_t> ixs;
+		ixs.reserve(list_x.size());
+		for(std::size_t ix=0; ix<list_x.size(); ++ix)
+			if(!filter_x(list_x[ix]))
+				ixs.push_back(ix);
+
+		std::vector<std::size_t> iys(list_y.size());
+		for(std::size_t iy=0; iy<list_y.size(); ++iy)
+			iys[iy] = iy;
+
+		if(flag_sort)
+		{
+			std::stable_sort(ixs.begin(), ixs.end(),
+				[&](const std::size_t ix0, const std::size_t ix1)
+				{ return get_atom_size(sizes_x, list_x[ix0]) > get_atom_size(sizes_x, list_x[ix1]); });
+			std::stable_sort(iys.begin(), iys.end(),
+				[&](const std::size_t iy0, const std::size_t iy1)
+				{ return get_atom_size(sizes_y, list_y[iy0]) > get_atom_size(sizes_y, list_y[iy1]); });
+		}
+
+		std::vector<std::array<std::size_t,2>> tasks;
+		tasks.reserve(ixs.size() * iys.size());
+		for(const std::size_t ix : ixs)
+			for(const std::size_t iy : iys)
+				tasks.push_back({ix, iy});
+		return tasks;
+	}
+
+	template<typename TA>
+	inline const TA &get_atom(const TA &A){ return A; }
+	template<typename TA, typename TC>
+	inline const TA &get_atom(const std::pair<TA,TC> &A){ return A.first; }
+
+	// Wall time of tasks {x,y} in one thread, half to atom x and half to atom y.
+	// A task lasts from its start() to the next start() or stop().
+	template<typename TA>
+	class Task_Timer
+	{
+	public:
+		template<typename Tx, typename Ty>
+		void start(const Tx &x, const Ty &y)
+		{
+			this->stop();
+			this->atom_x = get_atom(x);
+			this->atom_y = get_atom(y);
+			this->time_begin = omp_get_wtime();
+			this->flag_running = true;
+		}
+		void stop()
+		{
+			if(!this->flag_running)	return;
+			const double time = omp_get_wtime() - this->time_begin;
+			this->time_atoms[this->atom_x] += time/2;
+			this->time_atoms[this->atom_y] += time/2;
+			this->flag_running = false;
+		}
+		std::map<TA,double> time_atoms;
+	private:
+		TA atom_x, atom_y;
+		double time_begin = 0;
+		bool flag_running = false;
+	};
+
 	template<typename TA, typename TAC, typename Tdata>
 	std::map<TA, omp_lock_t> init_lock_result(
 		const std::vector<Label::ab_ab> &labels,
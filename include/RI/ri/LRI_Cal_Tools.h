@@ -11,9 +11,17 @@
 #include "RI/global/Tensor.h"
 #include "RI/global/Global_Func-1.h"
 #include "RI/global/Array_Operator.h"
+#include "RI/global/Tensors_Map2_Frozen.h"
+#include "RI/global/Tensors_Map2_Disk.h"
 
 #include <map>
 #include <unordered_map>
+#include <array>
+#include <vector>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <omp.h>
 
 namespace RI
 {
@@ -34,19 +42,34 @@ public:
 			:period(period_in)
 	{
 		this->Ds_ab_ptr.reserve(Label::array_ab.size());
+		this->Ds_ab_frozen_ptr.fill(nullptr);
+		this->Ds_ab_disk_ptr.fill(nullptr);
+		this->data_pack_ptr.fill(nullptr);
 		for(const auto &name : data_ab_name)
 		{
 			if(!name.second.empty())
-				this->Ds_ab_ptr[name.first] = &data_pool.at(name.second).Ds_ab;
+			{
+				const Data_Pack<TA,TC,Tdata> &data_pack = data_pool.at(name.second);
+				this->Ds_ab_ptr[name.first] = &data_pack.Ds_ab;
+				this->Ds_ab_frozen_ptr[static_cast<std::size_t>(name.first)] = &data_pack.Ds_ab_frozen;
+				this->Ds_ab_disk_ptr[static_cast<std::size_t>(name.first)] = data_pack.Ds_ab_disk.get();
+				this->data_pack_ptr[static_cast<std::size_t>(name.first)] = &data_pack;
+			}
 		}
+		this->blocks_holder.resize(omp_get_max_threads());
 	}
 
+	// For out-of-core Data_Pack, the tensor returned is valid until release_blocks() in the same thread.
 	inline const Tensor<Tdata> &get_Ds_ab(
 		const Label::ab &label,
 		const TA &Aa, const TAC &Ab) const
 	{
-		return Global_Func::find(
-			*this->Ds_ab_ptr.at(label),
+		const Tensors_Map2_Disk<TA,TAC,Tdata>*const Ds_disk = this->Ds_ab_disk_ptr[static_cast<std::size_t>(label)];
+		if(Ds_disk)
+			return Ds_disk->find(Aa, Ab, this->blocks_holder[omp_get_thread_num()]);
+		if(!this->Ds_ab_frozen_ptr[static_cast<std::size_t>(label)])
+			throw std::invalid_argument("label "+Label_Tools::get_name(label)+" has no data pack in "+std::string(__FILE__)+" line "+std::to_string(__LINE__));
+		return this->Ds_ab_frozen_ptr[static_cast<std::size_t>(label)]->find(
 			Aa, Ab);
 	}
 	inline const Tensor<Tdata> &get_Ds_ab(
@@ -54,9 +77,44 @@ public:
 		const TAC &Aa, const TAC &Ab) const
 	{
 		using namespace Array_Operator;
-		return Global_Func::find(
-			*this->Ds_ab_ptr.at(label),
-			Aa.first, TAC{Ab.first, (Ab.second-Aa.second)%this->period});
+		return this->get_Ds_ab(label, Aa.first, TAC{Ab.first, (Ab.second-Aa.second)%this->period});
+	}
+
+	// only shape is valid for out-of-core Data_Pack
+	inline const Tensor<Tdata> &get_Ds_ab_shape(
+		const Label::ab &label,
+		const TA &Aa, const TAC &Ab) const
+	{
+		if(!this->Ds_ab_frozen_ptr[static_cast<std::size_t>(label)])
+			throw std::invalid_argument("label "+Label_Tools::get_name(label)+" has no data pack in "+std::string(__FILE__)+" line "+std::to_string(__LINE__));
+		return this->Ds_ab_frozen_ptr[static_cast<std::size_t>(label)]->find(
+			Aa, Ab);
+	}
+	inline const Tensor<Tdata> &get_Ds_ab_shape(
+		const Label::ab &label,
+		const TAC &Aa, const TAC &Ab) const
+	{
+		using namespace Array_Operator;
+		return this->get_Ds_ab_shape(label, Aa.first, TAC{Ab.first, (Ab.second-Aa.second)%this->period});
+	}
+
+	// Ds_transpose[Aa][Ab] for Ds_transpose from LRI::get_Ds_ab_transpose(label), or read from Data_Pack::Ds_ab_transpose_disk.
+	inline const Tensor<Tdata> &get_Ds_ab_transpose(
+		const Label::ab &label,
+		const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds_transpose,
+		const TA &Aa, const TAC &Ab) const
+	{
+		// Ds_ab_transpose_disk may be created after constructor
+		const Tensors_Map2_Disk<TA,TAC,Tdata>*const Ds_disk = this->data_pack_ptr[static_cast<std::size_t>(label)]->Ds_ab_transpose_disk.get();
+		if(Ds_disk)
+			return Ds_disk->find(Aa, Ab, this->blocks_holder[omp_get_thread_num()]);
+		return Global_Func::find(Ds_transpose, Aa, Ab);
+	}
+
+	// release blocks of out-of-core Data_Pack held by get_Ds_ab() in this thread, called at the beginning of each task.
+	inline void release_blocks() const
+	{
+		this->blocks_holder[omp_get_thread_num()].clear();
 	}
 
 	inline std::vector<Label::ab> split_b01(const Label::ab_ab &label) const
@@ -92,12 +150,12 @@ public:
 				switch(a)
 				{
 					case 0:	case 1:
-						if(!this->get_Ds_ab(label_ab, Aa01, Ab01).empty())
+						if(!this->get_Ds_ab_shape(label_ab, Aa01, Ab01).empty())
 							return true;
 						else
 							continue;
 					case 2:
-						if(!this->get_Ds_ab(label_ab, Aa2, Ab01).empty())
+						if(!this->get_Ds_ab_shape(label_ab, Aa2, Ab01).empty())
 							return true;
 						else
 							continue;
@@ -117,14 +175,18 @@ public:
 		return labels_filter;
 	}
 
-	std::tuple<std::map<TA, std::map<TAC, Tensor<Tdata>>>, std::map<TA, std::map<TAC, Tensor<Tdata>>>>
-	cal_Ds_transpose(const std::vector<Label::ab_ab> &labels) const
+	// whether {Ds_a, Ds_b} need to be transposed for labels
+	std::array<bool,2> judge_Ds_transpose(const std::vector<Label::ab_ab> &labels, const bool flag_order_a01b01_a01b01=false) const
 	{
-		const bool flag_D_a_transpose = [&labels]() -> bool
+		// flag_order_a01b01_a01b01: a0b0_a1b1 and a0b1_a1b0 may be calculated in the other order, which needs D_a_transpose and D_b_transpose.
+		const bool flag_D_a_transpose = [&labels, flag_order_a01b01_a01b01]() -> bool
 		{
 			for(const Label::ab_ab &label : labels)
 				switch(label)
 				{
+					case Label::ab_ab::a0b0_a1b1:
+						if(flag_order_a01b01_a01b01)	return true;
+						break;
 					case Label::ab_ab::a0b1_a1b0:
 					case Label::ab_ab::a0b0_a1b2:
 					case Label::ab_ab::a0b2_a1b1:
@@ -140,11 +202,15 @@ public:
 				}
 			return false;
 		}();
-		const bool flag_D_b_transpose = [&labels]() -> bool
+		const bool flag_D_b_transpose = [&labels, flag_order_a01b01_a01b01]() -> bool
 		{
 			for(const Label::ab_ab &label : labels)
 				switch(label)
 				{
+					case Label::ab_ab::a0b0_a1b1:
+					case Label::ab_ab::a0b1_a1b0:
+						if(flag_order_a01b01_a01b01)	return true;
+						break;
 					case Label::ab_ab::a0b0_a2b2:
 					case Label::ab_ab::a1b0_a2b2:
 					case Label::ab_ab::a1b1_a2b2:
@@ -154,29 +220,16 @@ public:
 			return false;
 		}();
 
-		if(flag_D_a_transpose && flag_D_b_transpose && (this->Ds_ab_ptr.at(Label::ab::a)==this->Ds_ab_ptr.at(Label::ab::b)) )
-		{
-			const std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_a_transpose
-				= LRI_Cal_Aux::cal_Ds_transpose( *this->Ds_ab_ptr.at(Label::ab::a) );
-			return std::make_tuple(Ds_a_transpose, Ds_a_transpose);
-		}
-		else
-		{
-			const std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_a_transpose
-				= flag_D_a_transpose
-				? LRI_Cal_Aux::cal_Ds_transpose( *this->Ds_ab_ptr.at(Label::ab::a) )
-				: std::map<TA, std::map<TAC, Tensor<Tdata>>>{};
-			const std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_b_transpose
-				= flag_D_b_transpose
-				? LRI_Cal_Aux::cal_Ds_transpose( *this->Ds_ab_ptr.at(Label::ab::b) )
-				: std::map<TA, std::map<TAC, Tensor<Tdata>>>{};
-			return std::make_tuple(Ds_a_transpose, Ds_b_transpose);
-		}
+		return {flag_D_a_transpose, flag_D_b_transpose};
 	}
 
 public:		// private:
 	const TC &period;
 	std::unordered_map<Label::ab, const std::map<TA, std::map<TAC, Tensor<Tdata>>>*> Ds_ab_ptr;
+	std::array<const Tensors_Map2_Frozen<TA,TAC,Tdata>*, Label::array_ab.size()> Ds_ab_frozen_ptr;		// Ds_ab_frozen_ptr[label]
+	std::array<const Tensors_Map2_Disk<TA,TAC,Tdata>*, Label::array_ab.size()> Ds_ab_disk_ptr;				// nullptr if not out-of-core
+	std::array<const Data_Pack<TA,TC,Tdata>*, Label::array_ab.size()> data_pack_ptr;
+	mutable std::vector<std::vector<std::shared_ptr<const typename Tensors_Map2_Disk<TA,TAC,Tdata>::Block>>> blocks_holder;	// blocks_holder[thread]
 };
 
 }
\ No newline at end of file
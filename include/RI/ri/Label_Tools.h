@@ -6,6 +6,7 @@
 #pragma once
 
 #include "Label.h"
+#include <array>
 #include <string>
 #include <vector>
 #include <set>
@@ -159,6 +160,33 @@ namespace Label_Tools
 		}
 	}
 
+	// a0b1_a1b2 -> {a0b1, a1b2}
+	inline std::array<Label::ab,2> split(const Label::ab_ab &label)
+	{
+		switch(label)
+		{
+			case Label::ab_ab::a1b1_a2b2:	return {Label::ab::a1b1, Label::ab::a2b2};
+			case Label::ab_ab::a1b2_a2b1:	return {Label::ab::a1b2, Label::ab::a2b1};
+			case Label::ab_ab::a1b0_a2b2:	return {Label::ab::a1b0, Label::ab::a2b2};
+			case Label::ab_ab::a1b2_a2b0:	return {Label::ab::a1b2, Label::ab::a2b0};
+			case Label::ab_ab::a1b0_a2b1:	return {Label::ab::a1b0, Label::ab::a2b1};
+			case Label::ab_ab::a1b1_a2b0:	return {Label::ab::a1b1, Label::ab::a2b0};
+			case Label::ab_ab::a0b1_a2b2:	return {Label::ab::a0b1, Label::ab::a2b2};
+			case Label::ab_ab::a0b2_a2b1:	return {Label::ab::a0b2, Label::ab::a2b1};
+			case Label::ab_ab::a0b0_a2b2:	return {Label::ab::a0b0, Label::ab::a2b2};
+			case Label::ab_ab::a0b2_a2b0:	return {Label::ab::a0b2, Label::ab::a2b0};
+			case Label::ab_ab::a0b0_a2b1:	return {Label::ab::a0b0, Label::ab::a2b1};
+			case Label::ab_ab::a0b1_a2b0:	return {Label::ab::a0b1, Label::ab::a2b0};
+			case Label::ab_ab::a0b1_a1b2:	return {Label::ab::a0b1, Label::ab::a1b2};
+			case Label::ab_ab::a0b2_a1b1:	return {Label::ab::a0b2, Label::ab::a1b1};
+			case Label::ab_ab::a0b0_a1b2:	return {Label::ab::a0b0, Label::ab::a1b2};
+			case Label::ab_ab::a0b2_a1b0:	return {Label::ab::a0b2, Label::ab::a1b0};
+			case Label::ab_ab::a0b0_a1b1:	return {Label::ab::a0b0, Label::ab::a1b1};
+			case Label::ab_ab::a0b1_a1b0:	return {Label::ab::a0b1, Label::ab::a1b0};
+			default:	throw std::invalid_argument(std::string(__FILE__)+" line "+std::to_string(__LINE__));
+		}
+	}
+
 	inline Label::Aab to_Aab(const Label::ab &label)
 	{
 		switch(label)
@@ -8,12 +8,15 @@
 #include "../global/Tensor.h"
 #include "../global/Global_Func-2.h"
 #include <map>
+#include <vector>
+#include <functional>
 
 namespace RI
 {
 
 namespace RI_Tools
 {
+	// filter_func is called in parallel by OpenMP threads
 	template<typename Tdata>
 	using T_filter_func =
 		std::function<bool(
@@ -30,11 +33,27 @@ namespace RI_Tools
 		const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds,
 		const std::vector<T_filter_func<Tdata>> &filter_func_list,
 		const Global_Func::To_Real_t<Tdata> &threshold);
+	// tensors filtered out are erased from Ds, and the others moved to the result without copying the maps
+	template<typename TA, typename TAC, typename Tdata>
+	extern std::map<TA, std::map<TAC, Tensor<Tdata>>> filter(
+		std::map<TA, std::map<TAC, Tensor<Tdata>>> &&Ds,
+		const std::vector<T_filter_func<Tdata>> &filter_func_list,
+		const Global_Func::To_Real_t<Tdata> &threshold);
 
 	template<typename TA, typename TC, typename Tdata>
 	extern std::map<TA, std::map<std::pair<TA,TC>, Tensor<Tdata>>> cal_period(
 		const std::map<TA, std::map<std::pair<TA,TC>, Tensor<Tdata>>> &Ds,
 		const TC &period);
+
+	// bytes of data of all tensors in Ds
+	template<typename TA, typename TAC, typename Tdata>
+	extern double cal_memory(
+		const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds);
+
+	// norms[A0][A1] = ||Ds[A0][A1]||_F
+	template<typename TA, typename TAC, typename Tdata>
+	extern std::map<TA, std::map<TAC, Global_Func::To_Real_t<Tdata>>> cal_norm(
+		const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds);
 }
 
 }
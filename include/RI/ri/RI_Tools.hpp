@@ -8,24 +8,48 @@
 #include "RI_Tools.h"
 #include "../global/Array_Operator.h"
 
+#include <vector>
+#include <iterator>
+
 namespace RI
 {
 
 namespace RI_Tools
 {
+	// pointers of all tensors of Ds, in order
+	template<typename TA, typename TAC, typename Tdata>
+	std::vector<const Tensor<Tdata>*> get_Ds_ptr(const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds)
+	{
+		std::vector<const Tensor<Tdata>*> Ds_ptr;
+		for(const auto &Ds_A : Ds)
+			for(const auto &D_A : Ds_A.second)
+				Ds_ptr.push_back(&D_A.second);
+		return Ds_ptr;
+	}
+
+	// whether D passes any of filter_func_list
+	template<typename Tdata>
+	inline bool judge_filter(
+		const Tensor<Tdata> &D,
+		const std::vector<T_filter_func<Tdata>> &filter_func_list,
+		const Global_Func::To_Real_t<Tdata> &threshold)
+	{
+		for(const auto &filter_func : filter_func_list)
+			if(filter_func( D, threshold ))
+				return true;
+		return false;
+	}
+
 	template<typename TA, typename TAC, typename Tdata>
 	std::map<TA, std::map<TAC, Tensor<Tdata>>> filter(
 		const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds,
 		const T_filter_func<Tdata> &filter_func,
 		const Global_Func::To_Real_t<Tdata> &threshold)
 	{
-		std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_filter;
-		for(const auto &Ds_tmp0 : Ds)
-			for(const auto &Ds_tmp1 : Ds_tmp0.second)
-				if(filter_func( Ds_tmp1.second, threshold ))
-					Ds_filter[Ds_tmp0.first][Ds_tmp1.first] = Ds_tmp1.second;
-		return Ds_filter;
+		return filter(Ds, std::vector<T_filter_func<Tdata>>{filter_func}, threshold);
 	}
+
+	// each Ds[A0] filtered by one thread
 	template<typename TA, typename TAC, typename Tdata>
 	std::map<TA, std::map<TAC, Tensor<Tdata>>> filter(
 		const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds,
@@ -33,18 +57,50 @@ namespace RI_Tools
 		const Global_Func::To_Real_t<Tdata> &threshold)
 	{
 		std::map<TA, std::map<TAC, Tensor<Tdata>>> Ds_filter;
-		for(const auto &Ds_tmp0 : Ds)
-			for(const auto &Ds_tmp1 : Ds_tmp0.second)
-				for(const auto &filter_func : filter_func_list)
-					if(filter_func( Ds_tmp1.second, threshold ))
-					{
-						Ds_filter[Ds_tmp0.first][Ds_tmp1.first] = Ds_tmp1.second;
-						break;
-					}
+		std::vector<std::pair<
+			const std::map<TAC, Tensor<Tdata>>*,
+			std::map<TAC, Tensor<Tdata>>*>> Ds_list;		// {&Ds[A0], &Ds_filter[A0]}
+		for(const auto &Ds_A : Ds)
+			if(!Ds_A.second.empty())
+				Ds_list.push_back({&Ds_A.second, &Ds_filter.emplace_hint(Ds_filter.end(), Ds_A.first, std::map<TAC, Tensor<Tdata>>{})->second});
+
+		#pragma omp parallel for schedule(dynamic)
+		for(std::size_t i=0; i<Ds_list.size(); ++i)
+		{
+			std::map<TAC, Tensor<Tdata>> &Ds_filter_A = *Ds_list[i].second;
+			for(const auto &D_A : *Ds_list[i].first)
+				if(judge_filter(D_A.second, filter_func_list, threshold))
+					Ds_filter_A.emplace_hint(Ds_filter_A.end(), D_A.first, D_A.second);
+		}
+
+		for(auto Ds_A=Ds_filter.begin(); Ds_A!=Ds_filter.end(); )
+			Ds_A = Ds_A->second.empty() ? Ds_filter.erase(Ds_A) : std::next(Ds_A);
 		return Ds_filter;
 	}
 
+	// each Ds[A0] filtered by one thread, erasing and freeing the tensors filtered out
+	template<typename TA, typename TAC, typename Tdata>
+	std::map<TA, std::map<TAC, Tensor<Tdata>>> filter(
+		std::map<TA, std::map<TAC, Tensor<Tdata>>> &&Ds,
+		const std::vector<T_filter_func<Tdata>> &filter_func_list,
+		const Global_Func::To_Real_t<Tdata> &threshold)
+	{
+		std::vector<std::map<TAC, Tensor<Tdata>>*> Ds_list;
+		for(auto &Ds_A : Ds)
+			Ds_list.push_back(&Ds_A.second);
+
+		#pragma omp parallel for schedule(dynamic)
+		for(std::size_t i=0; i<Ds_list.size(); ++i)
+			for(auto D_A=Ds_list[i]->begin(); D_A!=Ds_list[i]->end(); )
+				D_A = judge_filter(D_A->second, filter_func_list, threshold) ? std::next(D_A) : Ds_list[i]->erase(D_A);
+
+		for(auto Ds_A=Ds.begin(); Ds_A!=Ds.end(); )
+			Ds_A = Ds_A->second.empty() ? Ds.erase(Ds_A) : std::next(Ds_A);
+		return std::move(Ds);
+	}
+
 
+	// each Ds[A0] folded by one thread
 	template<typename TA, typename TC, typename Tdata>
 	std::map<TA, std::map<std::pair<TA,TC>, Tensor<Tdata>>> cal_period(
 		const std::map<TA, std::map<std::pair<TA,TC>, Tensor<Tdata>>> &Ds,
@@ -52,15 +108,26 @@ namespace RI_Tools
 	{
 		using namespace Array_Operator;
 		std::map<TA, std::map<std::pair<TA,TC>, Tensor<Tdata>>> Ds_period;
-		for(const auto &Ds_tmp0 : Ds)
+		std::vector<std::pair<
+			const std::map<std::pair<TA,TC>, Tensor<Tdata>>*,
+			std::map<std::pair<TA,TC>, Tensor<Tdata>>*>> Ds_list;		// {&Ds[A0], &Ds_period[A0]}
+		for(const auto &Ds_A : Ds)
+			if(!Ds_A.second.empty())
+				Ds_list.push_back({&Ds_A.second, &Ds_period.emplace_hint(Ds_period.end(), Ds_A.first, std::map<std::pair<TA,TC>, Tensor<Tdata>>{})->second});
+
+		#pragma omp parallel for schedule(dynamic)
+		for(std::size_t i=0; i<Ds_list.size(); ++i)
 		{
-			for(const auto &Ds_tmp1 : Ds_tmp0.second)
+			std::map<std::pair<TA,TC>, Tensor<Tdata>> &Ds_period_A = *Ds_list[i].second;
+			for(const auto &D_A : *Ds_list[i].first)
 			{
-				Tensor<Tdata> &D_period = Ds_period[Ds_tmp0.first][{Ds_tmp1.first.first, Ds_tmp1.first.second % period}];
+				Tensor<Tdata> &D_period = Ds_period_A[{D_A.first.first, D_A.first.second % period}];
 				if(D_period.empty())
-					D_period = Ds_tmp1.second;					// share memory
+					D_period = D_A.second;					// share memory
+				else if(D_period.data.use_count()>1)
+					D_period = D_period + D_A.second;		// new tensor
 				else
-					D_period = D_period + Ds_tmp1.second;		// new tensor
+					D_period += D_A.second;					// new tensor of this function
 			}
 		}
 		return Ds_period;
@@ -77,6 +144,39 @@ namespace RI_Tools
 		index[0] = std::move(index_i);
 		return index;
 	}
+
+	template<typename TA, typename TAC, typename Tdata>
+	double cal_memory(
+		const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds)
+	{
+		double memory = 0;
+		for(const auto &Ds_A : Ds)
+			for(const auto &D_A : Ds_A.second)
+				memory += static_cast<double>(D_A.second.get_shape_all()) * sizeof(Tdata);
+		return memory;
+	}
+
+	template<typename TA, typename TAC, typename Tdata>
+	std::map<TA, std::map<TAC, Global_Func::To_Real_t<Tdata>>> cal_norm(
+		const std::map<TA, std::map<TAC, Tensor<Tdata>>> &Ds)
+	{
+		const std::vector<const Tensor<Tdata>*> Ds_ptr = get_Ds_ptr(Ds);
+		std::vector<Global_Func::To_Real_t<Tdata>> norms_list(Ds_ptr.size());
+		#pragma omp parallel for schedule(dynamic,16)
+		for(std::size_t i=0; i<Ds_ptr.size(); ++i)
+			norms_list[i] = Ds_ptr[i]->norm(2);
+
+		std::map<TA, std::map<TAC, Global_Func::To_Real_t<Tdata>>> norms;
+		std::size_t i = 0;
+		for(const auto &Ds_A : Ds)
+		{
+			if(Ds_A.second.empty())	continue;
+			std::map<TAC, Global_Func::To_Real_t<Tdata>> &norms_A = norms.emplace_hint(norms.end(), Ds_A.first, std::map<TAC, Global_Func::To_Real_t<Tdata>>{})->second;
+			for(const auto &Ds_B : Ds_A.second)
+				norms_A.emplace_hint(norms_A.end(), Ds_B.first, norms_list[i++]);
+		}
+		return norms;
+	}
 }
 
 }
\ No newline at end of file
@@ -13,10 +13,12 @@
 #include "unittests/global/Tensor-test-2.hpp"
 #include "unittests/global/Tensor-test-3.hpp"
 #include "unittests/global/Tensor_Multiply-test.hpp"
+#include "unittests/global/Tensor_Multiply_Accumulate-test.hpp"
 #include "unittests/global/Map_Operator-test.hpp"
 //#include "unittests/ri/LRI-loop4-test.hpp"
 #include "unittests/ri/LRI-loop3-test.hpp"
 #include "unittests/ri/LRI-speed-test.hpp"
+#include "unittests/ri/LRI-feature-test.hpp"
 #include "unittests/ri/Cell_Nearest-test.hpp"
 #include "unittests/physics/Exx-test.hpp"
 #include "unittests/physics/RPA-test.hpp"
@@ -33,6 +35,8 @@ namespace Test_All
 		Communicate_Tensors_Test::test_comm_judge_map3_first(argc, argv);
 		Communicate_Tensors_Test::test_comm_judge_map2_period(argc, argv);
 		Communicate_Tensors_Test::test_comm_judge_map3_period(argc, argv);
+		Communicate_Tensors_Test::test_comm_plan_map2_period(argc, argv);
+		Communicate_Tensors_Test::test_comm_plan_cereal(argc, argv);
 
 		Distribute_Equally_Test::test_distribute_atoms(argc, argv);
 		Distribute_Equally_Test::test_distribute_atoms_periods(argc, argv);
@@ -42,16 +46,22 @@ namespace Test_All
 		Divide_Atoms_Test::test_divide_atoms();
 		Divide_Atoms_Test::test_divide_atoms_with_period();
 		Divide_Atoms_Test::test_divide_atoms_periods();
+		Divide_Atoms_Test::test_divide_atoms_weighted();
+		Divide_Atoms_Test::test_sort_hilbert();
 
 		Split_Processes_Test::test_split_all(argc, argv);
 
 		Blas_Test::test_all();
+		Blas_Test::gemm_small<double>();
+		Blas_Test::gemm_small<float>();
 
 		Tensor_Test::test_multiply_2();
 		Tensor_Test::test_operator_all_3();
 
 		Tensor_Multiply_Test::main<double>();
 		Tensor_Multiply_Test::main<std::complex<double>>();
+		Tensor_Multiply_Accumulate_Test::main<double>();
+		Tensor_Multiply_Accumulate_Test::main<std::complex<double>>();
 
 		Map_Operator_Test::test_union_map1();
 		Map_Operator_Test::test_union_map2();
@@ -76,12 +86,40 @@ namespace Test_All
 		LRI_Speed_Test::test_speed<std::complex<float>>(argc, argv, 1, 1);
 		LRI_Speed_Test::test_speed<std::complex<double>>(argc, argv, 1, 1);
 
+
+		LRI_Feature_Test::test_gemm_batch<double>(argc, argv, 6, 3);
+		LRI_Feature_Test::test_gemm_batch<std::complex<double>>(argc, argv, 6, 3);
+		LRI_Feature_Test::test_sort_tasks<double>(argc, argv, 6, 2);
+		LRI_Feature_Test::test_add_Ds_owner<double>(argc, argv, 6, 2);
+		LRI_Feature_Test::test_weighted<double>(argc, argv, 6, 2, 8);
+		LRI_Feature_Test::test_rebalance<double>(argc, argv, 6, 2, 3);
+		LRI_Feature_Test::test_order_a01b01_a01b01<double>(argc, argv);
+		LRI_Feature_Test::test_order_a01b01_a01b01<std::complex<double>>(argc, argv);
+		LRI_Feature_Test::test_transpose_cache<double>(argc, argv, 6, 2, 3);
+		LRI_Feature_Test::test_out_of_core<double>(argc, argv, 6, 2);
+		LRI_Feature_Test::test_small_blocks<double>(argc, argv, 20, 2, 4);
+		LRI_Feature_Test::test_set_tensors<double>(argc, argv, 20, 3, 8, 1E-3);
+		LRI_Feature_Test::test_set_tensors<std::complex<double>>(argc, argv, 20, 3, 8, 1E-3);
+		LRI_Feature_Test::test_filter_comm<double>(argc, argv, 20, 3, 1E-2);
+		LRI_Feature_Test::test_async<double>(argc, argv, 20, 3);
+		LRI_Feature_Test::test_shared_memory<double>(argc, argv, 6, 2);
+		LRI_Feature_Test::test_spatial<double>(argc, argv, 24, 2, 1E-1);
+		LRI_Feature_Test::test_tensor_pool<double>(argc, argv, 6, 3);
+		LRI_Feature_Test::test_Ds_ab_changed<double>(argc, argv, 6, 3);
+		LRI_Feature_Test::test_cs<double>(argc, argv, 12, 2, 0.05, 1E-4);
+
 		Cell_Nearest_Test::main();
 
 		Exx_Test::main<float>(argc, argv);
 		Exx_Test::main<double>(argc, argv);
 		Exx_Test::main<std::complex<float>>(argc, argv);
 		Exx_Test::main<std::complex<double>>(argc, argv);
+		Exx_Test::test_float<double>(argc, argv, 4, 20, 10);
+		Exx_Test::test_float<std::complex<double>>(argc, argv, 4, 20, 10);
+		Exx_Test::test_checkpoint<double>(argc, argv, 4, 20, 10);
+		Exx_Test::test_checkpoint<std::complex<double>>(argc, argv, 4, 20, 10);
+		Exx_Test::test_Ds_delta<double>(argc, argv, 4, 20, 10, 6, 0);
+		Exx_Test::test_Ds_delta<double>(argc, argv, 4, 20, 10, 6, 1E-3);
 
 		RPA_Test::main<float>(argc, argv);
 		RPA_Test::main<double>(argc, argv);
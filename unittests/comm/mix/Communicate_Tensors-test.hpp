@@ -6,6 +6,7 @@
 #pragma once
 
 #include "RI/comm/mix/Communicate_Tensors_Map_Judge.h"
+#include "RI/comm/mix/Communicate_Tensors_Map_Plan.h"
 #include "RI/global/MPI_Wrapper.h"
 #include "unittests/global/Tensor-test.h"
 #include "unittests/print_stl.h"
@@ -14,6 +15,7 @@
 #include <map>
 #include <set>
 #include <fstream>
+#include <cassert>
 
 namespace Communicate_Tensors_Test
 {
@@ -303,4 +305,116 @@ namespace Communicate_Tensors_Test
 		MPI_Finalize();
 	}
 
+	// same as test_comm_judge_map2_period(), through Communicate_Tensors_Map_Plan twice
+	static void test_comm_plan_map2_period(int argc, char *argv[])
+	{
+		int mpi_init_provide;	MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+		const int rank_mine = RI::MPI_Wrapper::mpi_get_rank(MPI_COMM_WORLD);
+		using TC = std::array<int,1>;
+		using TAC = std::pair<int,TC>;
+		std::map<int,std::map<TAC,RI::Tensor<double>>> Ds_in;
+		std::set<int> s;
+		std::set<TAC> s0;
+		std::set<TAC> s1;
+		for(int i=0; i<10; ++i)
+			s1.insert({i,{i}});
+		if(rank_mine==0)
+		{
+			for(int i=0; i<6; ++i)
+				Ds_in[i][{i,{0}}]=init_Tensor(i);
+			s={2,3,5,7,11,13};
+		}
+		else if(rank_mine==1)
+		{
+			for(int i=0; i<10; i+=2)
+				Ds_in[i][{i,{0}}]=init_Tensor(10*i);
+			s={7,6,5,4,3};
+		}
+		else if(rank_mine==2)
+		{
+			for(int i=0; i<10; i+=3)
+				Ds_in[i][{i,{0}}]=init_Tensor(100*i);
+		}
+		else if(rank_mine==3)
+		{
+			s={3,1,4};
+		}
+		for(const int is : s)
+			s0.insert({is,{0}});
+		std::tuple<
+			std::vector<std::tuple< std::set<int>, std::set<TAC> >>,
+			std::vector<std::tuple< std::set<TAC>, std::set<TAC> >>> s_list;
+		std::get<1>(s_list).push_back(std::make_tuple(s0, s1));
+
+		RI::Communicate_Tensors_Map_Plan<int,TC,double> plan;
+		std::ofstream ofs("out."+std::to_string(rank_mine));
+		for(int i=0; i<2; ++i)
+		{
+			const bool flag_plan = plan.check(MPI_COMM_WORLD, Ds_in, 0);
+			if(!flag_plan)
+				plan.set_plan(MPI_COMM_WORLD, Ds_in, RI::Communicate_Tensors_Map_Judge::get_judge_combine_origin_period(s_list, TC{1}), 0);
+			std::map<int,std::map<TAC,RI::Tensor<double>>> Ds_out = plan.communicate(MPI_COMM_WORLD, Ds_in);
+			ofs<<flag_plan<<std::endl<<Ds_out<<std::endl;
+		}
+		MPI_Finalize();
+	}
+
+	// cereal serialization in comm_map2_combine_origin_period and MPI derived datatypes in Communicate_Tensors_Map_Plan get the same tensors,
+	// with the plan set once and reused
+	static void test_comm_plan_cereal(int argc, char *argv[])
+	{
+		int mpi_init_provide;	MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+		const int rank_mine = RI::MPI_Wrapper::mpi_get_rank(MPI_COMM_WORLD);
+		const int rank_size = RI::MPI_Wrapper::mpi_get_size(MPI_COMM_WORLD);
+		using TC = std::array<int,1>;
+		using TAC = std::pair<int,TC>;
+		const int natom = 40;
+		const int nbasis = 20;
+		std::map<int,std::map<TAC,RI::Tensor<double>>> Ds_in;
+		for(int ia0=rank_mine; ia0<natom; ia0+=rank_size)
+			for(int ia1=0; ia1<natom; ++ia1)
+			{
+				RI::Tensor<double> D({nbasis,nbasis});
+				for(std::size_t i=0; i<D.get_shape_all(); ++i)
+					D.ptr()[i] = ia0+0.01*ia1+1E-6*i;
+				Ds_in[ia0][{ia1,{0}}] = D;
+			}
+		std::set<int> s0;
+		std::set<TAC> s1;
+		for(int ia=0; ia<natom; ++ia)
+			if(ia%3==rank_mine%3)
+			{
+				s0.insert(ia);
+				s1.insert({ia,{0}});
+			}
+		std::tuple<
+			std::vector<std::tuple< std::set<int>, std::set<TAC> >>,
+			std::vector<std::tuple< std::set<TAC>, std::set<TAC> >>> s_list;
+		std::get<0>(s_list).push_back(std::make_tuple(s0, s1));
+
+		const std::map<int,std::map<TAC,RI::Tensor<double>>> Ds_cereal
+			= RI::Communicate_Tensors_Map_Judge::comm_map2_combine_origin_period(MPI_COMM_WORLD, Ds_in, s_list, TC{1});
+
+		RI::Communicate_Tensors_Map_Plan<int,TC,double> plan;
+		for(int iloop=0; iloop<2; ++iloop)
+		{
+			const bool flag_plan = plan.check(MPI_COMM_WORLD, Ds_in, 0);
+			assert(flag_plan == (iloop>0));
+			if(!flag_plan)
+				plan.set_plan(MPI_COMM_WORLD, Ds_in, RI::Communicate_Tensors_Map_Judge::get_judge_combine_origin_period(s_list, TC{1}), 0);
+			std::map<int,std::map<TAC,RI::Tensor<double>>> Ds_plan = plan.communicate(MPI_COMM_WORLD, Ds_in);
+
+			assert(Ds_cereal.size()==Ds_plan.size());
+			for(const auto &Ds_A : Ds_cereal)
+				for(const auto &D_B : Ds_A.second)
+				{
+					const RI::Tensor<double> &D_plan = Ds_plan[Ds_A.first][D_B.first];
+					assert(D_plan.get_shape_all()==D_B.second.get_shape_all());
+					for(std::size_t i=0; i<D_plan.get_shape_all(); ++i)
+						assert(D_plan.ptr()[i]==D_B.second.ptr()[i]);
+				}
+		}
+		MPI_Finalize();
+	}
+
 }
\ No newline at end of file
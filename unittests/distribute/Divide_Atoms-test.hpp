@@ -67,4 +67,49 @@ namespace Divide_Atoms_Test
 		{ 21, 0	 }|	{ 21, 1	 }|	{ 22, 0	 }|	{ 22, 1	 }|	{ 23, 0	 }|	{ 23, 1	 }|	{ 24, 0	 }|	{ 24, 1	 }|	{ 25, 0	 }|	{ 25, 1	 }|
 		{ 26, 0	 }|	{ 26, 1	 }|	{ 27, 0	 }|	{ 27, 1	 }|	{ 28, 0	 }|	{ 28, 1	 }|	{ 29, 0	 }|	{ 29, 1	 }|	{ 30, 0	 }|	{ 30, 1	 }|
 	*/
+
+
+	static void test_divide_atoms_weighted()
+	{
+		const std::size_t group_size = 4;
+		std::vector<std::size_t> atoms(10);
+		std::map<std::size_t,double> atoms_weight;
+		for(std::size_t i=0; i<atoms.size(); ++i)
+		{
+			atoms[i]=i;
+			atoms_weight[i] = (i<2) ? 8 : 1;
+		}
+		const std::array<int,1> period = {2};
+		for(std::size_t i=0; i<group_size; ++i)
+			std::cout<<RI::Divide_Atoms::divide_atoms_weighted(i, group_size, atoms, atoms_weight)<<std::endl;
+		for(std::size_t i=0; i<group_size; ++i)
+			std::cout<<RI::Divide_Atoms::divide_atoms_periods_weighted(i, group_size, atoms, period, atoms_weight)<<std::endl;
+	}
+	/*
+		0|
+		1|
+		2|	3|	4|	5|
+		6|	7|	8|	9|
+		{ 0, 0	 }|	{ 0, -1	 }|
+		{ 1, 0	 }|
+		{ 1, -1	 }|	{ 2, 0	 }|	{ 2, -1	 }|	{ 3, 0	 }|	{ 3, -1	 }|
+		{ 4, 0	 }|	{ 4, -1	 }|	{ 5, 0	 }|	{ 5, -1	 }|	{ 6, 0	 }|	{ 6, -1	 }|	{ 7, 0	 }|	{ 7, -1	 }|	{ 8, 0	 }|	{ 8, -1	 }|	{ 9, 0	 }|	{ 9, -1	 }|
+	*/
+
+
+	static void test_sort_hilbert()
+	{
+		// atoms x*4+y on 4*4 grid
+		std::vector<std::size_t> atoms(16);
+		std::vector<std::array<double,2>> positions(16);
+		for(std::size_t i=0; i<atoms.size(); ++i)
+		{
+			atoms[i] = i;
+			positions[i] = {double(i/4), double(i%4)};
+		}
+		std::cout<<RI::Divide_Atoms::sort_hilbert(atoms, positions)<<std::endl;
+	}
+	/*
+		0|	4|	5|	1|	2|	3|	7|	6|	10|	11|	15|	14|	13|	9|	8|	12|
+	*/
 }
\ No newline at end of file
@@ -6,11 +6,17 @@
 #pragma once
 
 #include <vector>
+#include <array>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+#include <type_traits>
 
 #include "RI/global/Blas_Interface.h"
 #include "RI/global/Blas_Interface-Contiguous.h"
 #include "RI/global/Blas_Interface-Tensor.h"
+#include "RI/global/Blas_Small.h"
 #include "RI/global/Tensor.h"
 #include "../global/Tensor-test-3.hpp"
 
@@ -187,6 +193,47 @@ namespace Blas_Test
 	}
 #endif
 
+	// Blas_Small::gemm() equals ?gemm_ for all trans, alpha and beta,
+	// for block sizes of atoms with 1,5,9,13,14 orbitals or 3,9,14 auxiliary basis, and n>16 by gemm_general()
+	template<typename Tdata>
+	void gemm_small()
+	{
+		const double eps = std::is_same<Tdata,float>::value ? 1E-5 : 1E-12;
+		const std::vector<std::array<int,3>> sizes = {
+			{1,1,1}, {5,5,5}, {9,9,9}, {13,13,13}, {14,14,14},
+			{25,5,3}, {81,9,9}, {196,14,14}, {5,5,25}, {14,9,14}, {3,17,70}, {7,25,5}};
+		for(const std::array<int,3> &size : sizes)
+		{
+			const int m=size[0], n=size[1], k=size[2];
+			for(const char transA : {'N','T','C'})
+				for(const char transB : {'N','T','C'})
+					for(const Tdata alpha : {Tdata(1), Tdata(0), Tdata(-0.7)})
+						for(const Tdata beta : {Tdata(0), Tdata(1), Tdata(0.5)})
+						{
+							std::vector<Tdata> A(m*k), B(k*n), C_blas(m*n), C_small(m*n);
+							for(std::size_t i=0; i<A.size(); ++i)	A[i] = std::sin(i);
+							for(std::size_t i=0; i<B.size(); ++i)	B[i] = std::cos(i);
+							for(std::size_t i=0; i<C_blas.size(); ++i)	C_blas[i] = C_small[i] = i;
+							const int ldA = (transA=='N') ? k : m;
+							const int ldB = (transB=='N') ? n : k;
+							RI::Blas_Interface::gemm(transA, transB, m, n, k, alpha, A.data(), ldA, B.data(), ldB, beta, C_blas.data(), n);
+							RI::Blas_Small::gemm(transA, transB, m, n, k, alpha, A.data(), B.data(), beta, C_small.data());
+							for(std::size_t i=0; i<C_blas.size(); ++i)
+								assert(std::abs(C_blas[i]-C_small[i]) <= eps * (1+std::abs(C_blas[i])));
+						}
+		}
+
+		// Blas_Interface::gemm() without ld calculated by Blas_Small only with __RI_GEMM_SMALL
+		Tdata A=1, B=2, C=0;
+	#ifdef __RI_GEMM_SMALL
+		assert(RI::Blas_Small::gemm_try('N', 'N', 1, 1, 1, Tdata(1), &A, &B, Tdata(0), &C));
+		assert(C==Tdata(2));
+	#else
+		assert(!RI::Blas_Small::gemm_try('N', 'N', 1, 1, 1, Tdata(1), &A, &B, Tdata(0), &C));
+		assert(C==Tdata(0));
+	#endif
+	}
+
 	static void test_all()
 	{
 		nrm2<float>();
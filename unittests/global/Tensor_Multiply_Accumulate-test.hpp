@@ -0,0 +1,67 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include "Tensor_Multiply-test.hpp"
+#include "RI/global/Tensor_Multiply_Accumulate.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace Tensor_Multiply_Accumulate_Test
+{
+	// compare Txy = alpha * Tx * Ty + beta * Txy with the result of Tensor_Multiply
+	template<typename Tdata, typename Tfunc>
+	void accumulate_test(const RI::Shape_Vector &shape_x, const RI::Shape_Vector &shape_y, const Tfunc &func)
+	{
+		const Tdata alpha = 2, beta = 3;
+		const RI::Tensor<Tdata> Tx = Tensor_Multiply_Test::init_tensor<Tdata>(shape_x);
+		const RI::Tensor<Tdata> Ty = Tensor_Multiply_Test::init_tensor<Tdata>(shape_y);
+		const RI::Tensor<Tdata> Txy_mul = func(Tx, Ty);
+
+		RI::Tensor<Tdata> Txy_new;
+		func(Tx, Ty, Txy_new, alpha, beta);
+		for(std::size_t i=0; i<Txy_mul.get_shape_all(); ++i)
+			assert(std::abs(Txy_new.ptr()[i] - alpha * Txy_mul.ptr()[i]) < 1E-10);
+
+		const RI::Tensor<Tdata> Txy_old = Tensor_Multiply_Test::init_tensor<Tdata>(Txy_mul.shape);
+		RI::Tensor<Tdata> Txy = Txy_old.copy();
+		func(Tx, Ty, Txy, alpha, beta);
+		for(std::size_t i=0; i<Txy_mul.get_shape_all(); ++i)
+			assert(std::abs(Txy.ptr()[i] - (alpha * Txy_mul.ptr()[i] + beta * Txy_old.ptr()[i])) < 1E-10);
+	}
+
+	#define ACCUMULATE_TEST(func, ...)	\
+		accumulate_test<Tdata>(__VA_ARGS__, [](auto&&... args){ return RI::Tensor_Multiply::func(std::forward<decltype(args)>(args)...); });
+
+	template<typename Tdata>
+	void main()
+	{
+		const std::size_t X0=2, X1=3, Y0=4, Y1=5, A=6, B=7;
+		ACCUMULATE_TEST(x0y0_x0a_y0a,				{X0,A},		{Y0,A})
+		ACCUMULATE_TEST(x0y1_x0a_ay1,				{X0,A},		{A,Y1})
+		ACCUMULATE_TEST(x1y0_ax1_y0a,				{A,X1},		{Y0,A})
+		ACCUMULATE_TEST(x1y1_ax1_ay1,				{A,X1},		{A,Y1})
+		ACCUMULATE_TEST(x0y0y1_x0a_y0y1a,			{X0,A},		{Y0,Y1,A})
+		ACCUMULATE_TEST(x0y1y2_x0a_ay1y2,			{X0,A},		{A,Y0,Y1})
+		ACCUMULATE_TEST(x1y0y1_ax1_y0y1a,			{A,X1},		{Y0,Y1,A})
+		ACCUMULATE_TEST(x1y1y2_ax1_ay1y2,			{A,X1},		{A,Y0,Y1})
+		ACCUMULATE_TEST(x0x1y0_x0x1a_y0a,			{X0,X1,A},	{Y0,A})
+		ACCUMULATE_TEST(x0x1y1_x0x1a_ay1,			{X0,X1,A},	{A,Y1})
+		ACCUMULATE_TEST(x1x2y0_ax1x2_y0a,			{A,X0,X1},	{Y0,A})
+		ACCUMULATE_TEST(x1x2y1_ax1x2_ay1,			{A,X0,X1},	{A,Y1})
+		ACCUMULATE_TEST(x0y0_x0ab_y0ab,				{X0,A,B},	{Y0,A,B})
+		ACCUMULATE_TEST(x0y2_x0ab_aby2,				{X0,A,B},	{A,B,Y1})
+		ACCUMULATE_TEST(x2y0_abx2_y0ab,				{A,B,X1},	{Y0,A,B})
+		ACCUMULATE_TEST(x2y2_abx2_aby2,				{A,B,X1},	{A,B,Y1})
+		ACCUMULATE_TEST(x0x1y0y1_x0x1a_y0y1a,		{X0,X1,A},	{Y0,Y1,A})
+		ACCUMULATE_TEST(x0x1y1y2_x0x1a_ay1y2,		{X0,X1,A},	{A,Y0,Y1})
+		ACCUMULATE_TEST(x1x2y0y1_ax1x2_y0y1a,		{A,X0,X1},	{Y0,Y1,A})
+		ACCUMULATE_TEST(x1x2y1y2_ax1x2_ay1y2,		{A,X0,X1},	{A,Y0,Y1})
+	}
+
+	#undef ACCUMULATE_TEST
+}
\ No newline at end of file
@@ -7,6 +7,13 @@
 
 #include "RI/physics/Exx.h"
 #include <complex>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cassert>
+#include <limits>
+#include <sys/time.h>
 
 namespace Exx_Test
 {
@@ -47,4 +54,205 @@ namespace Exx_Test
 
 		MPI_Finalize();
 	}
+
+	// compare cal_Hs() with and without flag_float, NA atoms with Nabf auxiliary and Nao atomic basis
+	template<typename Tdata>
+	void test_float(int argc, char *argv[], const int NA, const std::size_t Nabf, const std::size_t Nao)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		using TAC = std::pair<int,std::array<int,1>>;
+		auto init_tensor = [](const RI::Shape_Vector &shape, const double shift) -> RI::Tensor<Tdata>
+		{
+			RI::Tensor<Tdata> D(shape);
+			for(std::size_t i=0; i<D.data->size(); ++i)
+				(*D.data)[i] = std::sin(i+shift);
+			return D;
+		};
+
+		std::map<int,std::array<double,1>> atoms_pos;
+		std::map<int, std::map<TAC, RI::Tensor<Tdata>>> Cs, Vs, Ds;
+		for(int iA0=0; iA0<NA; ++iA0)
+		{
+			atoms_pos[iA0] = {double(iA0)};
+			for(int iA1=0; iA1<NA; ++iA1)
+			{
+				Cs[iA0][{iA1,{0}}] = init_tensor({Nabf,Nao,Nao}, iA0+0.1*iA1);
+				Vs[iA0][{iA1,{0}}] = init_tensor({Nabf,Nabf}, iA0*iA1);
+				Ds[iA0][{iA1,{0}}] = init_tensor({Nao,Nao}, iA0-iA1);
+			}
+		}
+
+		RI::Exx<int,int,1,Tdata> exx;
+		exx.set_parallel(MPI_COMM_WORLD, atoms_pos, {}, {1});
+		exx.set_symmetry(false, {});
+		exx.set_Cs(Cs, 0);
+		exx.set_Vs(Vs, 0);
+		exx.set_Ds(Ds, 0);
+
+		std::array<std::map<int, std::map<TAC, RI::Tensor<Tdata>>>,3> Hs;
+		for(int i=0; i<3; ++i)
+		{
+			exx.flag_float = (i==1);		// full, float, and back to full precision
+			timeval t_begin, t_end;
+			gettimeofday(&t_begin, NULL);
+			exx.cal_Hs();
+			gettimeofday(&t_end, NULL);
+			Hs[i] = exx.Hs;
+			std::cout<<"flag_float="<<exx.flag_float<<"\t"
+				<<(double)(t_end.tv_sec-t_begin.tv_sec) + (double)(t_end.tv_usec-t_begin.tv_usec)/1000000.0<<std::endl;
+		}
+
+		std::array<double,2> diff = {0,0};
+		for(const auto &Hs_A : Hs[0])
+			for(const auto &H_A : Hs_A.second)
+				for(int i=0; i<2; ++i)
+					diff[i] = std::max(diff[i], double((H_A.second - Hs[i+1].at(Hs_A.first).at(H_A.first)).norm(2) / H_A.second.norm(2)));
+		std::cout<<"diff float\t"<<diff[0]<<std::endl;
+		std::cout<<"diff full\t"<<diff[1]<<std::endl;
+
+		MPI_Finalize();
+	}
+
+	// Hs from Exx restored by read_checkpoint(), with Cs and Vs written out-of-core
+	template<typename Tdata>
+	void test_checkpoint(int argc, char *argv[], const int NA, const std::size_t Nabf, const std::size_t Nao)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		using TAC = std::pair<int,std::array<int,1>>;
+		auto init_tensor = [](const RI::Shape_Vector &shape, const double shift) -> RI::Tensor<Tdata>
+		{
+			RI::Tensor<Tdata> D(shape);
+			for(std::size_t i=0; i<D.data->size(); ++i)
+				(*D.data)[i] = std::sin(i+shift);
+			return D;
+		};
+
+		std::map<int,std::array<double,1>> atoms_pos;
+		std::map<int, std::map<TAC, RI::Tensor<Tdata>>> Cs, Vs, Ds;
+		for(int iA0=0; iA0<NA; ++iA0)
+		{
+			atoms_pos[iA0] = {double(iA0)};
+			for(int iA1=0; iA1<NA; ++iA1)
+			{
+				Cs[iA0][{iA1,{0}}] = init_tensor({Nabf,Nao,Nao}, iA0+0.1*iA1);
+				Vs[iA0][{iA1,{0}}] = init_tensor({Nabf,Nabf}, iA0*iA1);
+				Ds[iA0][{iA1,{0}}] = init_tensor({Nao,Nao}, iA0-iA1);
+			}
+		}
+		const std::string file_name = "Exx_checkpoint_"+std::to_string(RI::MPI_Wrapper::mpi_get_rank(MPI_COMM_WORLD))+".bin";
+
+		std::map<int, std::map<TAC, RI::Tensor<Tdata>>> Hs;
+		{
+			RI::Exx<int,int,1,Tdata> exx;
+			exx.flag_out_of_core = true;
+			exx.memory_out_of_core_max = 0;
+			exx.set_parallel(MPI_COMM_WORLD, atoms_pos, {}, {1});
+			exx.set_symmetry(false, {});
+			exx.set_Cs(Cs, 0);
+			exx.set_Vs(Vs, 0);
+			exx.set_Ds(Ds, 0);
+			exx.cal_Hs();
+			Hs = exx.Hs;
+			exx.write_checkpoint(file_name);
+		}
+
+		RI::Exx<int,int,1,Tdata> exx;
+		exx.set_parallel(MPI_COMM_WORLD, atoms_pos, {}, {1});
+		exx.set_symmetry(false, {});
+		exx.read_checkpoint(file_name);
+		std::remove(file_name.c_str());
+		const std::map<int, std::map<TAC, RI::Tensor<Tdata>>> Hs_read = exx.Hs;
+		exx.cal_Hs();
+
+		std::array<double,2> diff = {0,0};
+		for(const auto &Hs_A : Hs)
+			for(const auto &H_A : Hs_A.second)
+			{
+				diff[0] = std::max(diff[0], double((H_A.second - Hs_read.at(Hs_A.first).at(H_A.first)).norm(2)));
+				diff[1] = std::max(diff[1], double((H_A.second - exx.Hs.at(Hs_A.first).at(H_A.first)).norm(2) / H_A.second.norm(2)));
+			}
+		std::cout<<"diff Hs read\t"<<diff[0]<<std::endl;
+		std::cout<<"diff Hs restart\t"<<diff[1]<<std::endl;
+
+		MPI_Finalize();
+	}
+
+	// set_Ds_delta() for Nstep steps, each with Ds of one atom changed and all Ds changed by 0.3*threshold, compared with set_Ds() of the same Ds:
+	// Hs equal for threshold=0. For threshold>0, each tensor in lri differs from Ds by at most threshold in every step, without drift.
+	template<typename Tdata>
+	void test_Ds_delta(int argc, char *argv[], const int NA, const std::size_t Nabf, const std::size_t Nao, const int Nstep, const double threshold)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		using TAC = std::pair<int,std::array<int,1>>;
+		using T_Ds = std::map<int, std::map<TAC, RI::Tensor<Tdata>>>;
+		auto init_tensor = [](const RI::Shape_Vector &shape, const double shift) -> RI::Tensor<Tdata>
+		{
+			RI::Tensor<Tdata> D(shape);
+			for(std::size_t i=0; i<D.data->size(); ++i)
+				(*D.data)[i] = std::sin(i+shift);
+			return D;
+		};
+
+		std::map<int,std::array<double,1>> atoms_pos;
+		T_Ds Cs, Vs, Ds;
+		for(int iA0=0; iA0<NA; ++iA0)
+		{
+			atoms_pos[iA0] = {double(iA0)};
+			for(int iA1=0; iA1<NA; ++iA1)
+			{
+				Cs[iA0][{iA1,{0}}] = init_tensor({Nabf,Nao,Nao}, iA0+0.1*iA1);
+				Vs[iA0][{iA1,{0}}] = init_tensor({Nabf,Nabf}, iA0*iA1);
+				Ds[iA0][{iA1,{0}}] = init_tensor({Nao,Nao}, iA0-iA1);
+			}
+		}
+
+		std::array<RI::Exx<int,int,1,Tdata>,2> exxs;
+		for(RI::Exx<int,int,1,Tdata> &exx : exxs)
+		{
+			exx.set_parallel(MPI_COMM_WORLD, atoms_pos, {}, {1});
+			exx.set_symmetry(false, {});
+			exx.set_Cs(Cs, 0);
+			exx.set_Vs(Vs, 0);
+			exx.set_Ds(Ds, threshold);
+			exx.cal_Hs();
+		}
+
+		for(int istep=0; istep<Nstep; ++istep)
+		{
+			for(auto &Ds_A : Ds)
+				for(auto &D_A : Ds_A.second)
+				{
+					RI::Tensor<Tdata> D_change = Tdata(0.3*threshold) * init_tensor(D_A.second.shape, 0);
+					if(Ds_A.first==istep%NA)
+						D_change = D_change + Tdata(0.01) * init_tensor(D_A.second.shape, istep);
+					D_A.second = D_A.second + D_change;
+				}
+			exxs[0].set_Ds(Ds, threshold);
+			exxs[0].cal_Hs();
+			exxs[1].set_Ds_delta(Ds, threshold);
+			exxs[1].cal_Hs();
+
+			for(const auto &Ds_A : Ds)
+				for(const auto &D_A : Ds_A.second)
+				{
+					const RI::Tensor<Tdata> &D_lri = RI::Global_Func::find(exxs[1].lri.data_pool.at("Ds_").Ds_ab, Ds_A.first, D_A.first);
+					const RI::Tensor<Tdata> D_diff = D_lri.empty() ? D_A.second : D_A.second - D_lri;
+					assert(D_diff.norm(std::numeric_limits<double>::max()) <= threshold*(1+1E-10));
+				}
+			if(threshold==0)
+			{
+				for(const auto &Hs_A : exxs[0].Hs)
+					for(const auto &H_A : Hs_A.second)
+						assert((H_A.second - exxs[1].Hs.at(Hs_A.first).at(H_A.first)).norm(2) <= 1E-10 * H_A.second.norm(2));
+			}
+		}
+
+		MPI_Finalize();
+	}
 }
\ No newline at end of file
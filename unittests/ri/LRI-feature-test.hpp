@@ -0,0 +1,771 @@
+// ===================
+//  Author: agent
+//  date: 2026.10.18
+// ===================
+
+#pragma once
+
+#include"LRI-speed-test.hpp"
+#include"LRI-loop3-test.hpp"
+
+#include"RI/ri/Label.h"
+#include"RI/ri/LRI.h"
+#include"RI/parallel/Parallel_LRI_Weighted.h"
+#include"RI/parallel/Parallel_LRI_Spatial.h"
+#include"RI/global/Global_Func-1.h"
+#include"RI/global/Array_Operator.h"
+#include"RI/global/MPI_Wrapper.h"
+
+#include<array>
+#include<map>
+#include<unordered_map>
+#include<string>
+#include<set>
+#include<vector>
+#include<memory>
+#include<cassert>
+#include<cmath>
+#include<limits>
+#include<stdexcept>
+#include<mpi.h>
+#include<omp.h>
+
+// compare cal_loop3() with each optional feature switched on against the default result
+namespace LRI_Feature_Test
+{
+	template<typename Tdata>
+	using T_Ds = std::map<int, std::map<std::pair<int,std::array<int,1>>, RI::Tensor<Tdata>>>;
+
+	// max of |D0-D1| over all tensors, a tensor missing in one of Ds0 and Ds1 compared as 0
+	template<typename Tdata>
+	double diff_max(const T_Ds<Tdata> &Ds0, const T_Ds<Tdata> &Ds1)
+	{
+		double diff = 0;
+		for(const auto &Ds_A : Ds0)
+			for(const auto &D_A : Ds_A.second)
+			{
+				const RI::Tensor<Tdata> &D1 = RI::Global_Func::find(Ds1, Ds_A.first, D_A.first);
+				diff = std::max(diff, double((D1.empty() ? D_A.second : D_A.second - D1).norm(2)));
+			}
+		for(const auto &Ds_A : Ds1)
+			for(const auto &D_A : Ds_A.second)
+				if(RI::Global_Func::find(Ds0, Ds_A.first, D_A.first).empty())
+					diff = std::max(diff, double(D_A.second.norm(2)));
+		return diff;
+	}
+
+	template<typename Tdata>
+	double norm_max(const T_Ds<Tdata> &Ds)
+	{
+		double norm = 0;
+		for(const auto &Ds_A : Ds)
+			for(const auto &D_A : Ds_A.second)
+				norm = std::max(norm, double(D_A.second.norm(2)));
+		return norm;
+	}
+
+	// Ds1 equals Ds0 up to a relative error of tolerance
+	template<typename Tdata>
+	void check_equal(const T_Ds<Tdata> &Ds0, const T_Ds<Tdata> &Ds1, const double tolerance)
+	{
+		assert(!Ds0.empty());
+		assert(diff_max(Ds0, Ds1) <= tolerance * norm_max(Ds0));
+	}
+
+	// Ds summed over processes, Ds_dense[((A0*NA+A1)*Ni+i0)*Ni+i1] = Ds[A0][{A1,{0}}](i0,i1)
+	template<typename Tdata>
+	std::vector<Tdata> allreduce_dense(const T_Ds<Tdata> &Ds, const int NA, const std::size_t Ni)
+	{
+		std::vector<Tdata> Ds_dense(NA*NA*Ni*Ni, 0);
+		for(const auto &Ds_A : Ds)
+			for(const auto &D_A : Ds_A.second)
+			{
+				assert(D_A.first.second[0]==0 && D_A.second.get_shape_all()==Ni*Ni);
+				const std::size_t begin = (Ds_A.first*NA+D_A.first.first)*Ni*Ni;
+				for(std::size_t i=0; i<Ni*Ni; ++i)
+					Ds_dense[begin+i] += D_A.second.ptr()[i];
+			}
+		RI::MPI_Wrapper::mpi_allreduce(Ds_dense.data(), static_cast<int>(Ds_dense.size()), MPI_SUM, MPI_COMM_WORLD);
+		return Ds_dense;
+	}
+
+	template<typename Tdata>
+	void check_equal_dense(const std::vector<Tdata> &Ds0, const std::vector<Tdata> &Ds1, const double tolerance)
+	{
+		assert(Ds0.size()==Ds1.size());
+		double diff=0, norm=0;
+		for(std::size_t i=0; i<Ds0.size(); ++i)
+		{
+			diff = std::max(diff, double(std::abs(Ds0[i]-Ds1[i])));
+			norm = std::max(norm, double(std::abs(Ds0[i])));
+		}
+		assert(norm>0);
+		assert(diff <= tolerance * norm);
+	}
+
+	// cal_loop3() of all labels with the default parameters and with para_cal
+	template<typename Tdata>
+	void test_para_cal(int argc, char *argv[], const int NA, const std::size_t Ni, const std::map<std::string,double> &para_cal)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		RI::LRI<int,int,1,Tdata> lri;
+		LRI_Speed_Test::init_lri(lri, NA, Ni, 0.5);
+
+		std::array<T_Ds<Tdata>,2> Ds_result;
+		lri.cal_loop3(RI::Global_Func::to_vector(RI::Label::array_ab_ab), Ds_result[0]);
+		lri.cal_loop3(RI::Global_Func::to_vector(RI::Label::array_ab_ab), Ds_result[1], 1.0, para_cal);
+		check_equal(Ds_result[0], Ds_result[1], 1E-10);
+
+		MPI_Finalize();
+	}
+
+	template<typename Tdata>
+	void test_gemm_batch(int argc, char *argv[], const int NA, const std::size_t Ni)
+	{
+		test_para_cal<Tdata>(argc, argv, NA, Ni, {{"flag_gemm_batch", true}});
+	}
+
+	// results with "flag_sort_tasks" equal the default,
+	// and get_tasks() gives the same tasks in the order of decreasing cost, skipping the atoms filtered
+	template<typename Tdata>
+	void test_sort_tasks(int argc, char *argv[], const int NA, const std::size_t Ni)
+	{
+		test_para_cal<Tdata>(argc, argv, NA, Ni, {{"flag_sort_tasks", true}});
+
+		const std::vector<int> list_x = {0,1,2,3};
+		const std::vector<int> list_y = {0,1,2};
+		const std::map<int,std::size_t> sizes = {{0,1}, {1,3}, {2,2}, {3,4}};
+		const auto filter_x = [](const int x){ return x==3; };
+		const std::vector<std::array<std::size_t,2>> tasks_origin = RI::LRI_Cal_Aux::get_tasks(list_x, list_y, sizes, sizes, false, filter_x);
+		const std::vector<std::array<std::size_t,2>> tasks_sort   = RI::LRI_Cal_Aux::get_tasks(list_x, list_y, sizes, sizes, true,  filter_x);
+		assert(tasks_origin.size()==9);
+		using T_tasks_set = std::set<std::array<std::size_t,2>>;
+		assert(T_tasks_set(tasks_origin.begin(), tasks_origin.end()) == T_tasks_set(tasks_sort.begin(), tasks_sort.end()));
+		for(std::size_t i=1; i<tasks_sort.size(); ++i)
+			assert(sizes.at(list_x[tasks_sort[i-1][0]]) >= sizes.at(list_x[tasks_sort[i][0]]));
+		assert(tasks_sort.front()==(std::array<std::size_t,2>{1,1}));
+	}
+
+	// results with "flag_add_Ds_owner" equal the default,
+	// and add_Ds_omp_owner() adds the A0 not yet in Ds_result
+	template<typename Tdata>
+	void test_add_Ds_owner(int argc, char *argv[], const int NA, const std::size_t Ni)
+	{
+		test_para_cal<Tdata>(argc, argv, NA, Ni, {{"flag_add_Ds_owner", true}});
+
+		// Ds_result_threads[ithread][iA] for iA<=ithread
+		const int n_threads = omp_get_max_threads();
+		const RI::Tensor<Tdata> D = LRI_Speed_Test::init_tensor<Tdata>({Ni,Ni});
+		std::vector<T_Ds<Tdata>> Ds_result_threads(n_threads);
+		for(int ithread=0; ithread<n_threads; ++ithread)
+			for(int iA=0; iA<=ithread; ++iA)
+				Ds_result_threads[ithread][iA][{0,{0}}] = D.copy();
+
+		T_Ds<Tdata> Ds_result;
+		#pragma omp parallel
+		RI::LRI_Cal_Aux::add_Ds_omp_owner(Ds_result_threads, Ds_result, 2.0);
+
+		assert(Ds_result.size()==static_cast<std::size_t>(n_threads));
+		for(int iA=0; iA<n_threads; ++iA)
+			assert((Ds_result.at(iA).at({0,{0}}) - Tdata(2*(n_threads-iA)) * D).norm(2) <= 1E-10 * D.norm(2));
+	}
+
+	// results with Parallel_LRI_Weighted, the atom 0 being weight_0 times heavier, equal those with Parallel_LRI_Equally
+	template<typename Tdata>
+	void test_weighted(int argc, char *argv[], const int NA, const std::size_t Ni, const double weight_0)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		std::array<T_Ds<Tdata>,2> Ds_result;
+		for(int flag_weighted=0; flag_weighted<2; ++flag_weighted)
+		{
+			RI::LRI<int,int,1,Tdata> lri;
+			std::shared_ptr<RI::Parallel_LRI_Weighted<int,int,1,Tdata>> parallel;
+			if(flag_weighted)
+			{
+				parallel = std::make_shared<RI::Parallel_LRI_Weighted<int,int,1,Tdata>>();
+				parallel->atoms_weight[0] = weight_0;
+				lri.parallel = parallel;
+			}
+			LRI_Speed_Test::init_lri(lri, NA, Ni, 0.5);
+			if(flag_weighted)
+				assert(parallel->imbalance >= 1.0);
+			lri.cal_loop3(RI::Global_Func::to_vector(RI::Label::array_ab_ab), Ds_result[flag_weighted]);
+		}
+		check_equal(Ds_result[0], Ds_result[1], 1E-10);
+
+		MPI_Finalize();
+	}
+
+	// cal_loop3() after Parallel_LRI_Weighted rebalanced, by hand with atom 0 heavier and then at the end of each cal_loop3(),
+	// equal to that before, summed over processes. In more than 1 process, list_A changes and data_pool is redistributed.
+	template<typename Tdata>
+	void test_rebalance(int argc, char *argv[], const int NA, const std::size_t Ni, const int Niter)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		RI::LRI<int,int,1,Tdata> lri;
+		const std::shared_ptr<RI::Parallel_LRI_Weighted<int,int,1,Tdata>> parallel
+			= std::make_shared<RI::Parallel_LRI_Weighted<int,int,1,Tdata>>();
+		lri.parallel = parallel;
+		LRI_Speed_Test::init_lri(lri, NA, Ni, 0.5, {{"flag_comm_plan", true}});
+		const std::size_t n_data = lri.data_pool.size();
+
+		T_Ds<Tdata> Ds_result;
+		lri.cal_loop3(RI::Global_Func::to_vector(RI::Label::array_ab_ab), Ds_result);
+		const std::vector<Tdata> Ds_dense = allreduce_dense(Ds_result, NA, Ni);
+
+		lri.time_atoms.clear();
+		if(RI::MPI_Wrapper::mpi_get_rank(MPI_COMM_WORLD)==0)
+			lri.time_atoms[0] = 1;
+		const bool flag_changed = lri.rebalance();
+		assert(flag_changed == (RI::MPI_Wrapper::mpi_get_size(MPI_COMM_WORLD)>1));
+		assert(lri.data_pool.size()==n_data);
+
+		parallel->threshold_rebalance = 0;
+		lri.flag_rebalance = true;
+		for(int iter=0; iter<Niter; ++iter)
+		{
+			Ds_result.clear();
+			lri.cal_loop3(RI::Global_Func::to_vector(RI::Label::array_ab_ab), Ds_result);
+			check_equal_dense(Ds_dense, allreduce_dense(Ds_result, NA, Ni), 1E-10);
+		}
+
+		MPI_Finalize();
+	}
+
+	// a0b0_a1b1 and a0b1_a1b0 with "flag_order_a01b01_a01b01" equal the default order,
+	// on the shapes of LRI_Loop3_Test for which the other order is cheaper in a0b0_a1b1
+	template<typename Tdata>
+	void test_order_a01b01_a01b01(int argc, char *argv[])
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		const std::size_t Na0=2, Nb0=3, Na1=4, Nb1=5, Na2=6, Nb2=7;
+		const int Aa01=1, Ab01=2, Aa2=5, Ab2=6;
+		assert(RI::LRI_Cal_Aux::cost_x2y1z1_abx2_ay1_bz1(Na1, Na0, Na2, Nb1, Nb0)
+			< RI::LRI_Cal_Aux::cost_x2y1z1_abx2_ay1_bz1(Na0, Na1, Na2, Nb0, Nb1));
+
+		RI::LRI<int,int,1,Tdata> lri;
+		lri.parallel = std::make_shared<LRI_Loop3_Test::Parallel_LRI_test<int,int,1,Tdata>>();
+		lri.set_parallel(MPI_COMM_WORLD, {}, {}, {1}, RI::Global_Func::to_vector(RI::Label::array_ab_ab));
+		lri.set_tensors_map2({{Aa01, {{{Aa2,{0}},  LRI_Speed_Test::init_tensor<Tdata>({Na0,Na1,Na2})}}}}, {RI::Label::ab::a},    {{"flag_comm",false}});
+		lri.set_tensors_map2({{Ab01, {{{Ab2,{0}},  LRI_Speed_Test::init_tensor<Tdata>({Nb0,Nb1,Nb2})}}}}, {RI::Label::ab::b},    {{"flag_comm",false}});
+		lri.set_tensors_map2({{Aa01, {{{Ab01,{0}}, LRI_Speed_Test::init_tensor<Tdata>({Na0,Nb0})}}}},     {RI::Label::ab::a0b0}, {{"flag_comm",false}});
+		lri.set_tensors_map2({{Aa01, {{{Ab01,{0}}, LRI_Speed_Test::init_tensor<Tdata>({Na0,Nb1})}}}},     {RI::Label::ab::a0b1}, {{"flag_comm",false}});
+		lri.set_tensors_map2({{Aa01, {{{Ab01,{0}}, LRI_Speed_Test::init_tensor<Tdata>({Na1,Nb0})}}}},     {RI::Label::ab::a1b0}, {{"flag_comm",false}});
+		lri.set_tensors_map2({{Aa01, {{{Ab01,{0}}, LRI_Speed_Test::init_tensor<Tdata>({Na1,Nb1})}}}},     {RI::Label::ab::a1b1}, {{"flag_comm",false}});
+
+		for(const RI::Label::ab_ab &label : {RI::Label::ab_ab::a0b0_a1b1, RI::Label::ab_ab::a0b1_a1b0})
+		{
+			std::array<T_Ds<Tdata>,2> Ds_result;
+			lri.cal_loop3({label}, Ds_result[0]);
+			lri.cal_loop3({label}, Ds_result[1], 1.0, {{"flag_order_a01b01_a01b01", true}});
+			check_equal(Ds_result[0], Ds_result[1], 1E-10);
+		}
+
+		MPI_Finalize();
+	}
+
+	// cal_loop3() repeatedly with Data_Pack::Ds_ab_transpose kept between calls equals that released by memory_transpose_max=0,
+	// also after Ds of label a set again
+	template<typename Tdata>
+	void test_transpose_cache(int argc, char *argv[], const int NA, const std::size_t Ni, const int Niter)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		std::array<RI::LRI<int,int,1,Tdata>,2> lris;
+		lris[0].memory_transpose_max = 0;
+		for(RI::LRI<int,int,1,Tdata> &lri : lris)
+			LRI_Speed_Test::init_lri(lri, NA, Ni, 0.5);
+
+		const auto get_flag_transpose = [](const RI::LRI<int,int,1,Tdata> &lri)
+		{
+			return lri.data_pool.at(lri.data_ab_name.at(RI::Label::ab::a)).flag_transpose;
+		};
+
+		for(int iter=0; iter<Niter; ++iter)
+		{
+			if(iter==Niter-1)
+			{
+				// Ds of label a doubled
+				T_Ds<Tdata> Ds_a;
+				for(int iAx=0; iAx<NA; ++iAx)
+					for(int iAy=0; iAy<NA; ++iAy)
+						Ds_a[iAx][{iAy,{0}}] = Tdata(2*std::pow(0.5, std::abs(iAx-iAy))) * LRI_Speed_Test::init_tensor<Tdata>({Ni,Ni,Ni});
+				for(RI::LRI<int,int,1,Tdata> &lri : lris)
+					lri.set_tensors_map2(Ds_a, {RI::Label::ab::a});
+				assert(!get_flag_transpose(lris[1]));
+			}
+			std::array<T_Ds<Tdata>,2> Ds_result;
+			for(int i=0; i<2; ++i)
+				lris[i].cal_loop3(RI::Global_Func::to_vector(RI::Label::array_ab_ab), Ds_result[i]);
+			check_equal(Ds_result[0], Ds_result[1], 1E-10);
+			assert(!get_flag_transpose(lris[0]));
+			assert(get_flag_transpose(lris[1]));
+		}
+
+		MPI_Finalize();
+	}
+
+	// cal_loop3() with "flag_out_of_core" and one block kept in memory equals that in memory.
+	// Tensors_Map2_Disk::find() by threads concurrently: all tensors right, each block read once if memory_max is large enough.
+	template<typename Tdata>
+	void test_out_of_core(int argc, char *argv[], const int NA, const std::size_t Ni)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		std::array<T_Ds<Tdata>,2> Ds_result;
+		for(int flag_out_of_core=0; flag_out_of_core<2; ++flag_out_of_core)
+		{
+			RI::LRI<int,int,1,Tdata> lri;
+			LRI_Speed_Test::init_lri(lri, NA, Ni, 0.5, {{"flag_out_of_core", flag_out_of_core}, {"memory_out_of_core_max", 0}, {"flag_comm_plan", true}});
+			lri.cal_loop3(RI::Global_Func::to_vector(RI::Label::array_ab_ab), Ds_result[flag_out_of_core]);
+			const RI::Data_Pack<int,std::array<int,1>,Tdata> &data_pack = lri.data_pool.at(lri.data_ab_name.at(RI::Label::ab::a));
+			assert(bool(data_pack.Ds_ab_disk) == bool(flag_out_of_core));
+			if(flag_out_of_core)
+				assert(data_pack.Ds_ab_disk->n_read > 0);
+		}
+		check_equal(Ds_result[0], Ds_result[1], 1E-10);
+
+		using T_Ds_pair = std::map<int, std::map<int, RI::Tensor<Tdata>>>;
+		T_Ds_pair Ds;
+		for(int iA0=0; iA0<NA; ++iA0)
+			for(int iA1=0; iA1<NA; ++iA1)
+				Ds[iA0][iA1] = Tdata(1+iA0*NA+iA1) * LRI_Speed_Test::init_tensor<Tdata>({Ni,1000});
+		const std::string file_name = "test_out_of_core_"+std::to_string(RI::MPI_Wrapper::mpi_get_rank(MPI_COMM_WORLD));
+		const int Nfind = 20 * NA * NA;
+		for(const double memory_max : {0.0, 1E9})
+		{
+			const RI::Tensors_Map2_Disk<int,int,Tdata> Ds_disk(Ds, file_name, memory_max);
+			int n_wrong = 0;
+			// threads start on the same block
+			#pragma omp parallel for schedule(dynamic) reduction(+:n_wrong)
+			for(int i=0; i<Nfind; ++i)
+			{
+				const int iA0 = i*NA/Nfind, iA1 = i%NA;
+				std::vector<std::shared_ptr<const std::vector<RI::Tensor<Tdata>>>> holder;
+				const RI::Tensor<Tdata> &D = Ds_disk.find(iA0, iA1, holder);
+				if(!D.data || (D - Ds.at(iA0).at(iA1)).norm(2) != 0)
+					++n_wrong;
+			}
+			assert(n_wrong==0);
+			if(memory_max==0)
+				assert(Ds_disk.n_read >= static_cast<std::size_t>(NA));
+			else
+				assert(Ds_disk.n_read == static_cast<std::size_t>(NA));
+		}
+
+		MPI_Finalize();
+	}
+
+	// results with "flag_tensor_pool" equal the default and share no buffer,
+	// and a Tensor_Pool with all buffers in use gives up one of them
+	template<typename Tdata>
+	void test_tensor_pool(int argc, char *argv[], const int NA, const std::size_t Ni)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		RI::LRI<int,int,1,Tdata> lri;
+		LRI_Speed_Test::init_lri(lri, NA, Ni, 0.5);
+
+		std::array<T_Ds<Tdata>,2> Ds_result;
+		lri.cal_loop3(RI::Global_Func::to_vector(RI::Label::array_ab_ab), Ds_result[0]);
+		lri.cal_loop3(RI::Global_Func::to_vector(RI::Label::array_ab_ab), Ds_result[1], 1.0, {{"flag_tensor_pool", true}});
+		check_equal(Ds_result[0], Ds_result[1], 1E-10);
+
+		std::set<const std::valarray<Tdata>*> buffers;
+		for(const auto &Ds_A : Ds_result[1])
+			for(const auto &D_A : Ds_A.second)
+				assert(buffers.insert(D_A.second.data.get()).second);
+
+		RI::Tensor_Pool<Tdata> pool;
+		pool.n_buffers_max = 2;
+		{
+			std::vector<RI::Tensor<Tdata>> Ds_in_use;
+			for(int i=0; i<3; ++i)
+				Ds_in_use.push_back(pool.get({Ni,Ni}));
+			assert(pool.n_new==3);
+			assert(pool.get_buffers(Ni*Ni).size()==2);
+			assert(Ds_in_use[0].data.use_count()==1);
+		}
+		pool.get({Ni,Ni});
+		assert(pool.n_new==3);
+
+		MPI_Finalize();
+	}
+
+	// set_tensors_map2() of Ds with Ncell images of each atom pair, folded by period Ncell/2 as Array_Operator::operator% and filtered by threshold,
+	// equals that calculated here directly, in 1 thread and in all threads. Ds is not changed.
+	template<typename Tdata>
+	void test_set_tensors(int argc, char *argv[], const int NA, const std::size_t Ni, const int Ncell, const double threshold)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+		const int rank_mine = RI::MPI_Wrapper::mpi_get_rank(MPI_COMM_WORLD);
+		const int rank_size = RI::MPI_Wrapper::mpi_get_size(MPI_COMM_WORLD);
+		const std::array<int,1> period = {Ncell/2};
+
+		std::map<int,std::array<double,1>> atoms_pos;
+		for(int iA=0; iA<NA; ++iA)
+			atoms_pos[iA] = {0};
+
+		// D[iAx][{iAy,icell}] = D * 0.5^(|iAx-iAy|+icell) * (1,-1,...)
+		const RI::Tensor<Tdata> D = LRI_Speed_Test::init_tensor<Tdata>({Ni,Ni,Ni});
+		T_Ds<Tdata> Ds, Ds_fold;
+		for(int iAx=0; iAx<NA; ++iAx)
+			for(int iAy=0; iAy<NA; ++iAy)
+				for(int icell=0; icell<Ncell; ++icell)
+				{
+					const RI::Tensor<Tdata> D_cell = Tdata(std::pow(-0.5, std::abs(iAx-iAy)+icell)) * D;
+					if(iAx%rank_size==rank_mine)
+						Ds[iAx][{iAy,{icell}}] = D_cell;
+					RI::Tensor<Tdata> &D_fold = Ds_fold[iAx][{iAy,RI::Array_Operator::operator%(std::array<int,1>{icell}, period)}];
+					D_fold = D_fold.empty() ? D_cell.copy() : D_fold + D_cell;
+				}
+		T_Ds<Tdata> Ds_copy;
+		for(const auto &Ds_A : Ds)
+			for(const auto &D_A : Ds_A.second)
+				Ds_copy[Ds_A.first][D_A.first] = D_A.second.copy();
+
+		const int nthreads = omp_get_max_threads();
+		for(const int nthreads_set : {1, nthreads})
+		{
+			omp_set_num_threads(nthreads_set);
+			RI::LRI<int,int,1,Tdata> lri;
+			lri.set_parallel(MPI_COMM_WORLD, atoms_pos, {}, period, RI::Global_Func::to_vector(RI::Label::array_ab_ab));
+			lri.set_tensors_map2(Ds, {RI::Label::ab::a}, {{"threshold_filter", threshold}, {"flag_comm_plan", true}});
+			const RI::Data_Pack<int,std::array<int,1>,Tdata> &data_pack = lri.data_pool.at(lri.data_ab_name.at(RI::Label::ab::a));
+
+			std::size_t n_D = 0;
+			for(const auto &Ds_A : data_pack.Ds_ab)
+				for(const auto &D_A : Ds_A.second)
+				{
+					const RI::Tensor<Tdata> &D_fold = Ds_fold.at(Ds_A.first).at(D_A.first);
+					assert(D_fold.norm(std::numeric_limits<double>::max()) > threshold);
+					assert((D_A.second - D_fold).norm(2) <= 1E-10 * D_fold.norm(2));
+					assert(std::abs(data_pack.Ds_ab_norm.at(Ds_A.first).at(D_A.first) - D_A.second.norm(2)) <= 1E-10 * D_A.second.norm(2));
+					++n_D;
+				}
+			if(rank_size==1)
+			{
+				std::size_t n_D_fold = 0;
+				for(const auto &Ds_A : Ds_fold)
+					for(const auto &D_A : Ds_A.second)
+						if(D_A.second.norm(std::numeric_limits<double>::max()) > threshold)
+							++n_D_fold;
+				assert(n_D==n_D_fold);
+				assert(n_D < static_cast<std::size_t>(NA*NA*period[0]));
+			}
+			assert(diff_max(Ds, Ds_copy)==0);
+		}
+		omp_set_num_threads(nthreads);
+
+		// Global_Func::abs_max() of complex by |z|^2
+		RI::Tensor<Tdata> D_max({5});
+		for(std::size_t i=0; i<5; ++i)
+			(*D_max.data)[i] = (i==3) ? Tdata(-7) : Tdata(i);
+		assert(D_max.norm(std::numeric_limits<double>::max()) == 7);
+
+		MPI_Finalize();
+	}
+
+	// Parallel_LRI_Spatial for atoms on a chain numbered out of spatial order, D[iAx][iAy] = D * 0.5^|x-y| only if 0.5^|x-y|>=threshold,
+	// equals Parallel_LRI_Equally, with fewer tensors received from other processes if several processes.
+	template<typename Tdata>
+	void test_spatial(int argc, char *argv[], const int NA, const std::size_t Ni, const double threshold)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+		const int rank_mine = RI::MPI_Wrapper::mpi_get_rank(MPI_COMM_WORLD);
+		const int rank_size = RI::MPI_Wrapper::mpi_get_size(MPI_COMM_WORLD);
+
+		// atoms 0,2,4,... from the left end and 1,3,5,... from the right end
+		std::map<int,std::array<double,1>> atoms_pos;
+		for(int iA=0; iA<NA; ++iA)
+			atoms_pos[iA] = {double( (iA%2==0) ? iA/2 : NA-1-iA/2 )};
+
+		const RI::Tensor<Tdata> D = LRI_Speed_Test::init_tensor<Tdata>({Ni,Ni,Ni});
+		const RI::Tensor<Tdata> D2 = LRI_Speed_Test::init_tensor<Tdata>({Ni,Ni});
+		std::unordered_map<RI::Label::ab, T_Ds<Tdata>> Ds_ab;
+		for(int iAx=0; iAx<NA; ++iAx)
+		{
+			if(iAx%rank_size!=rank_mine)	continue;
+			for(int iAy=0; iAy<NA; ++iAy)
+			{
+				const Tdata factor = std::pow(0.5, std::abs(atoms_pos[iAx][0]-atoms_pos[iAy][0]));
+				if(std::abs(factor) < threshold)	continue;
+				for(const RI::Label::ab &label : RI::Label::array_ab)
+					Ds_ab[label][iAx][{iAy,{0}}] = factor * ((label==RI::Label::ab::a || label==RI::Label::ab::b) ? D : D2);
+			}
+		}
+
+		std::array<std::vector<Tdata>,2> Ds_result;
+		std::array<std::size_t,2> n_tensors_comm = {0,0};
+		for(int flag_spatial=0; flag_spatial<2; ++flag_spatial)
+		{
+			RI::LRI<int,int,1,Tdata> lri;
+			if(flag_spatial)
+				lri.parallel = std::make_shared<RI::Parallel_LRI_Spatial<int,int,1,Tdata>>();
+			lri.set_parallel(MPI_COMM_WORLD, atoms_pos, {{{double(NA)}}}, {1}, RI::Global_Func::to_vector(RI::Label::array_ab_ab));
+			for(const RI::Label::ab &label : RI::Label::array_ab)
+				lri.set_tensors_map2(Ds_ab[label], {label}, {{"flag_comm", true}, {"flag_comm_plan", true}, {"threshold_filter", threshold}});
+			for(const auto &n : lri.n_tensors_comm)
+				n_tensors_comm[flag_spatial] += n.second;
+			RI::MPI_Wrapper::mpi_allreduce(n_tensors_comm[flag_spatial], MPI_SUM, MPI_COMM_WORLD);
+
+			T_Ds<Tdata> Ds;
+			lri.cal_loop3(RI::Global_Func::to_vector(RI::Label::array_ab_ab), Ds);
+			Ds_result[flag_spatial] = allreduce_dense(Ds, NA, Ni);
+		}
+		check_equal_dense(Ds_result[0], Ds_result[1], 1E-10);
+		if(rank_size>1)
+			assert(n_tensors_comm[1] < n_tensors_comm[0]);
+
+		MPI_Finalize();
+	}
+
+	// cal_loop3() with "flag_shared_memory" and one block kept in memory equals that in memory.
+	// Tensors_Map2_Disk in shared memory of Ds the same in all processes: kept once in the node,
+	// all tensors found right, and the blocks copied in each process bounded by memory_max.
+	template<typename Tdata>
+	void test_shared_memory(int argc, char *argv[], const int NA, const std::size_t Ni)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		std::array<T_Ds<Tdata>,2> Ds_result;
+		for(int flag_shared_memory=0; flag_shared_memory<2; ++flag_shared_memory)
+		{
+			RI::LRI<int,int,1,Tdata> lri;
+			LRI_Speed_Test::init_lri(lri, NA, Ni, 0.5, {{"flag_shared_memory", flag_shared_memory}, {"memory_out_of_core_max", 0}, {"flag_comm_plan", true}});
+			lri.cal_loop3(RI::Global_Func::to_vector(RI::Label::array_ab_ab), Ds_result[flag_shared_memory]);
+			const RI::Data_Pack<int,std::array<int,1>,Tdata> &data_pack = lri.data_pool.at(lri.data_ab_name.at(RI::Label::ab::a));
+			assert(bool(data_pack.Ds_ab_disk) == bool(flag_shared_memory));
+			if(flag_shared_memory)
+				assert(data_pack.Ds_ab_disk->flag_shared() && data_pack.Ds_ab_disk->n_read > 0);
+		}
+		check_equal(Ds_result[0], Ds_result[1], 1E-10);
+
+		T_Ds<Tdata> Ds;
+		std::size_t size_Ds = 0;
+		for(int iA0=0; iA0<NA; ++iA0)
+			for(int iA1=0; iA1<NA; ++iA1)
+			{
+				Ds[iA0][{iA1,{0}}] = Tdata(1+iA0*NA+iA1) * LRI_Speed_Test::init_tensor<Tdata>({Ni,Ni+1});
+				size_Ds += Ni*(Ni+1);
+			}
+		const double memory_block = NA*Ni*(Ni+1)*sizeof(Tdata);
+		{
+			const RI::Tensors_Map2_Disk<int,std::pair<int,std::array<int,1>>,Tdata> Ds_shared(Ds, MPI_COMM_WORLD, memory_block);
+			MPI_Aint size_win;
+			int disp_unit;
+			void* memory_shared;
+			MPI_Win_shared_query(Ds_shared.win, 0, &size_win, &disp_unit, &memory_shared);
+			assert(static_cast<std::size_t>(size_win) == size_Ds*sizeof(Tdata));
+			for(const auto &Ds_A : Ds)
+				for(const auto &D_A : Ds_A.second)
+				{
+					std::vector<std::shared_ptr<const std::vector<RI::Tensor<Tdata>>>> holder;
+					assert((Ds_shared.find(Ds_A.first, D_A.first, holder) - D_A.second).norm(2) == 0);
+					assert(Ds_shared.memory <= memory_block);
+				}
+			assert(Ds_shared.n_read == static_cast<std::size_t>(NA));
+		}
+
+		MPI_Finalize();
+	}
+
+	// set_tensors_map2() with "flag_filter_comm" keeps the same tensors as filtering after communication, and so cal_loop3().
+	// Tensors filtered out are counted in bytes_filter_comm instead of sent.
+	template<typename Tdata>
+	void test_filter_comm(int argc, char *argv[], const int NA, const std::size_t Ni, const double threshold)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		std::array<RI::LRI<int,int,1,Tdata>,2> lris;
+		std::array<T_Ds<Tdata>,2> Ds_result;
+		for(int flag_filter_comm=0; flag_filter_comm<2; ++flag_filter_comm)
+		{
+			RI::LRI<int,int,1,Tdata> &lri = lris[flag_filter_comm];
+			LRI_Speed_Test::init_lri(lri, NA, Ni, 0.5, {{"flag_comm", true}, {"flag_comm_plan", true}, {"threshold_filter", threshold}, {"flag_filter_comm", flag_filter_comm}});
+			lri.cal_loop3(RI::Global_Func::to_vector(RI::Label::array_ab_ab), Ds_result[flag_filter_comm]);
+		}
+		check_equal(Ds_result[0], Ds_result[1], 1E-10);
+
+		assert(lris[0].bytes_filter_comm.empty());
+		double bytes_filter_comm = 0;
+		for(const RI::Label::ab &label : RI::Label::array_ab)
+		{
+			const T_Ds<Tdata> &Ds_ab0 = lris[0].data_pool.at(lris[0].data_ab_name.at(label)).Ds_ab;
+			const T_Ds<Tdata> &Ds_ab1 = lris[1].data_pool.at(lris[1].data_ab_name.at(label)).Ds_ab;
+			assert(diff_max(Ds_ab0, Ds_ab1)==0);
+			bytes_filter_comm += lris[1].bytes_filter_comm.at(label);
+		}
+		RI::MPI_Wrapper::mpi_allreduce(&bytes_filter_comm, 1, MPI_SUM, MPI_COMM_WORLD);
+		assert(bytes_filter_comm > 0);
+
+		MPI_Finalize();
+	}
+
+	// cal_loop3() during set_tensors_map2_async() of new D_a0b0, with the labels not needing D_a0b0 calculated first,
+	// equals that after set_tensors_map2() of it.
+	template<typename Tdata>
+	void test_async(int argc, char *argv[], const int NA, const std::size_t Ni)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+		const int rank_mine = RI::MPI_Wrapper::mpi_get_rank(MPI_COMM_WORLD);
+		const int rank_size = RI::MPI_Wrapper::mpi_get_size(MPI_COMM_WORLD);
+
+		// D_a0b0 doubled from that of init_lri()
+		const RI::Tensor<Tdata> D = Tdata(2) * LRI_Speed_Test::init_tensor<Tdata>({Ni,Ni});
+		T_Ds<Tdata> Ds_a0b0;
+		for(int iAx=0; iAx<NA; ++iAx)
+		{
+			if(iAx%rank_size!=rank_mine)	continue;
+			for(int iAy=0; iAy<NA; ++iAy)
+				Ds_a0b0[iAx][{iAy,{0}}] = D;
+		}
+
+		const std::vector<RI::Label::ab_ab> labels = {RI::Label::ab_ab::a0b0_a1b1, RI::Label::ab_ab::a1b1_a2b2, RI::Label::ab_ab::a1b2_a2b1};
+		std::array<T_Ds<Tdata>,3> Ds_result;
+		for(int flag_async=0; flag_async<2; ++flag_async)
+		{
+			RI::LRI<int,int,1,Tdata> lri;
+			LRI_Speed_Test::init_lri(lri, NA, Ni, 1.0, {{"flag_comm_plan", true}});
+			if(!flag_async)
+				lri.cal_loop3(labels, Ds_result[2]);
+
+			if(flag_async)
+			{
+				const std::string save_name = lri.set_tensors_map2_async(Ds_a0b0, {RI::Label::ab::a0b0}, {{"flag_comm", true}, {"flag_comm_plan", true}});
+				assert(lri.sets_async.size()==1);
+				assert(lri.sets_async.front().save_name==save_name);
+				assert(lri.judge_async(RI::Label::ab_ab::a0b0_a1b1));
+				assert(!lri.judge_async(RI::Label::ab_ab::a1b1_a2b2));
+				assert(!lri.judge_async(RI::Label::ab_ab::a1b2_a2b1));
+			}
+			else
+			{
+				lri.set_tensors_map2(Ds_a0b0, {RI::Label::ab::a0b0}, {{"flag_comm", true}, {"flag_comm_plan", true}});
+			}
+			lri.cal_loop3(labels, Ds_result[flag_async]);
+			assert(lri.sets_async.empty());
+		}
+		check_equal(Ds_result[0], Ds_result[1], 1E-10);
+		assert(diff_max(Ds_result[0], Ds_result[2]) > 1E-3 * norm_max(Ds_result[0]));
+
+		MPI_Finalize();
+	}
+
+	// cal_loop3() of many atoms with tiny blocks of Ni_min~Ni_max orbitals with "flag_tensor_pool" equals the default,
+	// with temporary tensors only in Tensor_Pool::buffers_small and reused.
+	template<typename Tdata>
+	void test_small_blocks(int argc, char *argv[], const int NA, const std::size_t Ni_min, const std::size_t Ni_max)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		assert(Ni_max*Ni_max*Ni_max <= __RI_TENSOR_POOL_SMALL_MAX);
+		for(std::size_t Ni=Ni_min; Ni<=Ni_max; ++Ni)
+		{
+			RI::LRI<int,int,1,Tdata> lri;
+			LRI_Speed_Test::init_lri(lri, NA, Ni, 1.0, {{"flag_comm_plan", true}});
+
+			std::array<T_Ds<Tdata>,2> Ds_result;
+			for(int flag_tensor_pool=0; flag_tensor_pool<2; ++flag_tensor_pool)
+				lri.cal_loop3(RI::Global_Func::to_vector(RI::Label::array_ab_ab), Ds_result[flag_tensor_pool], 1.0, {{"flag_tensor_pool", flag_tensor_pool}});
+			check_equal(Ds_result[0], Ds_result[1], 1E-10);
+
+			std::size_t n_get=0, n_new=0;
+			for(const RI::Tensor_Pool<Tdata> &tensor_pool : lri.tensor_pools)
+			{
+				assert(tensor_pool.buffers.empty());
+				n_get += tensor_pool.n_get;
+				n_new += tensor_pool.n_new;
+			}
+			assert(n_get > 0);
+			assert(n_new < n_get);
+		}
+
+		RI::Tensor_Pool<Tdata> pool;
+		pool.get({Ni_max,Ni_max});
+		pool.get({__RI_TENSOR_POOL_SMALL_MAX+1});
+		assert(pool.buffers_small.at(Ni_max*Ni_max).size()==1);
+		assert(pool.buffers.size()==1);
+		assert(pool.buffers.at(__RI_TENSOR_POOL_SMALL_MAX+1).size()==1);
+
+		MPI_Finalize();
+	}
+
+	// cal_loop3() after Ds_ab of a0b0 replaced directly in data_pool, whose result of a0b0_a1b1 is doubled
+	template<typename Tdata>
+	void test_Ds_ab_changed(int argc, char *argv[], const int NA, const std::size_t Ni)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		RI::LRI<int,int,1,Tdata> lri;
+		LRI_Speed_Test::init_lri(lri, NA, Ni, 0.5);
+
+		std::array<T_Ds<Tdata>,2> Ds_result;
+		lri.cal_loop3({RI::Label::ab_ab::a0b0_a1b1}, Ds_result[0], 2.0);
+		for(auto &Ds_A : lri.data_pool.at(lri.data_ab_name.at(RI::Label::ab::a0b0)).Ds_ab)
+			for(auto &D_A : Ds_A.second)
+				D_A.second = Tdata(2) * D_A.second;
+		lri.cal_loop3({RI::Label::ab_ab::a0b0_a1b1}, Ds_result[1]);
+		check_equal(Ds_result[0], Ds_result[1], 1E-10);
+
+		// a label without data pack throws, also with NDEBUG
+		const RI::LRI_Cal_Tools<int,std::array<int,1>,Tdata> tools(lri.period, lri.data_pool, {});
+		bool flag_throw = false;
+		try{ tools.get_Ds_ab(RI::Label::ab::a, 0, {0,{0}}); }
+		catch(const std::invalid_argument &){ flag_throw = true; }
+		assert(flag_throw);
+
+		MPI_Finalize();
+	}
+
+	// Cauchy-Schwarz screening of each label, on tensors decaying with atom distance:
+	// the error of each result is at most threshold, and some contractions are skipped
+	template<typename Tdata>
+	void test_cs(int argc, char *argv[], const int NA, const std::size_t Ni, const double decay, const double threshold)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		RI::LRI<int,int,1,Tdata> lri;
+		LRI_Speed_Test::init_lri(lri, NA, Ni, decay);
+
+		std::size_t n_skip = 0;
+		for(const RI::Label::ab_ab &label : RI::Label::array_ab_ab)
+		{
+			std::array<T_Ds<Tdata>,2> Ds_result;
+			lri.threshold_cs.clear();
+			lri.cal_loop3({label}, Ds_result[0]);
+			lri.threshold_cs[label] = threshold;
+			lri.cal_loop3({label}, Ds_result[1]);
+			assert(diff_max(Ds_result[0], Ds_result[1]) <= threshold);
+
+			const auto &stat = lri.stat_cs.at(label);
+			for(std::size_t level=0; level<stat.n_check.size(); ++level)
+			{
+				assert(stat.n_check[level] > 0);
+				n_skip += stat.n_skip[level];
+			}
+		}
+		assert(n_skip > 0);
+
+		MPI_Finalize();
+	}
+}
\ No newline at end of file
@@ -137,6 +137,38 @@ namespace LRI_Loop3_Test
 			std::cout<<"a0b1_a1b0\t"<<(Ds_result[Aa2][{Ab2,{0}}] - D_test).norm(2)<<std::endl;
 		}
 
+		{
+			lri.data_ab_name.clear();	lri.data_pool.clear();
+			for(const RI::Label::ab &label : {RI::Label::ab::a, RI::Label::ab::b, RI::Label::ab::a0b0, RI::Label::ab::a1b1})
+				lri.set_tensors_map2(Ds_ab[label], {label});
+			T_Ds Ds_result;
+			lri.cal_loop3({RI::Label::ab_ab::a0b0_a1b1}, Ds_result, 1.0, {{"flag_order_a01b01_a01b01", true}});
+			RI::Tensor<Tdata> D_test({Na2,Nb2});
+			FOR_ia012_ib012
+				D_test(ia2,ib2) +=
+					Ds_ab[RI::Label::ab::a][Aa01][{Aa2,{0}}](ia0,ia1,ia2)
+					* Ds_ab[RI::Label::ab::a0b0][Aa01][{Ab01,{0}}](ia0,ib0)
+					* Ds_ab[RI::Label::ab::a1b1][Aa01][{Ab01,{0}}](ia1,ib1)
+					* Ds_ab[RI::Label::ab::b][Ab01][{Ab2,{0}}](ib0,ib1,ib2);
+			std::cout<<"a0b0_a1b1-order\t"<<(Ds_result[Aa2][{Ab2,{0}}] - D_test).norm(2)<<std::endl;
+		}
+
+		{
+			lri.data_ab_name.clear();	lri.data_pool.clear();
+			for(const RI::Label::ab &label : {RI::Label::ab::a, RI::Label::ab::b, RI::Label::ab::a0b1, RI::Label::ab::a1b0})
+				lri.set_tensors_map2(Ds_ab[label], {label});
+			T_Ds Ds_result;
+			lri.cal_loop3({RI::Label::ab_ab::a0b1_a1b0}, Ds_result, 1.0, {{"flag_order_a01b01_a01b01", true}});
+			RI::Tensor<Tdata> D_test({Na2,Nb2});
+			FOR_ia012_ib012
+				D_test(ia2,ib2) +=
+					Ds_ab[RI::Label::ab::a][Aa01][{Aa2,{0}}](ia0,ia1,ia2)
+					* Ds_ab[RI::Label::ab::a0b1][Aa01][{Ab01,{0}}](ia0,ib1)
+					* Ds_ab[RI::Label::ab::a1b0][Aa01][{Ab01,{0}}](ia1,ib0)
+					* Ds_ab[RI::Label::ab::b][Ab01][{Ab2,{0}}](ib0,ib1,ib2);
+			std::cout<<"a0b1_a1b0-order\t"<<(Ds_result[Aa2][{Ab2,{0}}] - D_test).norm(2)<<std::endl;
+		}
+
 		{
 			lri.data_ab_name.clear();	lri.data_pool.clear();
 			for(const RI::Label::ab &label : {RI::Label::ab::a, RI::Label::ab::b, RI::Label::ab::a0b0, RI::Label::ab::a2b1})
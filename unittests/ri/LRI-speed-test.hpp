@@ -12,9 +12,12 @@
 #include"RI/global/Global_Func-1.h"
 
 #include<array>
+#include<vector>
 #include<map>
+#include<string>
 #include<unordered_map>
 #include<iostream>
+#include<cmath>
 #include<mpi.h>
 #include<sys/time.h>
 
@@ -38,12 +41,8 @@ namespace LRI_Speed_Test
 
 
 	template<typename Tdata>
-	void test_speed(int argc, char *argv[], const int NA, const std::size_t Ni)
+	void init_lri(RI::LRI<int,int,1,Tdata> &lri, const int NA, const std::size_t Ni, const double decay=1.0, const std::map<std::string,double> &para={})
 	{
-
-		int mpi_init_provide;
-		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
-
 		constexpr std::size_t Ndim = 1;
 		//const std::size_t Na0=20, Nb0=30, Na1=40, Nb1=50, Na2=60, Nb2=70;
 		const std::size_t Na0=Ni, Nb0=Ni, Na1=Ni, Nb1=Ni, Na2=Ni, Nb2=Ni;
@@ -51,7 +50,8 @@ namespace LRI_Speed_Test
 		using T_Ds = std::map<int, std::map<std::pair<int,std::array<int,Ndim>>, RI::Tensor<Tdata>>>;
 		std::unordered_map<RI::Label::ab, T_Ds> Ds_ab;
 		Ds_ab.reserve(11);
-		auto init_Ds = [&Ds_ab, NA](const RI::Label::ab &label, const RI::Shape_Vector &shape)
+		// D[iAx][iAy] = D * decay^|iAx-iAy|
+		auto init_Ds = [&Ds_ab, NA, decay](const RI::Label::ab &label, const RI::Shape_Vector &shape)
 		{
 			const int rank_mine = RI::MPI_Wrapper::mpi_get_rank(MPI_COMM_WORLD);
 			const int rank_size = RI::MPI_Wrapper::mpi_get_size(MPI_COMM_WORLD);
@@ -60,7 +60,7 @@ namespace LRI_Speed_Test
 			{
 				if(iAx%rank_size!=rank_mine)	continue;
 				for(int iAy=0; iAy<NA; ++iAy)
-					Ds_ab[label][iAx][{iAy,{0}}] = D;
+					Ds_ab[label][iAx][{iAy,{0}}] = (decay==1.0) ? D : Tdata(std::pow(decay, std::abs(iAx-iAy))) * D;
 			}
 		};
 		init_Ds(RI::Label::ab::a, {Na0,Na1,Na2});
@@ -79,11 +79,23 @@ namespace LRI_Speed_Test
 		for(int iA=0; iA<NA; ++iA)
 			atoms_pos[iA] = {0};
 
-		RI::LRI<int,int,Ndim,Tdata> lri;
 		lri.set_parallel(MPI_COMM_WORLD, atoms_pos, {}, {1}, RI::Global_Func::to_vector(RI::Label::array_ab_ab));
 
 		for(const RI::Label::ab &label : RI::Label::array_ab)
-			lri.set_tensors_map2(Ds_ab[label], {label});
+			lri.set_tensors_map2(Ds_ab[label], {label}, para);
+	}
+
+	template<typename Tdata>
+	void test_speed(int argc, char *argv[], const int NA, const std::size_t Ni)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		constexpr std::size_t Ndim = 1;
+		using T_Ds = std::map<int, std::map<std::pair<int,std::array<int,Ndim>>, RI::Tensor<Tdata>>>;
+
+		RI::LRI<int,int,Ndim,Tdata> lri;
+		init_lri(lri, NA, Ni);
 
 		timeval t_begin;
 		gettimeofday(&t_begin, NULL);
@@ -96,4 +108,36 @@ namespace LRI_Speed_Test
 		MPI_Finalize();
 	}
 
+	// benchmark of cal_loop3() of all labels with each parameter set in paras_cal, not called in Test_All.
+	// e.g. test_speed_para<double>(argc, argv, 6, 20, {}, {{}, {{"flag_gemm_batch",1}}})
+	template<typename Tdata>
+	void test_speed_para(int argc, char *argv[], const int NA, const std::size_t Ni,
+		const std::map<std::string,double> &para_set, const std::vector<std::map<std::string,double>> &paras_cal)
+	{
+		int mpi_init_provide;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpi_init_provide);
+
+		constexpr std::size_t Ndim = 1;
+		using T_Ds = std::map<int, std::map<std::pair<int,std::array<int,Ndim>>, RI::Tensor<Tdata>>>;
+
+		RI::LRI<int,int,Ndim,Tdata> lri;
+		timeval t_begin;
+		gettimeofday(&t_begin, NULL);
+		init_lri(lri, NA, Ni, 0.5, para_set);
+		std::cout<<"set\t"<<time_during(t_begin)<<std::endl;
+
+		for(const std::map<std::string,double> &para_cal : paras_cal)
+		{
+			T_Ds Ds_result;
+			gettimeofday(&t_begin, NULL);
+			lri.cal_loop3(RI::Global_Func::to_vector(RI::Label::array_ab_ab), Ds_result, 1.0, para_cal);
+			std::cout<<"cal";
+			for(const auto &para : para_cal)
+				std::cout<<"\t"<<para.first<<"="<<para.second;
+			std::cout<<"\t"<<time_during(t_begin)<<std::endl;
+		}
+
+		MPI_Finalize();
+	}
+
 }
\ No newline at end of file